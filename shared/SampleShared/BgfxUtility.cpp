@@ -109,6 +109,9 @@ namespace sample::bg {
         case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
             return bgfx::TextureFormat::RGBA8;
 
+        case DXGI_FORMAT_R8_UNORM:
+            return bgfx::TextureFormat::R8;
+
             // Depth Formats
         case DXGI_FORMAT_D16_UNORM:
             return bgfx::TextureFormat::D16;
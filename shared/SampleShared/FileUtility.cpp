@@ -16,7 +16,7 @@
 #pragma once
 #include "pch.h"
 #include "FileUtility.h"
-//#include "DirectXTK/DDSTextureLoader.h"
+#include "TextureContainer.h"
 #include <pbr/GltfLoader.h>
 #include <pbr/PbrModel.h>
 #include <fstream>
@@ -48,6 +48,31 @@ namespace sample {
         }
     }
 
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+        // The FromApp variants of the file mapping functions are available to both desktop and UWP applications.
+        m_file.reset(::CreateFile2(path.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr));
+        if (!m_file) {
+            throw std::runtime_error(fmt::format("Failed to open file: {}", path.string()));
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!::GetFileSizeEx(m_file.get(), &fileSize) || fileSize.QuadPart == 0) {
+            // Empty files cannot be mapped.
+            throw std::runtime_error(fmt::format("Failed to read file: {}", path.string()));
+        }
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+
+        m_mapping.reset(::CreateFileMappingFromApp(m_file.get(), nullptr, PAGE_READONLY, 0, nullptr));
+        if (!m_mapping) {
+            throw std::runtime_error(fmt::format("Failed to map file: {}", path.string()));
+        }
+
+        m_view.reset(static_cast<const uint8_t*>(::MapViewOfFileFromApp(m_mapping.get(), FILE_MAP_READ, 0, 0)));
+        if (!m_view) {
+            throw std::runtime_error(fmt::format("Failed to map file: {}", path.string()));
+        }
+    }
+
     std::filesystem::path GetAppFolder() {
         HMODULE thisModule;
 #ifdef UWP
@@ -68,8 +93,8 @@ namespace sample {
         return GetAppFolder() / filename;
     }
 
-    std::filesystem::path FindFileInAppFolder(const std::filesystem::path& filename,
-                                              const std::vector<std::filesystem::path>& searchFolders) {
+    std::filesystem::path TryFindFileInAppFolder(const std::filesystem::path& filename,
+                                                 const std::vector<std::filesystem::path>& searchFolders) {
         auto appFolder = GetAppFolder();
         for (auto folder : searchFolders) {
             auto path = appFolder / folder / filename;
@@ -77,7 +102,17 @@ namespace sample {
                 return path;
             }
         }
+        return "";
+    }
+
+    std::filesystem::path FindFileInAppFolder(const std::filesystem::path& filename,
+                                              const std::vector<std::filesystem::path>& searchFolders) {
+        auto path = TryFindFileInAppFolder(filename, searchFolders);
+        if (!path.empty()) {
+            return path;
+        }
 
+        auto appFolder = GetAppFolder();
         sample::Trace(fmt::format("File \"{}\" is not found in app folder \"{}\" and search folders{}",
                                     xr::wide_to_utf8(filename.c_str()),
                                     xr::wide_to_utf8(appFolder.c_str()),
@@ -100,33 +135,32 @@ namespace sample {
         // Set up a light source (an image-based lighting environment map will also be loaded and contribute to the scene lighting).
         pbrResources.SetLight({0.0f, 0.7071067811865475f, 0.7071067811865475f}, Pbr::RGB::White);
 
-        // Read the BRDF Lookup Table used by the PBR system into a DirectX texture.
-        std::vector<byte> brdfLutFileData = ReadFileBytes(FindFileInAppFolder(L"brdf_lut.png", {"", L"Pbr_uwp"}));
+        // Read the BRDF Lookup Table used by the PBR system into a DirectX texture. A prebuilt DDS or KTX2 copy of the table is
+        // uploaded as it is stored, skipping the PNG decode.
         unique_bgfx_handle<bgfx::TextureHandle> brdLutResourceView;
-        brdLutResourceView.reset(Pbr::Texture::LoadTextureImage(brdfLutFileData.data(), (uint32_t)brdfLutFileData.size()));
+        std::filesystem::path brdfLutContainerPath = TryFindFileInAppFolder(L"brdf_lut.dds", {"", L"Pbr_uwp"});
+        if (brdfLutContainerPath.empty()) {
+            brdfLutContainerPath = TryFindFileInAppFolder(L"brdf_lut.ktx2", {"", L"Pbr_uwp"});
+        }
+        if (!brdfLutContainerPath.empty()) {
+            brdLutResourceView.reset(LoadContainerTexture(brdfLutContainerPath));
+        } else {
+            std::vector<byte> brdfLutFileData = ReadFileBytes(FindFileInAppFolder(L"brdf_lut.png", {"", L"Pbr_uwp"}));
+            brdLutResourceView.reset(Pbr::Texture::LoadTextureImage(brdfLutFileData.data(), (uint32_t)brdfLutFileData.size()));
+        }
         pbrResources.SetBrdfLut(std::move(brdLutResourceView));
         unique_bgfx_handle<bgfx::TextureHandle> diffuseTextureView;
         unique_bgfx_handle<bgfx::TextureHandle> specularTextureView;
         std::map<std::string, bgfx::TextureInfo> textureInformation;
         if (environmentIBL) {
-            
-            diffuseTextureView.reset(loadTexture(FindFileInAppFolder(L"Sample_DiffuseHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-                                                 NULL,
-                                                 NULL,
-                                                 &textureInformation["diffuseTextureView"]));
-            specularTextureView.reset(loadTexture(FindFileInAppFolder(L"Sample_SpecularHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-
-                                                       NULL,
-                                                       NULL,
-                                                       &textureInformation["specularTextureView"]));
-           /* CHECK_HRCMD(DirectX::CreateDDSTextureFromFile(device,
-                                                          FindFileInAppFolder(L"Sample_DiffuseHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-                                                          nullptr,
-                                                          diffuseTextureView.put()));
-            CHECK_HRCMD(DirectX::CreateDDSTextureFromFile(device,
-                                                          FindFileInAppFolder(L"Sample_SpecularHDR.DDS", {"", "SampleShared_uwp"}).c_str(),
-                                                          nullptr,
-                                                          specularTextureView.put()));*/
+            // The environment maps are prefiltered cube maps with their mip chains, which are uploaded straight from the mapped
+            // files.
+            diffuseTextureView.reset(LoadContainerTexture(FindFileInAppFolder(L"Sample_DiffuseHDR.DDS", {"", "SampleShared_uwp"}),
+                                                          BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                                          &textureInformation["diffuseTextureView"]));
+            specularTextureView.reset(LoadContainerTexture(FindFileInAppFolder(L"Sample_SpecularHDR.DDS", {"", "SampleShared_uwp"}),
+                                                           BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                                           &textureInformation["specularTextureView"]));
         } else {
             diffuseTextureView.reset(Pbr::Texture::CreateFlatCubeTexture(Pbr::RGBA::White));
             specularTextureView.reset(Pbr::Texture::CreateFlatCubeTexture(Pbr::RGBA::White));
@@ -15,6 +15,8 @@
 //*********************************************************
 #pragma once
 #include <filesystem>
+#include <memory>
+#include <wil/resource.h>
 
 namespace Pbr {
     struct Model;
@@ -24,6 +26,32 @@ namespace Pbr {
 namespace sample {
     std::vector<uint8_t> ReadFileBytes(const std::filesystem::path& path);
 
+    // A read-only view of a whole file mapped into memory. Pages are read from the file on first access instead of up front,
+    // and can be discarded by the OS under memory pressure since they are backed by the file.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path);
+
+        const uint8_t* Data() const {
+            return m_view.get();
+        }
+        size_t Size() const {
+            return m_size;
+        }
+
+    private:
+        struct UnmapView {
+            void operator()(const uint8_t* view) const {
+                ::UnmapViewOfFile(view);
+            }
+        };
+
+        wil::unique_hfile m_file;
+        wil::unique_handle m_mapping;
+        std::unique_ptr<const uint8_t, UnmapView> m_view;
+        size_t m_size{0};
+    };
+
     // Get a path in app folder, the path might not exist
     std::filesystem::path GetPathInAppFolder(const std::filesystem::path& filename);
 
@@ -32,5 +60,10 @@ namespace sample {
     std::filesystem::path FindFileInAppFolder(const std::filesystem::path& filename,
                                               const std::vector<std::filesystem::path>& searchFolders = {""});
 
+    // Find an optional file in given search folders relative to the app folder.
+    // Returns the path to file if exist, or an empty path if file is not found.
+    std::filesystem::path TryFindFileInAppFolder(const std::filesystem::path& filename,
+                                                 const std::vector<std::filesystem::path>& searchFolders = {""});
+
     Pbr::Resources InitializePbrResources(bool environmentIBL = true);
 } // namespace sample
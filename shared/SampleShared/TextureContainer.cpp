@@ -0,0 +1,483 @@
+//*********************************************************
+//    Copyright (c) Microsoft. All rights reserved.
+//
+//    Apache 2.0 License
+//
+//    You may obtain a copy of the License at
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+//    implied. See the License for the specific language governing
+//    permissions and limitations under the License.
+//
+//*********************************************************
+#include "pch.h"
+#include "TextureContainer.h"
+#include "FileUtility.h"
+#include "DirectXTK/LoaderHelpers.h"
+#include <algorithm>
+#include <limits>
+#include <optional>
+
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+using namespace DirectX;
+
+namespace {
+    // The KTX2 header is followed by the level index, which holds a LevelIndexEntry per mip level, from the largest.
+    constexpr uint8_t Ktx2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A}; // «KTX 20»
+
+    struct Ktx2Header {
+        uint8_t Identifier[12];
+        uint32_t VkFormat;
+        uint32_t TypeSize;
+        uint32_t PixelWidth;
+        uint32_t PixelHeight; // Zero for 1D textures.
+        uint32_t PixelDepth;  // Zero for 1D and 2D textures.
+        uint32_t LayerCount;  // Zero for textures which are not arrays.
+        uint32_t FaceCount;
+        uint32_t LevelCount; // Zero when the mips are left for the reader to generate.
+        uint32_t SupercompressionScheme;
+        uint32_t DfdByteOffset;
+        uint32_t DfdByteLength;
+        uint32_t KvdByteOffset;
+        uint32_t KvdByteLength;
+        uint64_t SgdByteOffset;
+        uint64_t SgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Header) == 80, "KTX2 header size mismatch");
+
+    struct Ktx2LevelIndexEntry {
+        uint64_t ByteOffset;
+        uint64_t ByteLength;
+        uint64_t UncompressedByteLength;
+    };
+
+    // Bounds which the file metadata is checked against, the same as the Direct3D 11 hardware requirements.
+    constexpr uint32_t MaxTextureDimension = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+    constexpr uint32_t MaxVolumeDimension = D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION;
+    constexpr uint32_t MaxLayerCount = D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION;
+
+    // Layout of the texels of a format. Uncompressed formats are made of 1x1 blocks.
+    struct FormatInfo {
+        bgfx::TextureFormat::Enum Format;
+        bool SRGB;
+        uint32_t BlockBytes;
+        uint32_t BlockExtent; // Width and height of a block in texels.
+    };
+
+    // The DXGI formats bgfx has a texture format for. Signed and typeless variants are left out, since the bgfx formats are
+    // sampled as unsigned normalized or float. bgfx creates BC6H textures as signed half floats.
+    std::optional<FormatInfo> GetFormatInfo(DXGI_FORMAT format) {
+        switch (format) {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::RGBA8, format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 4, 1};
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::BGRA8, format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, 4, 1};
+        case DXGI_FORMAT_R8_UNORM:
+            return FormatInfo{bgfx::TextureFormat::R8, false, 1, 1};
+        case DXGI_FORMAT_R8G8_UNORM:
+            return FormatInfo{bgfx::TextureFormat::RG8, false, 2, 1};
+        case DXGI_FORMAT_R16_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::R16F, false, 2, 1};
+        case DXGI_FORMAT_R16G16_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::RG16F, false, 4, 1};
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::RGBA16F, false, 8, 1};
+        case DXGI_FORMAT_R32_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::R32F, false, 4, 1};
+        case DXGI_FORMAT_R32G32_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::RG32F, false, 8, 1};
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::RGBA32F, false, 16, 1};
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            return FormatInfo{bgfx::TextureFormat::RG11B10F, false, 4, 1};
+        case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+            return FormatInfo{bgfx::TextureFormat::RGB9E5F, false, 4, 1};
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            return FormatInfo{bgfx::TextureFormat::RGB10A2, false, 4, 1};
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::BC1, format == DXGI_FORMAT_BC1_UNORM_SRGB, 8, 4};
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::BC2, format == DXGI_FORMAT_BC2_UNORM_SRGB, 16, 4};
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::BC3, format == DXGI_FORMAT_BC3_UNORM_SRGB, 16, 4};
+        case DXGI_FORMAT_BC4_UNORM:
+            return FormatInfo{bgfx::TextureFormat::BC4, false, 8, 4};
+        case DXGI_FORMAT_BC5_UNORM:
+            return FormatInfo{bgfx::TextureFormat::BC5, false, 16, 4};
+        case DXGI_FORMAT_BC6H_SF16:
+            return FormatInfo{bgfx::TextureFormat::BC6H, false, 16, 4};
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return FormatInfo{bgfx::TextureFormat::BC7, format == DXGI_FORMAT_BC7_UNORM_SRGB, 16, 4};
+        default:
+            return std::nullopt;
+        }
+    }
+
+    // The DXGI format matching a VkFormat of a KTX2 file, for the formats GetFormatInfo supports.
+    DXGI_FORMAT GetDxgiFormat(uint32_t vkFormat) {
+        switch (vkFormat) {
+        case 9: // VK_FORMAT_R8_UNORM
+            return DXGI_FORMAT_R8_UNORM;
+        case 16: // VK_FORMAT_R8G8_UNORM
+            return DXGI_FORMAT_R8G8_UNORM;
+        case 37: // VK_FORMAT_R8G8B8A8_UNORM
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case 43: // VK_FORMAT_R8G8B8A8_SRGB
+            return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case 44: // VK_FORMAT_B8G8R8A8_UNORM
+            return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case 50: // VK_FORMAT_B8G8R8A8_SRGB
+            return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        case 64: // VK_FORMAT_A2B10G10R10_UNORM_PACK32
+            return DXGI_FORMAT_R10G10B10A2_UNORM;
+        case 76: // VK_FORMAT_R16_SFLOAT
+            return DXGI_FORMAT_R16_FLOAT;
+        case 83: // VK_FORMAT_R16G16_SFLOAT
+            return DXGI_FORMAT_R16G16_FLOAT;
+        case 97: // VK_FORMAT_R16G16B16A16_SFLOAT
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        case 100: // VK_FORMAT_R32_SFLOAT
+            return DXGI_FORMAT_R32_FLOAT;
+        case 103: // VK_FORMAT_R32G32_SFLOAT
+            return DXGI_FORMAT_R32G32_FLOAT;
+        case 109: // VK_FORMAT_R32G32B32A32_SFLOAT
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        case 122: // VK_FORMAT_B10G11R11_UFLOAT_PACK32
+            return DXGI_FORMAT_R11G11B10_FLOAT;
+        case 123: // VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+            return DXGI_FORMAT_R9G9B9E5_SHAREDEXP;
+        case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+            return DXGI_FORMAT_BC1_UNORM;
+        case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+            return DXGI_FORMAT_BC1_UNORM_SRGB;
+        case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+            return DXGI_FORMAT_BC2_UNORM;
+        case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+            return DXGI_FORMAT_BC2_UNORM_SRGB;
+        case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+            return DXGI_FORMAT_BC3_UNORM;
+        case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+            return DXGI_FORMAT_BC3_UNORM_SRGB;
+        case 139: // VK_FORMAT_BC4_UNORM_BLOCK
+            return DXGI_FORMAT_BC4_UNORM;
+        case 141: // VK_FORMAT_BC5_UNORM_BLOCK
+            return DXGI_FORMAT_BC5_UNORM;
+        case 144: // VK_FORMAT_BC6H_SFLOAT_BLOCK
+            return DXGI_FORMAT_BC6H_SF16;
+        case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+            return DXGI_FORMAT_BC7_UNORM;
+        case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+            return DXGI_FORMAT_BC7_UNORM_SRGB;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // Number of levels in the full mip chain of a texture.
+    uint32_t GetFullMipCount(uint32_t width, uint32_t height, uint32_t depth) {
+        uint32_t mipCount = 1;
+        for (uint32_t extent = std::max({width, height, depth}); extent > 1; extent >>= 1) {
+            mipCount++;
+        }
+        return mipCount;
+    }
+
+    // Size of the image of a mip level of one layer or cube face, including all of its depth slices.
+    size_t GetImageSize(const sample::TextureContainer& container, const FormatInfo& formatInfo, uint32_t mip) {
+        const size_t width = std::max(1u, container.Width >> mip);
+        const size_t height = std::max(1u, container.Height >> mip);
+        const size_t depth = std::max(1u, container.Depth >> mip);
+        const size_t blocksWide = (width + formatInfo.BlockExtent - 1) / formatInfo.BlockExtent;
+        const size_t blocksHigh = (height + formatInfo.BlockExtent - 1) / formatInfo.BlockExtent;
+        return blocksWide * blocksHigh * depth * formatInfo.BlockBytes;
+    }
+
+    // Set the format of a container, and check its extents against the bounds of its dimension. Returns the format layout.
+    FormatInfo ValidateTexture(sample::TextureContainer& container, DXGI_FORMAT format) {
+        const std::optional<FormatInfo> formatInfo = GetFormatInfo(format);
+        if (!formatInfo) {
+            throw std::runtime_error(fmt::format("Unsupported texture container format: {}", (uint32_t)format));
+        }
+        container.Format = formatInfo->Format;
+        container.SRGB = formatInfo->SRGB;
+
+        const uint32_t maxDimension = container.Depth > 1 ? MaxVolumeDimension : MaxTextureDimension;
+        if (container.Width == 0 || container.Height == 0 || container.Depth == 0 || container.LayerCount == 0 ||
+            container.Width > maxDimension || container.Height > maxDimension || container.Depth > maxDimension ||
+            container.LayerCount > MaxLayerCount || (container.Depth > 1 && (container.LayerCount > 1 || container.CubeMap)) ||
+            (container.CubeMap && container.Width != container.Height) || container.MipCount == 0 ||
+            container.MipCount > GetFullMipCount(container.Width, container.Height, container.Depth)) {
+            throw std::runtime_error("Invalid texture container dimensions.");
+        }
+        return *formatInfo;
+    }
+
+    // Keep only the largest level of the images of a partial mip chain, which were located with all of their stored levels.
+    void KeepFullMipChain(sample::TextureContainer& container) {
+        if (container.MipCount == 1 || container.MipCount == GetFullMipCount(container.Width, container.Height, container.Depth)) {
+            return;
+        }
+
+        std::vector<sample::TextureContainer::Image> largestImages;
+        for (size_t image = 0; image < container.Images.size(); image += container.MipCount) {
+            largestImages.push_back(container.Images[image]);
+        }
+        container.Images = std::move(largestImages);
+        container.MipCount = 1;
+    }
+
+    sample::TextureContainer ReadDds(const uint8_t* data, size_t size) {
+        if (size < sizeof(uint32_t) + sizeof(DDS_HEADER)) {
+            throw std::runtime_error("Invalid DDS header.");
+        }
+
+        DDS_HEADER header;
+        memcpy(&header, data + sizeof(uint32_t), sizeof(header));
+        if (header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT)) {
+            throw std::runtime_error("Invalid DDS header.");
+        }
+
+        sample::TextureContainer container;
+        container.Width = header.width;
+        container.Height = header.height;
+        container.MipCount = std::max(1u, header.mipMapCount);
+        size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+
+        // The same header checks as DDSTextureLoader, except that 1D textures are created as 2D textures of a single row.
+        DXGI_FORMAT format;
+        if ((header.ddspf.flags & DDS_FOURCC) && MAKEFOURCC('D', 'X', '1', '0') == header.ddspf.fourCC) {
+            if (size < offset + sizeof(DDS_HEADER_DXT10)) {
+                throw std::runtime_error("Invalid DDS header.");
+            }
+
+            DDS_HEADER_DXT10 dxt10Header;
+            memcpy(&dxt10Header, data + offset, sizeof(dxt10Header));
+            offset += sizeof(DDS_HEADER_DXT10);
+
+            format = dxt10Header.dxgiFormat;
+            container.LayerCount = dxt10Header.arraySize;
+            switch (dxt10Header.resourceDimension) {
+            case DDS_DIMENSION_TEXTURE1D:
+                if ((header.flags & DDS_HEIGHT) && header.height != 1) {
+                    throw std::runtime_error("Invalid DDS header.");
+                }
+                container.Height = 1;
+                break;
+            case DDS_DIMENSION_TEXTURE2D:
+                container.CubeMap = (dxt10Header.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+                break;
+            case DDS_DIMENSION_TEXTURE3D:
+                if (!(header.flags & DDS_HEADER_FLAGS_VOLUME)) {
+                    throw std::runtime_error("Invalid DDS header.");
+                }
+                container.Depth = header.depth;
+                break;
+            default:
+                throw std::runtime_error("Unsupported DDS resource dimension.");
+            }
+        } else {
+            format = LoaderHelpers::GetDXGIFormat(header.ddspf);
+            if (header.flags & DDS_HEADER_FLAGS_VOLUME) {
+                container.Depth = header.depth;
+            } else if (header.caps2 & DDS_CUBEMAP) {
+                // All six faces are required.
+                if ((header.caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES) {
+                    throw std::runtime_error("Unsupported DDS cube map.");
+                }
+                container.CubeMap = true;
+            }
+        }
+
+        const FormatInfo formatInfo = ValidateTexture(container, format);
+
+        // Each layer and face is stored with all of its mip levels, as bgfx reads them.
+        const uint32_t faceCount = container.CubeMap ? 6 : 1;
+        for (uint32_t face = 0; face < container.LayerCount * faceCount; face++) {
+            for (uint32_t mip = 0; mip < container.MipCount; mip++) {
+                const size_t imageSize = GetImageSize(container, formatInfo, mip);
+                if (imageSize > size - offset) {
+                    throw std::runtime_error("DDS images go out of range of the file.");
+                }
+                container.Images.push_back({data + offset, imageSize});
+                offset += imageSize;
+            }
+        }
+
+        KeepFullMipChain(container);
+        return container;
+    }
+
+    sample::TextureContainer ReadKtx2(const uint8_t* data, size_t size) {
+        Ktx2Header header;
+        if (size < sizeof(header)) {
+            throw std::runtime_error("Invalid KTX2 header.");
+        }
+        memcpy(&header, data, sizeof(header));
+
+        // Supercompressed levels would have to be inflated, and Basis Universal images (VK_FORMAT_UNDEFINED) transcoded.
+        if (header.SupercompressionScheme != 0) {
+            throw std::runtime_error("Supercompressed KTX2 files are not supported.");
+        }
+        if ((header.FaceCount != 1 && header.FaceCount != 6) || (header.FaceCount == 6 && header.PixelDepth != 0)) {
+            throw std::runtime_error("Invalid KTX2 header.");
+        }
+
+        sample::TextureContainer container;
+        container.Width = header.PixelWidth;
+        container.Height = std::max(1u, header.PixelHeight);
+        container.Depth = std::max(1u, header.PixelDepth);
+        container.LayerCount = std::max(1u, header.LayerCount);
+        container.MipCount = std::max(1u, header.LevelCount);
+        container.CubeMap = header.FaceCount == 6;
+        const FormatInfo formatInfo = ValidateTexture(container, GetDxgiFormat(header.VkFormat));
+
+        const size_t levelIndexSize = sizeof(Ktx2LevelIndexEntry) * container.MipCount;
+        if (levelIndexSize > size - sizeof(header)) {
+            throw std::runtime_error("Invalid KTX2 level index.");
+        }
+
+        // Each mip level holds the image of every layer and face in turn, so the images of a layer are not stored together.
+        std::vector<Ktx2LevelIndexEntry> levels(container.MipCount);
+        memcpy(levels.data(), data + sizeof(header), levelIndexSize);
+        const uint32_t imageCount = container.LayerCount * header.FaceCount;
+        for (uint32_t mip = 0; mip < container.MipCount; mip++) {
+            const Ktx2LevelIndexEntry& level = levels[mip];
+            if (level.ByteLength != GetImageSize(container, formatInfo, mip) * imageCount || level.ByteOffset > size ||
+                level.ByteLength > size - level.ByteOffset) {
+                throw std::runtime_error("KTX2 level goes out of range of the file.");
+            }
+        }
+        for (uint32_t image = 0; image < imageCount; image++) {
+            for (uint32_t mip = 0; mip < container.MipCount; mip++) {
+                const size_t imageSize = GetImageSize(container, formatInfo, mip);
+                container.Images.push_back({data + levels[mip].ByteOffset + imageSize * image, imageSize});
+            }
+        }
+
+        KeepFullMipChain(container);
+        return container;
+    }
+
+    bool IsKtx2(const uint8_t* data, size_t size) {
+        return size >= sizeof(Ktx2Identifier) && memcmp(data, Ktx2Identifier, sizeof(Ktx2Identifier)) == 0;
+    }
+
+    bool IsDds(const uint8_t* data, size_t size) {
+        uint32_t magic = 0;
+        if (size >= sizeof(magic)) {
+            memcpy(&magic, data, sizeof(magic));
+        }
+        return magic == DDS_MAGIC;
+    }
+
+    void ReleaseStorage(void* /*data*/, void* storage) {
+        delete static_cast<std::shared_ptr<const void>*>(storage);
+    }
+} // namespace
+
+namespace sample {
+    bool TextureContainer::IsContiguous() const {
+        for (size_t i = 1; i < Images.size(); i++) {
+            if (Images[i].Data != Images[i - 1].Data + Images[i - 1].Size) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool IsTextureContainer(_In_reads_bytes_(size) const uint8_t* data, size_t size) {
+        return IsKtx2(data, size) || IsDds(data, size);
+    }
+
+    TextureContainer ReadTextureContainer(_In_reads_bytes_(size) const uint8_t* data, size_t size) {
+        if (IsKtx2(data, size)) {
+            return ReadKtx2(data, size);
+        }
+        if (IsDds(data, size)) {
+            return ReadDds(data, size);
+        }
+        throw std::runtime_error("Not a DDS or KTX2 file.");
+    }
+
+    bgfx::TextureHandle CreateContainerTexture(const TextureContainer& container,
+                                               std::shared_ptr<const void> storage,
+                                               uint64_t flags,
+                                               bgfx::TextureInfo* info) {
+        if (container.SRGB) {
+            flags |= BGFX_TEXTURE_SRGB;
+        }
+
+        const bool hasMips = container.MipCount > 1;
+        const uint16_t width = (uint16_t)container.Width;
+        const uint16_t height = (uint16_t)container.Height;
+        const uint16_t depth = (uint16_t)container.Depth;
+        const uint16_t layerCount = (uint16_t)container.LayerCount;
+        if (!bgfx::isTextureValid(depth, container.CubeMap, layerCount, container.Format, flags)) {
+            throw std::runtime_error("The renderer does not support the format or layout of a texture container.");
+        }
+
+        size_t size = 0;
+        for (const TextureContainer::Image& image : container.Images) {
+            size += image.Size;
+        }
+        if (size > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Texture containers larger than 4 GB are not supported.");
+        }
+
+        const bgfx::Memory* memory;
+        if (storage && container.IsContiguous()) {
+            memory = bgfx::makeRef(container.Images.front().Data,
+                                   (uint32_t)size,
+                                   ReleaseStorage,
+                                   new std::shared_ptr<const void>(std::move(storage)));
+        } else {
+            memory = bgfx::alloc((uint32_t)size);
+            uint8_t* destination = memory->data;
+            for (const TextureContainer::Image& image : container.Images) {
+                memcpy(destination, image.Data, image.Size);
+                destination += image.Size;
+            }
+        }
+
+        if (info != nullptr) {
+            bgfx::calcTextureSize(*info, width, height, depth, container.CubeMap, hasMips, layerCount, container.Format);
+        }
+
+        if (container.CubeMap) {
+            return bgfx::createTextureCube(width, hasMips, layerCount, container.Format, flags, memory);
+        }
+        if (container.Depth > 1) {
+            return bgfx::createTexture3D(width, height, depth, hasMips, container.Format, flags, memory);
+        }
+        return bgfx::createTexture2D(width, height, hasMips, layerCount, container.Format, flags, memory);
+    }
+
+    bgfx::TextureHandle LoadContainerTexture(const std::filesystem::path& path, uint64_t flags, bgfx::TextureInfo* info) {
+        auto file = std::make_shared<const MappedFile>(path);
+        TextureContainer container;
+        try {
+            container = ReadTextureContainer(file->Data(), file->Size());
+        } catch (const std::exception& ex) {
+            throw std::runtime_error(fmt::format("Failed to read texture file {}: {}", path.string(), ex.what()));
+        }
+
+        const bgfx::TextureHandle texture = CreateContainerTexture(container, std::move(file), flags, info);
+        if (bgfx::isValid(texture)) {
+            bgfx::setName(texture, path.filename().string().c_str());
+        }
+        return texture;
+    }
+} // namespace sample
@@ -0,0 +1,66 @@
+//*********************************************************
+//    Copyright (c) Microsoft. All rights reserved.
+//
+//    Apache 2.0 License
+//
+//    You may obtain a copy of the License at
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or
+//    implied. See the License for the specific language governing
+//    permissions and limitations under the License.
+//
+//*********************************************************
+#pragma once
+#include <bgfx/bgfx.h>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace sample {
+    // A texture stored in a DDS or KTX2 file, whose images are used as they are stored: block compressed images stay compressed
+    // and prebuilt mip chains are kept, so nothing is decoded. The images point into the file content.
+    struct TextureContainer {
+        struct Image {
+            const uint8_t* Data;
+            size_t Size;
+        };
+
+        bgfx::TextureFormat::Enum Format{bgfx::TextureFormat::Unknown};
+        bool SRGB{false};
+        uint32_t Width{0};
+        uint32_t Height{0};
+        uint32_t Depth{1};      // Greater than 1 for volume textures.
+        uint32_t LayerCount{1}; // Array layers, each made of 6 faces in cube maps.
+        uint32_t MipCount{1};
+        bool CubeMap{false};
+
+        // Images in the order bgfx reads texture data in: by layer, then by cube face, then by mip level from the largest.
+        std::vector<Image> Images;
+
+        // Whether the images follow each other in that order, so that bgfx can read them as a single range.
+        bool IsContiguous() const;
+    };
+
+    // Whether the content starts with the identifier of a DDS or KTX2 file.
+    bool IsTextureContainer(_In_reads_bytes_(size) const uint8_t* data, size_t size);
+
+    // Reads the header of DDS or KTX2 file content and locates its images. Throws if the header is not valid, the images do not
+    // fit in the content, or the texture is supercompressed or in a format bgfx has no texture format for. A partial mip chain is
+    // reduced to its largest level, since bgfx creates textures with either a single level or the full chain.
+    TextureContainer ReadTextureContainer(_In_reads_bytes_(size) const uint8_t* data, size_t size);
+
+    // Creates a texture from the images of a container. When storage, the owner of the file content, is given and the images are
+    // contiguous, bgfx reads them in place and storage is kept alive until it has. Otherwise they are copied into bgfx memory.
+    bgfx::TextureHandle CreateContainerTexture(const TextureContainer& container,
+                                               std::shared_ptr<const void> storage,
+                                               uint64_t flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                               bgfx::TextureInfo* info = nullptr);
+
+    // Memory-maps a DDS or KTX2 file and creates a texture from it, so that its pages are read straight into the texture.
+    bgfx::TextureHandle LoadContainerTexture(const std::filesystem::path& path,
+                                             uint64_t flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                             bgfx::TextureInfo* info = nullptr);
+} // namespace sample
@@ -18,6 +18,7 @@ namespace stl = tinystl;
 #include <bx/readerwriter.h>
 #include <bx/string.h>
 #include "BgfxUtility.h"
+#include "FileUtility.h"
 //#include "entry/entry.h"
 #include "meshoptimizer/src/meshoptimizer.h"
 
@@ -393,16 +394,17 @@ void Group::reset()
 namespace bgfx
 {
 	int32_t read(bx::ReaderI* _reader, bgfx::VertexLayout& _layout, bx::Error* _err = NULL);
+	int32_t write(bx::WriterI* _writer, const bgfx::VertexLayout& _layout, bx::Error* _err = NULL);
 }
 
+static constexpr uint32_t kChunkVertexBuffer           = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
+static constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x0);
+static constexpr uint32_t kChunkIndexBuffer            = BX_MAKEFOURCC('I', 'B', ' ', 0x0);
+static constexpr uint32_t kChunkIndexBufferCompressed  = BX_MAKEFOURCC('I', 'B', 'C', 0x1);
+static constexpr uint32_t kChunkPrimitive              = BX_MAKEFOURCC('P', 'R', 'I', 0x0);
+
 void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 {
-	constexpr uint32_t kChunkVertexBuffer           = BX_MAKEFOURCC('V', 'B', ' ', 0x1);
-	constexpr uint32_t kChunkVertexBufferCompressed = BX_MAKEFOURCC('V', 'B', 'C', 0x0);
-	constexpr uint32_t kChunkIndexBuffer            = BX_MAKEFOURCC('I', 'B', ' ', 0x0);
-	constexpr uint32_t kChunkIndexBufferCompressed  = BX_MAKEFOURCC('I', 'B', 'C', 0x1);
-	constexpr uint32_t kChunkPrimitive              = BX_MAKEFOURCC('P', 'R', 'I', 0x0);
-
 	using namespace bx;
 	using namespace bgfx;
 
@@ -461,7 +463,12 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				void* compressedVertices = BX_ALLOC(allocator, compressedSize);
 				bx::read(_reader, compressedVertices, compressedSize);
 
-				//TODO:meshopt_decodeVertexBuffer(mem->data, group.m_numVertices, stride, (uint8_t*)compressedVertices, compressedSize);
+				if (0 != meshopt_decodeVertexBuffer(mem->data, group.m_numVertices, stride, (uint8_t*)compressedVertices, compressedSize) )
+				{
+					// Upload degenerate geometry rather than garbage.
+					DBG("Failed to decode compressed vertex buffer.");
+					bx::memSet(mem->data, 0, mem->size);
+				}
 
 				BX_FREE(allocator, compressedVertices);
 
@@ -504,7 +511,11 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 
 				bx::read(_reader, compressedIndices, compressedSize);
 
-				//TODO:meshopt_decodeIndexBuffer(mem->data, group.m_numIndices, 2, (uint8_t*)compressedIndices, compressedSize);
+				if (0 != meshopt_decodeIndexBuffer(mem->data, group.m_numIndices, 2, (uint8_t*)compressedIndices, compressedSize) )
+				{
+					DBG("Failed to decode compressed index buffer.");
+					bx::memSet(mem->data, 0, mem->size);
+				}
 
 				BX_FREE(allocator, compressedIndices);
 
@@ -562,10 +573,276 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 	}
 }
 
+static void meshFileReleaseCb(void* _ptr, void* _userData)
+{
+	BX_UNUSED(_ptr);
+	delete (std::shared_ptr<const sample::MappedFile>*)_userData;
+}
+
+// References a region of a mapped mesh file, which stays mapped until bgfx releases it.
+static const bgfx::Memory* makeMeshFileRef(const std::shared_ptr<const sample::MappedFile>& _file, const uint8_t* _data, uint32_t _size)
+{
+	return bgfx::makeRef(_data, _size, meshFileReleaseCb, new std::shared_ptr<const sample::MappedFile>(_file) );
+}
+
+bool Mesh::load(const std::shared_ptr<const sample::MappedFile>& _file, bool _ramcopy)
+{
+	using namespace bx;
+	using namespace bgfx;
+
+	if (_file->Size() > INT32_MAX)
+	{
+		return false;
+	}
+
+	MemoryReader reader(_file->Data(), uint32_t(_file->Size() ) );
+	bx::Error err;
+
+	// Take a region of the file at the read position, if there are enough bytes left.
+	const auto readRegion = [&reader](uint64_t _size, const uint8_t*& _data)
+	{
+		if (uint64_t(reader.remaining() ) < _size)
+		{
+			return false;
+		}
+		_data = reader.getDataPtr();
+		reader.seek(int64_t(_size) );
+		return true;
+	};
+
+	// A buffer of a group, in the mapping.
+	struct Region
+	{
+		bool m_compressed;
+		const uint8_t* m_data;
+		uint32_t m_size;
+	};
+
+	struct PendingGroup
+	{
+		Group m_group;
+		VertexLayout m_layout;
+		Region m_vertices;
+		Region m_indices;
+	};
+
+	// Validate all chunks before creating any buffer, so that an invalid file creates nothing.
+	stl::vector<PendingGroup> pendingGroups;
+	PendingGroup pending = {};
+
+	while (0 < reader.remaining() )
+	{
+		uint32_t chunk;
+		read(&reader, chunk, &err);
+
+		switch (chunk)
+		{
+			case kChunkVertexBuffer:
+			case kChunkVertexBufferCompressed:
+			{
+				read(&reader, pending.m_group.m_sphere, &err);
+				read(&reader, pending.m_group.m_aabb, &err);
+				read(&reader, pending.m_group.m_obb, &err);
+				read(&reader, pending.m_layout, &err);
+				read(&reader, pending.m_group.m_numVertices, &err);
+
+				const uint64_t size = uint64_t(pending.m_group.m_numVertices) * pending.m_layout.getStride();
+				uint32_t regionSize = uint32_t(size);
+				pending.m_vertices.m_compressed = kChunkVertexBufferCompressed == chunk;
+				if (pending.m_vertices.m_compressed)
+				{
+					read(&reader, regionSize, &err);
+				}
+
+				if (!err.isOk()
+				||  0 == pending.m_layout.getStride()
+				||  !readRegion(regionSize, pending.m_vertices.m_data) )
+				{
+					return false;
+				}
+				pending.m_vertices.m_size = regionSize;
+			}
+				break;
+
+			case kChunkIndexBuffer:
+			case kChunkIndexBufferCompressed:
+			{
+				read(&reader, pending.m_group.m_numIndices, &err);
+
+				const uint64_t size = uint64_t(pending.m_group.m_numIndices) * 2;
+				if (UINT32_MAX < size)
+				{
+					return false;
+				}
+
+				uint32_t regionSize = uint32_t(size);
+				pending.m_indices.m_compressed = kChunkIndexBufferCompressed == chunk;
+				if (pending.m_indices.m_compressed)
+				{
+					read(&reader, regionSize, &err);
+				}
+
+				if (!err.isOk()
+				||  !readRegion(regionSize, pending.m_indices.m_data) )
+				{
+					return false;
+				}
+				pending.m_indices.m_size = regionSize;
+			}
+				break;
+
+			case kChunkPrimitive:
+			{
+				uint16_t len;
+				read(&reader, len, &err);
+
+				const uint8_t* material;
+				if (!err.isOk()
+				||  !readRegion(len, material) )
+				{
+					return false;
+				}
+
+				uint16_t num;
+				read(&reader, num, &err);
+
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					read(&reader, len, &err);
+
+					const uint8_t* name;
+					if (!err.isOk()
+					||  !readRegion(len, name) )
+					{
+						return false;
+					}
+
+					Primitive prim;
+					read(&reader, prim.m_startIndex, &err);
+					read(&reader, prim.m_numIndices, &err);
+					read(&reader, prim.m_startVertex, &err);
+					read(&reader, prim.m_numVertices, &err);
+					read(&reader, prim.m_sphere, &err);
+					read(&reader, prim.m_aabb, &err);
+					read(&reader, prim.m_obb, &err);
+
+					if (!err.isOk()
+					||  uint64_t(prim.m_startIndex)  + prim.m_numIndices  > pending.m_group.m_numIndices
+					||  uint64_t(prim.m_startVertex) + prim.m_numVertices > pending.m_group.m_numVertices)
+					{
+						return false;
+					}
+
+					pending.m_group.m_prims.push_back(prim);
+				}
+
+				if (NULL == pending.m_vertices.m_data)
+				{
+					return false;
+				}
+
+				pendingGroups.push_back(pending);
+				pending = {};
+			}
+				break;
+
+			default:
+				// The size of unknown chunks is not known, so the rest of the file cannot be validated.
+				DBG("%08x at %d", chunk, int32_t(reader.getPos() ) );
+				return false;
+		}
+
+		if (!err.isOk() )
+		{
+			return false;
+		}
+	}
+
+	bx::AllocatorI* allocator = sample::bg::getAllocator();
+
+	m_file = _file;
+	for (PendingGroup& pendingGroup : pendingGroups)
+	{
+		Group& group = pendingGroup.m_group;
+		m_layout = pendingGroup.m_layout;
+
+		const uint32_t verticesSize = group.m_numVertices*m_layout.getStride();
+		if (pendingGroup.m_vertices.m_compressed)
+		{
+			const bgfx::Memory* mem = bgfx::alloc(verticesSize);
+			if (0 != meshopt_decodeVertexBuffer(mem->data, group.m_numVertices, m_layout.getStride(), pendingGroup.m_vertices.m_data, pendingGroup.m_vertices.m_size) )
+			{
+				DBG("Failed to decode compressed vertex buffer.");
+				bx::memSet(mem->data, 0, mem->size);
+			}
+
+			if (_ramcopy)
+			{
+				group.m_vertices = (uint8_t*)BX_ALLOC(allocator, verticesSize);
+				bx::memCopy(group.m_vertices, mem->data, mem->size);
+			}
+
+			group.m_vbh = bgfx::createVertexBuffer(mem, m_layout);
+		}
+		else
+		{
+			if (_ramcopy)
+			{
+				group.m_vertices = const_cast<uint8_t*>(pendingGroup.m_vertices.m_data);
+			}
+
+			group.m_vbh = bgfx::createVertexBuffer(makeMeshFileRef(_file, pendingGroup.m_vertices.m_data, verticesSize), m_layout);
+		}
+
+		if (NULL != pendingGroup.m_indices.m_data)
+		{
+			const uint32_t indicesSize = group.m_numIndices*2;
+			if (pendingGroup.m_indices.m_compressed)
+			{
+				const bgfx::Memory* mem = bgfx::alloc(indicesSize);
+				if (0 != meshopt_decodeIndexBuffer(mem->data, group.m_numIndices, 2, pendingGroup.m_indices.m_data, pendingGroup.m_indices.m_size) )
+				{
+					DBG("Failed to decode compressed index buffer.");
+					bx::memSet(mem->data, 0, mem->size);
+				}
+
+				if (_ramcopy)
+				{
+					group.m_indices = (uint16_t*)BX_ALLOC(allocator, indicesSize);
+					bx::memCopy(group.m_indices, mem->data, mem->size);
+				}
+
+				group.m_ibh = bgfx::createIndexBuffer(mem);
+			}
+			else
+			{
+				if (_ramcopy)
+				{
+					group.m_indices = (uint16_t*)const_cast<uint8_t*>(pendingGroup.m_indices.m_data);
+				}
+
+				group.m_ibh = bgfx::createIndexBuffer(makeMeshFileRef(_file, pendingGroup.m_indices.m_data, indicesSize) );
+			}
+		}
+
+		m_groups.push_back(group);
+	}
+
+	return true;
+}
+
 void Mesh::unload()
 {
     bx::AllocatorI* allocator = sample::bg::getAllocator();
 
+	// The RAM copies of uncompressed buffers of mapped meshes view the mapping.
+	const uint8_t* mappedBegin = NULL != m_file ? m_file->Data() : NULL;
+	const uint8_t* mappedEnd   = NULL != m_file ? m_file->Data() + m_file->Size() : NULL;
+	const auto isMapped = [mappedBegin, mappedEnd](const void* _ptr)
+	{
+		return (const uint8_t*)_ptr >= mappedBegin && (const uint8_t*)_ptr < mappedEnd;
+	};
+
 	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
 	{
 		const Group& group = *it;
@@ -576,17 +853,22 @@ void Mesh::unload()
 			bgfx::destroy(group.m_ibh);
 		}
 
-		if (NULL != group.m_vertices)
+		if (NULL != group.m_vertices
+		&&  !isMapped(group.m_vertices) )
 		{
 			BX_FREE(allocator, group.m_vertices);
 		}
 
-		if (NULL != group.m_indices)
+		if (NULL != group.m_indices
+		&&  !isMapped(group.m_indices) )
 		{
 			BX_FREE(allocator, group.m_indices);
 		}
 	}
 	m_groups.clear();
+
+	// Buffers still referenced by bgfx keep the mapping alive until they are released.
+	m_file.reset();
 }
 
 void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const
@@ -654,6 +936,148 @@ void Mesh::submit(const MeshState*const* _state, uint8_t _numPasses, const float
 	}
 }
 
+// Whether bounds in mesh space, transformed by _mtx, are outside of one of the world space frustum planes. The sphere
+// is tested first, since it is cheaper, then the box.
+static bool isOutsideFrustum(const Sphere& _sphere, const Aabb& _aabb, const float* _mtx, const bx::Plane* _frustum)
+{
+	const float scale = bx::max(
+		  bx::length(bx::Vec3{_mtx[0], _mtx[1], _mtx[ 2]})
+		, bx::length(bx::Vec3{_mtx[4], _mtx[5], _mtx[ 6]})
+		, bx::length(bx::Vec3{_mtx[8], _mtx[9], _mtx[10]})
+		);
+	const bx::Vec3 sphereCenter = bx::mul(_sphere.center, _mtx);
+	const float    sphereRadius = _sphere.radius * scale;
+
+	const bx::Vec3 center  = bx::mul(bx::mul(bx::add(_aabb.min, _aabb.max), 0.5f), _mtx);
+	const bx::Vec3 extents = bx::mul(bx::sub(_aabb.max, _aabb.min), 0.5f);
+	const bx::Vec3 boxExtents =
+	{
+		bx::abs(_mtx[0])*extents.x + bx::abs(_mtx[4])*extents.y + bx::abs(_mtx[ 8])*extents.z,
+		bx::abs(_mtx[1])*extents.x + bx::abs(_mtx[5])*extents.y + bx::abs(_mtx[ 9])*extents.z,
+		bx::abs(_mtx[2])*extents.x + bx::abs(_mtx[6])*extents.y + bx::abs(_mtx[10])*extents.z,
+	};
+
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		const bx::Plane& plane = _frustum[ii];
+		if (bx::dot(plane.normal, sphereCenter) + plane.dist < -sphereRadius)
+		{
+			return true;
+		}
+
+		const float boxRadius = 0
+			+ bx::abs(plane.normal.x)*boxExtents.x
+			+ bx::abs(plane.normal.y)*boxExtents.y
+			+ bx::abs(plane.normal.z)*boxExtents.z
+			;
+		if (bx::dot(plane.normal, center) + plane.dist < -boxRadius)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Mesh::submitCulled(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const bx::Plane* _frustum, uint64_t _state, bool _perPrimitive, MeshCullStats* _stats) const
+{
+	if (BGFX_STATE_MASK == _state)
+	{
+		_state = 0
+			| BGFX_STATE_WRITE_RGB
+			| BGFX_STATE_WRITE_A
+			| BGFX_STATE_WRITE_Z
+			| BGFX_STATE_DEPTH_TEST_LESS
+			| BGFX_STATE_CULL_CCW
+			| BGFX_STATE_MSAA
+			;
+	}
+
+	MeshCullStats stats = {};
+	bool submitted = false;
+	const auto submitRange = [&](const Group& _group, uint32_t _startIndex, uint32_t _numIndices)
+	{
+		// The transform and state are only set once something is visible, and are kept for the following draws.
+		if (!submitted)
+		{
+			bgfx::setTransform(_mtx);
+			bgfx::setState(_state);
+			submitted = true;
+		}
+
+		// Set even when invalid, so that a non-indexed group does not draw with the index buffer of the previous group.
+		bgfx::setIndexBuffer(_group.m_ibh, _startIndex, _numIndices);
+		bgfx::setVertexBuffer(0, _group.m_vbh);
+		bgfx::submit(_id, _program, 0, BGFX_DISCARD_NONE);
+	};
+
+	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+	{
+		const Group& group = *it;
+		if (isOutsideFrustum(group.m_sphere, group.m_aabb, _mtx, _frustum) )
+		{
+			stats.m_numGroupsCulled++;
+			stats.m_numPrimsCulled += uint32_t(group.m_prims.size() );
+			continue;
+		}
+
+		stats.m_numGroupsSubmitted++;
+		if (!_perPrimitive
+		||  !bgfx::isValid(group.m_ibh) )
+		{
+			stats.m_numPrimsSubmitted += uint32_t(group.m_prims.size() );
+			submitRange(group, 0, UINT32_MAX);
+			continue;
+		}
+
+		// Visible primitives whose index ranges are adjacent are drawn together.
+		uint32_t startIndex = 0;
+		uint32_t numIndices = 0;
+		for (PrimitiveArray::const_iterator primIt = group.m_prims.begin(), primItEnd = group.m_prims.end(); primIt != primItEnd; ++primIt)
+		{
+			const Primitive& prim = *primIt;
+			if (isOutsideFrustum(prim.m_sphere, prim.m_aabb, _mtx, _frustum) )
+			{
+				stats.m_numPrimsCulled++;
+				continue;
+			}
+
+			stats.m_numPrimsSubmitted++;
+			if (0 < numIndices
+			&&  startIndex + numIndices == prim.m_startIndex)
+			{
+				numIndices += prim.m_numIndices;
+				continue;
+			}
+
+			if (0 < numIndices)
+			{
+				submitRange(group, startIndex, numIndices);
+			}
+			startIndex = prim.m_startIndex;
+			numIndices = prim.m_numIndices;
+		}
+
+		if (0 < numIndices)
+		{
+			submitRange(group, startIndex, numIndices);
+		}
+	}
+
+	if (submitted)
+	{
+		bgfx::discard();
+	}
+
+	if (NULL != _stats)
+	{
+		_stats->m_numGroupsSubmitted += stats.m_numGroupsSubmitted;
+		_stats->m_numGroupsCulled    += stats.m_numGroupsCulled;
+		_stats->m_numPrimsSubmitted  += stats.m_numPrimsSubmitted;
+		_stats->m_numPrimsCulled     += stats.m_numPrimsCulled;
+	}
+}
+
 Mesh* meshLoad(bx::ReaderSeekerI* _reader, bool _ramcopy)
 {
 	Mesh* mesh = new Mesh;
@@ -674,12 +1098,248 @@ Mesh* meshLoad(const char* _filePath, bool _ramcopy)
 	return NULL;
 }
 
+Mesh* meshLoadMapped(const char* _filePath, bool _ramcopy)
+{
+	std::shared_ptr<const sample::MappedFile> file;
+	try
+	{
+		file = std::make_shared<const sample::MappedFile>(_filePath);
+	}
+	catch (const std::exception&)
+	{
+		DBG("Failed to map: %s.", _filePath);
+		return NULL;
+	}
+
+	Mesh* mesh = new Mesh;
+	if (!mesh->load(file, _ramcopy) )
+	{
+		DBG("Invalid mesh: %s.", _filePath);
+		delete mesh;
+		return NULL;
+	}
+
+	return mesh;
+}
+
 void meshUnload(Mesh* _mesh)
 {
 	_mesh->unload();
 	delete _mesh;
 }
 
+bool meshCompress(bx::ReaderSeekerI* _reader, bx::WriterI* _writer)
+{
+	using namespace bx;
+	using namespace bgfx;
+
+	bx::AllocatorI* allocator = sample::bg::getAllocator();
+
+	uint32_t chunk;
+	bx::Error err;
+	while (4 == bx::read(_reader, chunk, &err)
+	   &&  err.isOk() )
+	{
+		switch (chunk)
+		{
+			case kChunkVertexBuffer:
+			{
+				Sphere sphere;
+				Aabb aabb;
+				Obb obb;
+				read(_reader, sphere);
+				read(_reader, aabb);
+				read(_reader, obb);
+
+				VertexLayout layout;
+				read(_reader, layout);
+
+				const uint16_t stride = layout.getStride();
+
+				uint16_t numVertices;
+				read(_reader, numVertices);
+
+				const uint32_t size = numVertices*stride;
+				uint8_t* vertices = (uint8_t*)BX_ALLOC(allocator, size);
+				read(_reader, vertices, size);
+
+				const uint32_t bound = uint32_t(meshopt_encodeVertexBufferBound(numVertices, stride) );
+				uint8_t* compressedVertices = (uint8_t*)BX_ALLOC(allocator, bound);
+				const uint32_t compressedSize = uint32_t(meshopt_encodeVertexBuffer(compressedVertices, bound, vertices, numVertices, stride) );
+
+				write(_writer, kChunkVertexBufferCompressed);
+				write(_writer, sphere);
+				write(_writer, aabb);
+				write(_writer, obb);
+				write(_writer, layout);
+				write(_writer, numVertices);
+				write(_writer, compressedSize);
+				write(_writer, compressedVertices, compressedSize);
+
+				BX_FREE(allocator, compressedVertices);
+				BX_FREE(allocator, vertices);
+			}
+				break;
+
+			case kChunkIndexBuffer:
+			{
+				uint32_t numIndices;
+				read(_reader, numIndices);
+
+				const uint32_t size = numIndices*2;
+				uint16_t* indices = (uint16_t*)BX_ALLOC(allocator, size);
+				read(_reader, indices, size);
+
+				// The index codec only encodes triangle lists.
+				if (0 == numIndices % 3)
+				{
+					const uint32_t bound = uint32_t(meshopt_encodeIndexBufferBound(numIndices, UINT16_MAX+1) );
+					uint8_t* compressedIndices = (uint8_t*)BX_ALLOC(allocator, bound);
+					const uint32_t compressedSize = uint32_t(meshopt_encodeIndexBuffer(compressedIndices, bound, indices, numIndices) );
+
+					write(_writer, kChunkIndexBufferCompressed);
+					write(_writer, numIndices);
+					write(_writer, compressedSize);
+					write(_writer, compressedIndices, compressedSize);
+
+					BX_FREE(allocator, compressedIndices);
+				}
+				else
+				{
+					write(_writer, kChunkIndexBuffer);
+					write(_writer, numIndices);
+					write(_writer, indices, size);
+				}
+
+				BX_FREE(allocator, indices);
+			}
+				break;
+
+			case kChunkVertexBufferCompressed:
+			{
+				// Already compressed, copied as is.
+				uint8_t bounds[sizeof(Sphere) + sizeof(Aabb) + sizeof(Obb)];
+				read(_reader, bounds, sizeof(bounds) );
+
+				VertexLayout layout;
+				read(_reader, layout);
+
+				uint16_t numVertices;
+				read(_reader, numVertices);
+
+				uint32_t compressedSize;
+				read(_reader, compressedSize);
+				uint8_t* compressedVertices = (uint8_t*)BX_ALLOC(allocator, compressedSize);
+				read(_reader, compressedVertices, compressedSize);
+
+				write(_writer, kChunkVertexBufferCompressed);
+				write(_writer, bounds, sizeof(bounds) );
+				write(_writer, layout);
+				write(_writer, numVertices);
+				write(_writer, compressedSize);
+				write(_writer, compressedVertices, compressedSize);
+
+				BX_FREE(allocator, compressedVertices);
+			}
+				break;
+
+			case kChunkIndexBufferCompressed:
+			{
+				uint32_t numIndices;
+				read(_reader, numIndices);
+
+				uint32_t compressedSize;
+				read(_reader, compressedSize);
+				uint8_t* compressedIndices = (uint8_t*)BX_ALLOC(allocator, compressedSize);
+				read(_reader, compressedIndices, compressedSize);
+
+				write(_writer, kChunkIndexBufferCompressed);
+				write(_writer, numIndices);
+				write(_writer, compressedSize);
+				write(_writer, compressedIndices, compressedSize);
+
+				BX_FREE(allocator, compressedIndices);
+			}
+				break;
+
+			case kChunkPrimitive:
+			{
+				uint16_t len;
+				read(_reader, len);
+
+				stl::string material;
+				material.resize(len);
+				read(_reader, const_cast<char*>(material.c_str() ), len);
+
+				uint16_t num;
+				read(_reader, num);
+
+				write(_writer, kChunkPrimitive);
+				write(_writer, len);
+				write(_writer, material.c_str(), len);
+				write(_writer, num);
+
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					read(_reader, len);
+
+					stl::string name;
+					name.resize(len);
+					read(_reader, const_cast<char*>(name.c_str() ), len);
+
+					Primitive prim;
+					read(_reader, prim.m_startIndex);
+					read(_reader, prim.m_numIndices);
+					read(_reader, prim.m_startVertex);
+					read(_reader, prim.m_numVertices);
+					read(_reader, prim.m_sphere);
+					read(_reader, prim.m_aabb);
+					read(_reader, prim.m_obb);
+
+					write(_writer, len);
+					write(_writer, name.c_str(), len);
+					write(_writer, prim.m_startIndex);
+					write(_writer, prim.m_numIndices);
+					write(_writer, prim.m_startVertex);
+					write(_writer, prim.m_numVertices);
+					write(_writer, prim.m_sphere);
+					write(_writer, prim.m_aabb);
+					write(_writer, prim.m_obb);
+				}
+			}
+				break;
+
+			default:
+				// The length of unknown chunks is not known, so they cannot be copied.
+				DBG("%08x at %d", chunk, bx::skip(_reader, 0) );
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool meshCompress(const char* _srcFilePath, const char* _dstFilePath)
+{
+	bx::FileReaderI* reader = sample::bg::getFileReader();
+	if (!bx::open(reader, _srcFilePath) )
+	{
+		return false;
+	}
+
+	bx::FileWriterI* writer = sample::bg::getFileWriter();
+	if (!bx::open(writer, _dstFilePath) )
+	{
+		bx::close(reader);
+		return false;
+	}
+
+	const bool result = meshCompress(reader, writer);
+	bx::close(writer);
+	bx::close(reader);
+	return result;
+}
+
 MeshState* meshStateCreate()
 {
     MeshState* state = (MeshState*)BX_ALLOC(sample::bg::getAllocator(), sizeof(MeshState));
@@ -701,6 +1361,33 @@ void meshSubmit(const Mesh* _mesh, const MeshState*const* _state, uint8_t _numPa
 	_mesh->submit(_state, _numPasses, _mtx, _numMatrices);
 }
 
+void meshSubmitCulled(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const bx::Plane* _frustum, uint64_t _state, bool _perPrimitive, MeshCullStats* _stats)
+{
+	_mesh->submitCulled(_id, _program, _mtx, _frustum, _state, _perPrimitive, _stats);
+}
+
+void meshSubmitCulled(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const float* _viewProj, uint64_t _state, bool _perPrimitive, MeshCullStats* _stats)
+{
+	// The same planes as buildFrustumPlanes, in another order: w - x, w + x, w - y, w + y, w - z and w + z, pointing inwards.
+	bx::Plane frustum[6];
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		const uint32_t axis = ii/2;
+		const float    sign = 0 == ii%2 ? -1.0f : 1.0f;
+		const bx::Vec3 normal =
+		{
+			_viewProj[ 3] + sign*_viewProj[    axis],
+			_viewProj[ 7] + sign*_viewProj[4 + axis],
+			_viewProj[11] + sign*_viewProj[8 + axis],
+		};
+		const float invLen = 1.0f/bx::length(normal);
+		frustum[ii].normal = bx::mul(normal, invLen);
+		frustum[ii].dist   = (_viewProj[15] + sign*_viewProj[12 + axis]) * invLen;
+	}
+
+	_mesh->submitCulled(_id, _program, _mtx, frustum, _state, _perPrimitive, _stats);
+}
+
 Args::Args(int _argc, const char* const* _argv)
 	: m_type(bgfx::RendererType::Count)
 	, m_pciId(BGFX_PCI_ID_NONE)
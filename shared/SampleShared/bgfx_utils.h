@@ -18,9 +18,12 @@
 #include <tinystl/allocator.h>
 #include <tinystl/vector.h>
 #include <wil/resource.h>
+#include <memory>
 
 namespace stl = tinystl;
 
+namespace sample { class MappedFile; }
+
 template <typename bgfx_handle_t>
 struct bgfx_handle_wrapper_t : public bgfx_handle_t {
     bgfx_handle_wrapper_t() {
@@ -173,23 +176,54 @@ struct Group
 };
 typedef stl::vector<Group> GroupArray;
 
+/// Counts of the groups and primitives which culling submits drew or skipped. They
+/// accumulate across calls, so reset them once per frame.
+///
+struct MeshCullStats
+{
+	uint32_t m_numGroupsSubmitted;
+	uint32_t m_numGroupsCulled;
+	uint32_t m_numPrimsSubmitted;
+	uint32_t m_numPrimsCulled;
+};
+
 struct Mesh
 {
 	void load(bx::ReaderSeekerI* _reader, bool _ramcopy);
+	bool load(const std::shared_ptr<const sample::MappedFile>& _file, bool _ramcopy);
 	void unload();
 	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const;
 	void submit(const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices) const;
+	void submitCulled(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const bx::Plane* _frustum, uint64_t _state, bool _perPrimitive, MeshCullStats* _stats) const;
 
 	bgfx::VertexLayout m_layout;
 	GroupArray m_groups;
+	std::shared_ptr<const sample::MappedFile> m_file; // Mapped mesh file, which uncompressed RAM copies view.
 };
 
 ///
 Mesh* meshLoad(const char* _filePath, bool _ramcopy = false);
 
+/// Loads a mesh from a memory-mapped file. All chunks are validated before any buffer is
+/// created, and uncompressed vertex and index buffers are given to bgfx by reference to
+/// the mapping instead of being copied. With _ramcopy, the CPU copies of uncompressed
+/// buffers are read-only views of the mapping. Returns NULL if the file cannot be mapped
+/// or is invalid.
+///
+Mesh* meshLoadMapped(const char* _filePath, bool _ramcopy = false);
+
 ///
 void meshUnload(Mesh* _mesh);
 
+/// Rewrites a mesh with its vertex and index buffers compressed by meshoptimizer, which
+/// meshLoad decodes. Returns false if the mesh has chunks which cannot be copied.
+///
+bool meshCompress(bx::ReaderSeekerI* _reader, bx::WriterI* _writer);
+
+/// Compresses the mesh file _srcFilePath to _dstFilePath, see meshCompress above.
+///
+bool meshCompress(const char* _srcFilePath, const char* _dstFilePath);
+
 ///
 MeshState* meshStateCreate();
 
@@ -202,6 +236,17 @@ void meshSubmit(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _progra
 ///
 void meshSubmit(const Mesh* _mesh, const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices = 1);
 
+/// Submits only the groups whose bounding sphere and box, transformed by _mtx, overlap the
+/// frustum given as the 6 inward facing world space planes buildFrustumPlanes returns. With
+/// _perPrimitive, the primitives of visible groups are culled as well, and the visible ones
+/// are drawn as index buffer sub-ranges, merging adjacent ones.
+///
+void meshSubmitCulled(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const bx::Plane* _frustum, uint64_t _state = BGFX_STATE_MASK, bool _perPrimitive = false, MeshCullStats* _stats = NULL);
+
+/// Same as above, culling against the frustum of the view-projection matrix _viewProj.
+///
+void meshSubmitCulled(const Mesh* _mesh, bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const float* _viewProj, uint64_t _state = BGFX_STATE_MASK, bool _perPrimitive = false, MeshCullStats* _stats = NULL);
+
 ///
 struct Args
 {
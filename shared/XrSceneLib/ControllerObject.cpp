@@ -15,7 +15,7 @@
 //*********************************************************
 
 #include "pch.h"
-#include <Pbr/GltfLoader.h>
+#include <Pbr/GltfModelLoader.h>
 #include "PbrModelObject.h"
 #include "ControllerObject.h"
 #include "SceneContext.h"
@@ -33,17 +33,30 @@ namespace {
         std::vector<XrControllerModelNodeStateMSFT> NodeStates;
     };
 
-    std::unique_ptr<ControllerModel> LoadControllerModel(SceneContext& sceneContext, XrControllerModelKeyMSFT modelKey) {
-        std::unique_ptr<ControllerModel> model = std::make_unique<ControllerModel>();
-        model->Key = modelKey;
-
-        // Load the controller model as GLTF binary stream using two call idiom
+    // Read the controller model as GLTF binary stream using two call idiom.
+    std::vector<uint8_t> ReadControllerModel(SceneContext& sceneContext, XrControllerModelKeyMSFT modelKey) {
         uint32_t bufferSize = 0;
         CHECK_XRCMD(sceneContext.Extensions.xrLoadControllerModelMSFT(sceneContext.Session.Handle, modelKey, 0, &bufferSize, nullptr));
-        auto modelBuffer = std::make_unique<byte[]>(bufferSize);
+        std::vector<uint8_t> modelBuffer(bufferSize);
         CHECK_XRCMD(sceneContext.Extensions.xrLoadControllerModelMSFT(
-            sceneContext.Session.Handle, modelKey, bufferSize, &bufferSize, modelBuffer.get()));
-        model->PbrModel = Gltf::FromGltfBinary(sceneContext.PbrResources, modelBuffer.get(), bufferSize);
+            sceneContext.Session.Handle, modelKey, bufferSize, &bufferSize, modelBuffer.data()));
+        modelBuffer.resize(bufferSize);
+        return modelBuffer;
+    }
+
+    // A model key always refers to the same model of the runtime and system, so it identifies the model in the cache without reading it.
+    std::string GetControllerModelCacheKey(const SceneContext& sceneContext, XrControllerModelKeyMSFT modelKey) {
+        return std::string("XR_MSFT_controller_model/") + sceneContext.Instance.Properties.runtimeName + "/" +
+               std::to_string(sceneContext.Instance.Properties.runtimeVersion) + "/" + sceneContext.System.Properties.systemName + "/" +
+               std::to_string(modelKey);
+    }
+
+    std::unique_ptr<ControllerModel> CreateControllerModel(SceneContext& sceneContext,
+                                                           XrControllerModelKeyMSFT modelKey,
+                                                           std::shared_ptr<Pbr::Model> pbrModel) {
+        std::unique_ptr<ControllerModel> model = std::make_unique<ControllerModel>();
+        model->Key = modelKey;
+        model->PbrModel = std::move(pbrModel);
 
         // Read the controller model properties with two call idiom
         XrControllerModelPropertiesMSFT properties{XR_TYPE_CONTROLLER_MODEL_PROPERTIES_MSFT};
@@ -103,7 +116,8 @@ namespace {
         const XrPath m_controllerUserPath;
 
         std::unique_ptr<ControllerModel> m_model;
-        std::future<std::unique_ptr<ControllerModel>> m_modelLoadingTask;
+        XrControllerModelKeyMSFT m_loadingModelKey{XR_NULL_CONTROLLER_MODEL_KEY_MSFT};
+        std::shared_ptr<Gltf::ModelLoadHandle> m_modelLoad;
     };
 
     ControllerObject::ControllerObject(SceneContext& sceneContext, XrPath controllerUserPath)
@@ -112,9 +126,9 @@ namespace {
     }
 
     ControllerObject::~ControllerObject() {
-        // Wait for model loading task to complete before dtor complete because it captures the scene context.
-        if (m_modelLoadingTask.valid()) {
-            m_modelLoadingTask.wait();
+        // The model loader outlives this object, so an unfinished load only needs to stop uploading.
+        if (m_modelLoad) {
+            m_modelLoad->Cancel();
         }
     }
 
@@ -126,20 +140,30 @@ namespace {
         // If a new valid model key is returned, reload the model into cache asynchronizely
         const bool modelKeyValid = controllerModelKeyState.modelKey != XR_NULL_CONTROLLER_MODEL_KEY_MSFT;
         if (modelKeyValid && (m_model == nullptr || m_model->Key != controllerModelKeyState.modelKey)) {
-            // Avoid two background tasks running together. The new one will start in future update after the old one is finished.
-            if (!m_modelLoadingTask.valid()) {
-                m_modelLoadingTask =
-                    std::async(std::launch::async, [& sceneContext = m_sceneContext, modelKey = controllerModelKeyState.modelKey]() {
-                        return LoadControllerModel(sceneContext, modelKey);
-                    });
+            // Avoid two background loads running together. The new one will start in future update after the old one is finished.
+            if (!m_modelLoad) {
+                m_loadingModelKey = controllerModelKeyState.modelKey;
+                m_modelLoad = m_sceneContext.ModelLoader.LoadBinary(
+                    [&sceneContext = m_sceneContext, modelKey = m_loadingModelKey]() {
+                        return ReadControllerModel(sceneContext, modelKey);
+                    },
+                    {} /* options */,
+                    {} /* callback */,
+                    GetControllerModelCacheKey(m_sceneContext, m_loadingModelKey));
             }
         }
 
-        // If controller model loading task is completed, get the result model and apply it to rendering.
-        if (m_modelLoadingTask.valid() && m_modelLoadingTask.wait_for(0s) == std::future_status::ready) {
-            m_model = m_modelLoadingTask.get(); // future.valid() is reset to false after get()
-            if (m_model) {
+        // As soon as the loading model can be rendered, apply it to rendering. The loader keeps filling it in over the next frames.
+        if (m_modelLoad) {
+            if (m_modelLoad->GetState() == Gltf::ModelLoadState::Failed) {
+                const std::exception_ptr error = m_modelLoad->GetError();
+                m_modelLoad.reset();
+                std::rethrow_exception(error);
+            }
+            if (m_modelLoad->GetModel()) {
+                m_model = CreateControllerModel(m_sceneContext, m_loadingModelKey, m_modelLoad->GetModel());
                 SetModel(m_model->PbrModel);
+                m_modelLoad.reset();
             }
         }
 
@@ -243,6 +243,11 @@ bool ProjectionLayer::Render(SceneContext& sceneContext,
             const DirectX::XMMATRIX projectionMatrix = xr::math::ComposeProjectionMatrix(fov, currentConfig.NearFar);
             
             sceneContext.PbrResources.SetViewProjection(worldToViewMatrix, projectionMatrix);
+            // Each view is rendered into the bgfx view matching its index, see sample::bg::RenderView.
+            sceneContext.PbrResources.SetViewParameters((bgfx::ViewId)viewIndex,
+                                                        xr::math::LoadInvertedXrPose(projection.pose),
+                                                        projectionMatrix,
+                                                        (float)imageRect.extent.height);
             // sceneContext.PbrResources.Bind();
             sceneContext.PbrResources.SetDepthFuncReversed(reversedZ);
             const XrPosef viewPose = projection.pose;
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <pbr/PbrResources.h>
+#include <pbr/GltfModelLoader.h>
 #include <XrUtility/XrString.h>
 #include <XrUtility/XrInstanceContext.h>
 #include <XrUtility/XrExtensionContext.h>
@@ -40,6 +41,7 @@ struct SceneContext final {
         , PbrResources(std::move(pbrResources))
         , Device(std::move(device))
         , DeviceContext(std::move(deviceContext))
+        , ModelLoader(PbrResources, std::make_shared<Gltf::ModelCache>(std::filesystem::temp_directory_path() / L"PbrModelCache"))
         , LeftHand(xr::StringToPath(Instance.Handle, "/user/hand/left"))
         , RightHand(xr::StringToPath(Instance.Handle, "/user/hand/right")) {
     }
@@ -55,6 +57,10 @@ struct SceneContext final {
     const winrt::com_ptr<ID3D11Device> Device;
     Pbr::Resources PbrResources;
 
+    // Loads models in the background, through a cache of prepared models in the temporary folder.
+    // Updated once per frame before the scenes, on the update thread.
+    Gltf::ModelLoader ModelLoader;
+
     std::atomic<XrSessionState> SessionState;
 
     const XrPath RightHand;
@@ -494,6 +494,9 @@ namespace {
 
             m_currentFrameTime.Update(frameState);
 
+            // Upload the models loaded in the background, and notify their scenes, before the scenes update.
+            SceneContext().ModelLoader.Update();
+
             for (auto& scene : m_scenes) {
                 if (scene->IsActive()) {
                     scene->Update(m_currentFrameTime);
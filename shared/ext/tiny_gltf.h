@@ -3971,8 +3971,23 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
   buffer->uri.clear();
   ParseStringProperty(&buffer->uri, err, o, "uri", false, "Buffer");
 
+  // OpenXR-MixedReality patch: a fallback buffer of EXT_meshopt_compression
+  // may have no data, since the compressed buffer views which refer to it are
+  // read instead.
+  bool meshopt_fallback = false;
+  if (buffer->uri.empty()) {
+    json_const_iterator extensions_it, meshopt_it;
+    if (FindMember(o, "extensions", extensions_it) &&
+        FindMember(GetValue(extensions_it), "EXT_meshopt_compression",
+                   meshopt_it)) {
+      ParseBooleanProperty(&meshopt_fallback, nullptr, GetValue(meshopt_it),
+                           "fallback", false);
+    }
+  }
+
   // having an empty uri for a non embedded image should not be valid
-  if (!is_binary && buffer->uri.empty()) {
+  // OpenXR-MixedReality patch: unless it is a meshopt fallback buffer.
+  if (!is_binary && buffer->uri.empty() && !meshopt_fallback) {
     if (err) {
       (*err) += "'uri' is missing from non binary glTF file buffer.\n";
     }
@@ -3988,7 +4003,9 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
     }
   }
 
-  if (is_binary) {
+  // OpenXR-MixedReality patch: meshopt fallback buffers have no data to load.
+  if (meshopt_fallback) {
+  } else if (is_binary) {
     // Still binary glTF accepts external dataURI.
     if (!buffer->uri.empty()) {
       // First try embedded data URI.
@@ -2,13 +2,22 @@
 // Copyright (C) Microsoft Corporation.  All Rights Reserved
 // Licensed under the MIT License. See License.txt in the project root for license information.
 #include "pch.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #define TINYGLTF_USE_RAPIDJSON
 #define TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include <tiny_gltf.h>
 #include <mikktspace.h>
+#include <stb_image.h>
 #include "GltfHelper.h"
+#include "PixelConversion.h"
+#include <DirectXPackedVector.h>
 
 using namespace DirectX;
 
@@ -16,49 +25,71 @@ using namespace DirectX;
 
 namespace
 {
+    // Attributes of the triangle corners of a primitive, fetched in face order so that the MikkTSpace callbacks read them
+    // directly rather than through the index buffer and the interleaved vertices.
+    struct MikkTSpaceCorners
+    {
+        explicit MikkTSpaceCorners(GltfHelper::Primitive& primitive)
+            : Primitive(primitive)
+        {
+            const size_t cornerCount = primitive.Indices.size();
+            Positions.resize(cornerCount);
+            Normals.resize(cornerCount);
+            TexCoords.resize(cornerCount);
+            for (size_t i = 0; i < cornerCount; i++)
+            {
+                const GltfHelper::Vertex& vertex = primitive.Vertices[primitive.Indices[i]];
+                Positions[i] = {vertex.Position.x, vertex.Position.y, vertex.Position.z};
+                Normals[i] = vertex.Normal;
+                TexCoords[i] = vertex.TexCoord0;
+            }
+        }
+
+        GltfHelper::Primitive& Primitive;
+        std::vector<XMFLOAT3> Positions;
+        std::vector<XMFLOAT3> Normals;
+        std::vector<XMFLOAT2> TexCoords;
+    };
+
     // The glTF 2 specification recommends using the MikkTSpace algorithm to generate
     // tangents when none are available. This function takes a GltfHelper Primitive which has
     // no tangents and uses the MikkTSpace algorithm to generate the tangents. This can
     // be computationally expensive.
-    void ComputeTriangleTangents(GltfHelper::Primitive& primitive)
+    void ComputeTriangleTangentsMikkTSpace(GltfHelper::Primitive& primitive)
     {
+        assert((primitive.Indices.size() % TRIANGLE_VERTEX_COUNT) == 0); // Only triangles are supported.
+        MikkTSpaceCorners corners(primitive);
+
         // Set up the callbacks so that MikkTSpace can read the Primitive data.
         SMikkTSpaceInterface mikkInterface{};
         mikkInterface.m_getNumFaces = [](const SMikkTSpaceContext* pContext) {
-            auto primitive = static_cast<const GltfHelper::Primitive*>(pContext->m_pUserData);
-            assert((primitive->Indices.size() % TRIANGLE_VERTEX_COUNT) == 0); // Only triangles are supported.
-            return (int)(primitive->Indices.size() / TRIANGLE_VERTEX_COUNT);
+            auto corners = static_cast<const MikkTSpaceCorners*>(pContext->m_pUserData);
+            return (int)(corners->Positions.size() / TRIANGLE_VERTEX_COUNT);
         };
         mikkInterface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext* pContext, int iFace) {
             return TRIANGLE_VERTEX_COUNT;
         };
         mikkInterface.m_getPosition = [](const SMikkTSpaceContext * pContext, float fvPosOut[], const int iFace, const int iVert) {
-            auto primitive = static_cast<const GltfHelper::Primitive*>(pContext->m_pUserData);
-            const auto vertexIndex = primitive->Indices[(iFace * TRIANGLE_VERTEX_COUNT) + iVert];
-            memcpy(fvPosOut, &primitive->Vertices[vertexIndex].Position, sizeof(float) * 3);
+            auto corners = static_cast<const MikkTSpaceCorners*>(pContext->m_pUserData);
+            memcpy(fvPosOut, &corners->Positions[(iFace * TRIANGLE_VERTEX_COUNT) + iVert], sizeof(float) * 3);
         };
         mikkInterface.m_getNormal = [](const SMikkTSpaceContext * pContext, float fvNormOut[], const int iFace, const int iVert) {
-            auto primitive = static_cast<const GltfHelper::Primitive*>(pContext->m_pUserData);
-            const auto vertexIndex = primitive->Indices[(iFace * TRIANGLE_VERTEX_COUNT) + iVert];
-            memcpy(fvNormOut, &primitive->Vertices[vertexIndex].Normal, sizeof(float) * 3);
+            auto corners = static_cast<const MikkTSpaceCorners*>(pContext->m_pUserData);
+            memcpy(fvNormOut, &corners->Normals[(iFace * TRIANGLE_VERTEX_COUNT) + iVert], sizeof(float) * 3);
         };
         mikkInterface.m_getTexCoord = [](const SMikkTSpaceContext * pContext, float fvTexcOut[], const int iFace, const int iVert) {
-            auto primitive = static_cast<const GltfHelper::Primitive*>(pContext->m_pUserData);
-            const auto vertexIndex = primitive->Indices[(iFace * TRIANGLE_VERTEX_COUNT) + iVert];
-            memcpy(fvTexcOut, &primitive->Vertices[vertexIndex].TexCoord0, sizeof(float) * 2);
+            auto corners = static_cast<const MikkTSpaceCorners*>(pContext->m_pUserData);
+            memcpy(fvTexcOut, &corners->TexCoords[(iFace * TRIANGLE_VERTEX_COUNT) + iVert], sizeof(float) * 2);
         };
         mikkInterface.m_setTSpaceBasic = [](const SMikkTSpaceContext * pContext, const float fvTangent[], const float fSign, const int iFace, const int iVert) {
-            auto primitive = static_cast<GltfHelper::Primitive*>(pContext->m_pUserData);
-            const auto vertexIndex = primitive->Indices[(iFace * TRIANGLE_VERTEX_COUNT) + iVert];
-            primitive->Vertices[vertexIndex].Tangent.x = fvTangent[0];
-            primitive->Vertices[vertexIndex].Tangent.y = fvTangent[1];
-            primitive->Vertices[vertexIndex].Tangent.z = fvTangent[2];
-            primitive->Vertices[vertexIndex].Tangent.w = fSign;
+            auto corners = static_cast<MikkTSpaceCorners*>(pContext->m_pUserData);
+            const auto vertexIndex = corners->Primitive.Indices[(iFace * TRIANGLE_VERTEX_COUNT) + iVert];
+            corners->Primitive.Vertices[vertexIndex].Tangent = {fvTangent[0], fvTangent[1], fvTangent[2], fSign};
         };
 
         // Run the MikkTSpace algorithm.
         SMikkTSpaceContext mikkContext{};
-        mikkContext.m_pUserData = &primitive;
+        mikkContext.m_pUserData = &corners;
         mikkContext.m_pInterface = &mikkInterface;
         if (genTangSpaceDefault(&mikkContext) == 0)
         {
@@ -66,6 +97,239 @@ namespace
         }
     }
 
+    // The fast tangent generator processes four triangles or vertices at a time, one per SIMD lane.
+    constexpr size_t SimdWidth = 4;
+
+    size_t AlignToSimdWidth(size_t count)
+    {
+        return (count + SimdWidth - 1) / SimdWidth * SimdWidth;
+    }
+
+    // Calls function(begin, end) over ranges covering [0, count) on up to threadCount threads, including the calling thread.
+    // The ranges start at multiples of the SIMD width.
+    template <typename TFunction>
+    void ParallelFor(size_t count, uint32_t threadCount, const TFunction& function)
+    {
+        const size_t rangeSize = AlignToSimdWidth((count + threadCount - 1) / threadCount);
+        std::vector<std::thread> threads;
+        for (size_t begin = rangeSize; begin < count; begin += rangeSize)
+        {
+            threads.emplace_back([&function, begin, end = std::min(begin + rangeSize, count)] { function(begin, end); });
+        }
+
+        function(0, std::min(rangeSize, count));
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    // A structure of arrays of 3D vectors, padded to a multiple of the SIMD width so that any aligned group of four can be loaded.
+    struct Float3Array
+    {
+        explicit Float3Array(size_t count)
+            : X(AlignToSimdWidth(count)), Y(AlignToSimdWidth(count)), Z(AlignToSimdWidth(count))
+        {
+        }
+
+        void XM_CALLCONV Store4(size_t index, FXMVECTOR x, FXMVECTOR y, FXMVECTOR z)
+        {
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&X[index]), x);
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Y[index]), y);
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Z[index]), z);
+        }
+
+        std::vector<float> X, Y, Z;
+    };
+
+    XMVECTOR Load4(const std::vector<float>& array, size_t index)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&array[index]));
+    }
+
+    XMVECTOR Gather4(const std::vector<float>& array, const uint32_t (&indices)[SimdWidth])
+    {
+        return XMVectorSet(array[indices[0]], array[indices[1]], array[indices[2]], array[indices[3]]);
+    }
+
+    // Generates approximate tangents: the UV-space tangents and bitangents of the triangles are accumulated per vertex, and the
+    // sums are orthogonalized against the normals (Gram-Schmidt). The attributes are first fetched into structures of arrays, then
+    // the triangles and the vertices are processed four at a time. Very large primitives are split across threads.
+    void ComputeTriangleTangentsFast(GltfHelper::Primitive& primitive, const GltfHelper::TangentOptions& options)
+    {
+        assert((primitive.Indices.size() % TRIANGLE_VERTEX_COUNT) == 0); // Only triangles are supported.
+        const size_t triangleCount = primitive.Indices.size() / TRIANGLE_VERTEX_COUNT;
+        const size_t vertexCount = primitive.Vertices.size();
+        if (triangleCount == 0)
+        {
+            return;
+        }
+
+        const uint32_t threadCount =
+            triangleCount >= options.ParallelTriangleThreshold ? std::max<uint32_t>(options.MaxThreadCount, 1) : 1;
+
+        // Fetch the vertex attributes.
+        Float3Array positions(vertexCount);
+        Float3Array normals(vertexCount);
+        std::vector<float> texCoordsU(AlignToSimdWidth(vertexCount));
+        std::vector<float> texCoordsV(AlignToSimdWidth(vertexCount));
+        for (size_t i = 0; i < vertexCount; i++)
+        {
+            const GltfHelper::Vertex& vertex = primitive.Vertices[i];
+            positions.X[i] = vertex.Position.x;
+            positions.Y[i] = vertex.Position.y;
+            positions.Z[i] = vertex.Position.z;
+            normals.X[i] = vertex.Normal.x;
+            normals.Y[i] = vertex.Normal.y;
+            normals.Z[i] = vertex.Normal.z;
+            texCoordsU[i] = vertex.TexCoord0.x;
+            texCoordsV[i] = vertex.TexCoord0.y;
+        }
+
+        // Compute the tangent and bitangent of each triangle. The tangents are not normalized, so that larger triangles have more
+        // weight, like the normals generated by ComputeTriangleNormals. Triangles with degenerate texture coordinates contribute nothing.
+        Float3Array triangleTangents(triangleCount);
+        Float3Array triangleBitangents(triangleCount);
+        ParallelFor(triangleCount, threadCount, [&](size_t begin, size_t end) {
+            for (size_t triangle = begin; triangle < end; triangle += SimdWidth)
+            {
+                // The lanes past the last triangle repeat it, and their results land in the padding.
+                uint32_t corners[TRIANGLE_VERTEX_COUNT][SimdWidth];
+                for (size_t lane = 0; lane < SimdWidth; lane++)
+                {
+                    const size_t firstIndex = std::min(triangle + lane, triangleCount - 1) * TRIANGLE_VERTEX_COUNT;
+                    for (size_t corner = 0; corner < TRIANGLE_VERTEX_COUNT; corner++)
+                    {
+                        corners[corner][lane] = primitive.Indices[firstIndex + corner];
+                    }
+                }
+
+                const XMVECTOR x0 = Gather4(positions.X, corners[0]);
+                const XMVECTOR y0 = Gather4(positions.Y, corners[0]);
+                const XMVECTOR z0 = Gather4(positions.Z, corners[0]);
+                const XMVECTOR u0 = Gather4(texCoordsU, corners[0]);
+                const XMVECTOR v0 = Gather4(texCoordsV, corners[0]);
+
+                const XMVECTOR e1x = XMVectorSubtract(Gather4(positions.X, corners[1]), x0);
+                const XMVECTOR e1y = XMVectorSubtract(Gather4(positions.Y, corners[1]), y0);
+                const XMVECTOR e1z = XMVectorSubtract(Gather4(positions.Z, corners[1]), z0);
+                const XMVECTOR e2x = XMVectorSubtract(Gather4(positions.X, corners[2]), x0);
+                const XMVECTOR e2y = XMVectorSubtract(Gather4(positions.Y, corners[2]), y0);
+                const XMVECTOR e2z = XMVectorSubtract(Gather4(positions.Z, corners[2]), z0);
+                const XMVECTOR du1 = XMVectorSubtract(Gather4(texCoordsU, corners[1]), u0);
+                const XMVECTOR dv1 = XMVectorSubtract(Gather4(texCoordsV, corners[1]), v0);
+                const XMVECTOR du2 = XMVectorSubtract(Gather4(texCoordsU, corners[2]), u0);
+                const XMVECTOR dv2 = XMVectorSubtract(Gather4(texCoordsV, corners[2]), v0);
+
+                const XMVECTOR determinant = XMVectorSubtract(XMVectorMultiply(du1, dv2), XMVectorMultiply(du2, dv1));
+                const XMVECTOR degenerate = XMVectorLess(XMVectorAbs(determinant), XMVectorReplicate(1e-20f));
+                const XMVECTOR scale = XMVectorSelect(XMVectorReciprocal(determinant), g_XMZero, degenerate);
+
+                // tangent = (e1 * dv2 - e2 * dv1) / determinant, bitangent = (e2 * du1 - e1 * du2) / determinant
+                const XMVECTOR dv2Scaled = XMVectorMultiply(dv2, scale);
+                const XMVECTOR dv1Scaled = XMVectorMultiply(dv1, scale);
+                const XMVECTOR du1Scaled = XMVectorMultiply(du1, scale);
+                const XMVECTOR du2Scaled = XMVectorMultiply(du2, scale);
+                triangleTangents.Store4(triangle,
+                                        XMVectorNegativeMultiplySubtract(e2x, dv1Scaled, XMVectorMultiply(e1x, dv2Scaled)),
+                                        XMVectorNegativeMultiplySubtract(e2y, dv1Scaled, XMVectorMultiply(e1y, dv2Scaled)),
+                                        XMVectorNegativeMultiplySubtract(e2z, dv1Scaled, XMVectorMultiply(e1z, dv2Scaled)));
+                triangleBitangents.Store4(triangle,
+                                          XMVectorNegativeMultiplySubtract(e1x, du2Scaled, XMVectorMultiply(e2x, du1Scaled)),
+                                          XMVectorNegativeMultiplySubtract(e1y, du2Scaled, XMVectorMultiply(e2y, du1Scaled)),
+                                          XMVectorNegativeMultiplySubtract(e1z, du2Scaled, XMVectorMultiply(e2z, du1Scaled)));
+            }
+        });
+
+        // Accumulate the triangles onto their vertices. This is done in triangle order on one thread, so that the result does not
+        // depend on how the primitive was split.
+        Float3Array tangents(vertexCount);
+        Float3Array bitangents(vertexCount);
+        for (size_t triangle = 0; triangle < triangleCount; triangle++)
+        {
+            for (size_t corner = 0; corner < TRIANGLE_VERTEX_COUNT; corner++)
+            {
+                const uint32_t vertexIndex = primitive.Indices[triangle * TRIANGLE_VERTEX_COUNT + corner];
+                tangents.X[vertexIndex] += triangleTangents.X[triangle];
+                tangents.Y[vertexIndex] += triangleTangents.Y[triangle];
+                tangents.Z[vertexIndex] += triangleTangents.Z[triangle];
+                bitangents.X[vertexIndex] += triangleBitangents.X[triangle];
+                bitangents.Y[vertexIndex] += triangleBitangents.Y[triangle];
+                bitangents.Z[vertexIndex] += triangleBitangents.Z[triangle];
+            }
+        }
+
+        // Orthogonalize the tangents against the normals and compute their handedness. Vertices without a usable tangent get an
+        // arbitrary one perpendicular to their normal.
+        ParallelFor(vertexCount, threadCount, [&](size_t begin, size_t end) {
+            for (size_t vertex = begin; vertex < end; vertex += SimdWidth)
+            {
+                const XMVECTOR nx = Load4(normals.X, vertex);
+                const XMVECTOR ny = Load4(normals.Y, vertex);
+                const XMVECTOR nz = Load4(normals.Z, vertex);
+                XMVECTOR tx = Load4(tangents.X, vertex);
+                XMVECTOR ty = Load4(tangents.Y, vertex);
+                XMVECTOR tz = Load4(tangents.Z, vertex);
+
+                // tangent -= normal * dot(normal, tangent)
+                const XMVECTOR dot = XMVectorMultiplyAdd(nx, tx, XMVectorMultiplyAdd(ny, ty, XMVectorMultiply(nz, tz)));
+                tx = XMVectorNegativeMultiplySubtract(nx, dot, tx);
+                ty = XMVectorNegativeMultiplySubtract(ny, dot, ty);
+                tz = XMVectorNegativeMultiplySubtract(nz, dot, tz);
+
+                // The fallback is cross(normal, X axis), or cross(normal, Y axis) when the normal is close to the X axis.
+                const XMVECTOR degenerate = XMVectorLess(
+                    XMVectorMultiplyAdd(tx, tx, XMVectorMultiplyAdd(ty, ty, XMVectorMultiply(tz, tz))), XMVectorReplicate(1e-12f));
+                const XMVECTOR useYAxis = XMVectorGreater(XMVectorAbs(nx), XMVectorReplicate(0.9f));
+                tx = XMVectorSelect(tx, XMVectorSelect(g_XMZero, XMVectorNegate(nz), useYAxis), degenerate);
+                ty = XMVectorSelect(ty, XMVectorSelect(nz, g_XMZero, useYAxis), degenerate);
+                tz = XMVectorSelect(tz, XMVectorSelect(XMVectorNegate(ny), nx, useYAxis), degenerate);
+
+                const XMVECTOR inverseLength = XMVectorReciprocalSqrt(
+                    XMVectorMultiplyAdd(tx, tx, XMVectorMultiplyAdd(ty, ty, XMVectorMultiply(tz, tz))));
+                tx = XMVectorMultiply(tx, inverseLength);
+                ty = XMVectorMultiply(ty, inverseLength);
+                tz = XMVectorMultiply(tz, inverseLength);
+
+                // The handedness is negative when cross(normal, tangent) points away from the accumulated bitangent.
+                const XMVECTOR cx = XMVectorNegativeMultiplySubtract(nz, ty, XMVectorMultiply(ny, tz));
+                const XMVECTOR cy = XMVectorNegativeMultiplySubtract(nx, tz, XMVectorMultiply(nz, tx));
+                const XMVECTOR cz = XMVectorNegativeMultiplySubtract(ny, tx, XMVectorMultiply(nx, ty));
+                const XMVECTOR bx = Load4(bitangents.X, vertex);
+                const XMVECTOR by = Load4(bitangents.Y, vertex);
+                const XMVECTOR bz = Load4(bitangents.Z, vertex);
+                const XMVECTOR handednessDot = XMVectorMultiplyAdd(cx, bx, XMVectorMultiplyAdd(cy, by, XMVectorMultiply(cz, bz)));
+                const XMVECTOR handedness = XMVectorSelect(g_XMOne, g_XMNegativeOne, XMVectorLess(handednessDot, g_XMZero));
+
+                XMFLOAT4A components[4];
+                XMStoreFloat4A(&components[0], tx);
+                XMStoreFloat4A(&components[1], ty);
+                XMStoreFloat4A(&components[2], tz);
+                XMStoreFloat4A(&components[3], handedness);
+                for (size_t lane = 0; lane < SimdWidth && vertex + lane < vertexCount; lane++)
+                {
+                    XMFLOAT4& tangent = primitive.Vertices[vertex + lane].Tangent;
+                    tangent.x = (&components[0].x)[lane];
+                    tangent.y = (&components[1].x)[lane];
+                    tangent.z = (&components[2].x)[lane];
+                    tangent.w = (&components[3].x)[lane];
+                }
+            }
+        });
+    }
+
+    void ComputeTriangleTangents(GltfHelper::Primitive& primitive, const GltfHelper::TangentOptions& options)
+    {
+        if (options.Mode == GltfHelper::TangentMode::Fast)
+        {
+            ComputeTriangleTangentsFast(primitive, options);
+        }
+        else
+        {
+            ComputeTriangleTangentsMikkTSpace(primitive);
+        }
+    }
+
     // Generates normals for the trianges in the GltfHelper Primitive object.
     void ComputeTriangleNormals(GltfHelper::Primitive& primitive)
     {
@@ -103,12 +367,126 @@ namespace
         }
     }
 
-    // Some data, like texCoords, can be represented 32bit float or normalized unsigned short or byte.
-    // ReadNormalizedFloat provides overloads for all three types.
-    template <typename T> float ReadNormalizedFloat(const uint8_t* ptr);
-    template<> float ReadNormalizedFloat<float>(const uint8_t* ptr) { return *reinterpret_cast<const float*>(ptr); }
-    template<> float ReadNormalizedFloat<uint16_t>(const uint8_t* ptr) { return *reinterpret_cast<const uint16_t*>(ptr) / (float)std::numeric_limits<uint16_t>::max(); }
-    template<> float ReadNormalizedFloat<uint8_t>(const uint8_t* ptr) { return *reinterpret_cast<const uint8_t*>(ptr) / (float)std::numeric_limits<uint8_t>::max(); }
+    // Some data, like texCoords, can be represented as 32bit floats or as (normalized) integers. LoadComponents converts the up to
+    // four components of an accessor element to floats with a single DirectXMath load, which uses SSE on x86/x64 and NEON on ARM.
+    // Signed normalized values follow the glTF rule max(c / MAX, -1).
+    template <typename TComponent, bool Normalized>
+    XMVECTOR XM_CALLCONV LoadComponents(const TComponent (&components)[4]);
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<float, false>(const float (&components)[4])
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<uint8_t, true>(const uint8_t (&components)[4])
+    {
+        return PackedVector::XMLoadUByteN4(reinterpret_cast<const PackedVector::XMUBYTEN4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<uint8_t, false>(const uint8_t (&components)[4])
+    {
+        return PackedVector::XMLoadUByte4(reinterpret_cast<const PackedVector::XMUBYTE4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<int8_t, true>(const int8_t (&components)[4])
+    {
+        return PackedVector::XMLoadByteN4(reinterpret_cast<const PackedVector::XMBYTEN4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<int8_t, false>(const int8_t (&components)[4])
+    {
+        return PackedVector::XMLoadByte4(reinterpret_cast<const PackedVector::XMBYTE4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<uint16_t, true>(const uint16_t (&components)[4])
+    {
+        return PackedVector::XMLoadUShortN4(reinterpret_cast<const PackedVector::XMUSHORTN4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<uint16_t, false>(const uint16_t (&components)[4])
+    {
+        return PackedVector::XMLoadUShort4(reinterpret_cast<const PackedVector::XMUSHORT4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<int16_t, true>(const int16_t (&components)[4])
+    {
+        return PackedVector::XMLoadShortN4(reinterpret_cast<const PackedVector::XMSHORTN4*>(components));
+    }
+
+    template <>
+    XMVECTOR XM_CALLCONV LoadComponents<int16_t, false>(const int16_t (&components)[4])
+    {
+        return PackedVector::XMLoadShort4(reinterpret_cast<const PackedVector::XMSHORT4*>(components));
+    }
+
+    // Source stride of ReadAccessorElements when the elements are interleaved, and so the stride is only known at run time.
+    constexpr size_t RuntimeStride = 0;
+
+    // Converts count accessor elements of ComponentCount components to floats, writing the floats of each element destinationStride
+    // bytes after those of the previous one (sizeof(Vertex) to write a vertex field). Every layout gets its own loop, in which the
+    // sizes of the copies are constants, so the compiler turns them into plain moves and keeps the element in registers. Tightly
+    // packed source elements have their stride as a template parameter too.
+    template <typename TComponent, bool Normalized, size_t ComponentCount, size_t SourceStride>
+    void ReadAccessorElements(const uint8_t* source, size_t sourceStride, size_t count, uint8_t* destination, size_t destinationStride)
+    {
+        static_assert(ComponentCount >= 1 && ComponentCount <= 4, "Accessor elements have up to four components.");
+        constexpr size_t ElementSize = sizeof(TComponent) * ComponentCount;
+        constexpr size_t DestinationSize = sizeof(float) * ComponentCount;
+        const size_t stride = SourceStride == RuntimeStride ? sourceStride : SourceStride;
+
+        if constexpr (std::is_same_v<TComponent, float> && SourceStride == ElementSize)
+        {
+            if (destinationStride == DestinationSize)
+            {
+                memcpy(destination, source, count * ElementSize); // Nothing to convert or interleave.
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < count; i++, source += stride, destination += destinationStride)
+        {
+            alignas(16) TComponent components[4]{};
+            memcpy(components, source, ElementSize);
+            XMFLOAT4A values;
+            XMStoreFloat4A(&values, LoadComponents<TComponent, Normalized>(components));
+            memcpy(destination, &values, DestinationSize);
+        }
+    }
+
+    // Reads the elements of an accessor into a field of the vertices of a primitive, which holds at least ComponentCount floats.
+    // The vertices are resized to the accessor's count, if necessary. If there are multiple attributes for a primitive, the first
+    // one will resize, and the subsequent will not need to.
+    template <typename TComponent, bool Normalized, size_t ComponentCount, typename TField>
+    void ReadAccessorToVertexField(
+        const uint8_t* source, size_t stride, size_t count, TField GltfHelper::Vertex::*field, GltfHelper::Primitive& primitive)
+    {
+        static_assert(sizeof(TField) >= sizeof(float) * ComponentCount, "The vertex field is too small for the accessor elements.");
+        primitive.Vertices.resize(count);
+        if (count == 0)
+        {
+            return;
+        }
+
+        uint8_t* destination = reinterpret_cast<uint8_t*>(&(primitive.Vertices[0].*field));
+        constexpr size_t PackedSize = sizeof(TComponent) * ComponentCount;
+        constexpr size_t VertexSize = sizeof(GltfHelper::Vertex);
+        if (stride == PackedSize)
+        {
+            ReadAccessorElements<TComponent, Normalized, ComponentCount, PackedSize>(source, stride, count, destination, VertexSize);
+        }
+        else
+        {
+            ReadAccessorElements<TComponent, Normalized, ComponentCount, RuntimeStride>(source, stride, count, destination, VertexSize);
+        }
+    }
 
     // Convert array of 16 doubles to an XMMATRIX.
     XMMATRIX XM_CALLCONV Double4x4ToXMMatrix(FXMMATRIX defaultMatrix, const std::vector<double>& doubleData)
@@ -151,7 +529,7 @@ namespace
 
     // Validate that an accessor does not go out of bounds of the buffer view that it references and that the buffer view does not exceed
     // the bounds of the buffer that it references.
-    void ValidateAccessor(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, size_t byteStride, size_t elementSize)
+    void ValidateAccessor(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, size_t byteStride, size_t elementSize)
     {
         // Make sure the accessor does not go out of range of the buffer view.
         if (accessor.byteOffset + (accessor.count - 1) * byteStride + elementSize > bufferView.byteLength)
@@ -160,20 +538,77 @@ namespace
         }
 
         // Make sure the buffer view does not go out of range of the buffer.
-        if (bufferView.byteOffset + bufferView.byteLength > buffer.data.size())
+        if (bufferView.byteOffset + bufferView.byteLength > buffer.Size)
         {
             throw std::out_of_range("BufferView goes out of range of buffer.");
         }
     }
 
+    template <typename TComponent, size_t ComponentCount, typename TField>
+    void ReadIntegerAccessorToVertexField(
+        bool normalized, const uint8_t* source, size_t stride, size_t count, TField GltfHelper::Vertex::*field, GltfHelper::Primitive& primitive)
+    {
+        if (normalized)
+        {
+            ReadAccessorToVertexField<TComponent, true, ComponentCount>(source, stride, count, field, primitive);
+        }
+        else
+        {
+            ReadAccessorToVertexField<TComponent, false, ComponentCount>(source, stride, count, field, primitive);
+        }
+    }
+
+    // Reads attribute data with 8 or 16-bit integer components, which KHR_mesh_quantization allows for positions, normals, tangents
+    // and texture coordinates, into a GltfHelper Primitive. The components are converted to floats as they are, or normalized.
+    template <size_t ComponentCount, typename TField>
+    void ReadIntegerToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, TField GltfHelper::Vertex::*field, GltfHelper::Primitive& primitive)
+    {
+        // If stride is not specified, it is tightly packed.
+        const size_t packedSize = (size_t)tinygltf::GetComponentSizeInBytes(accessor.componentType) * ComponentCount;
+        const size_t stride = bufferView.byteStride == 0 ? packedSize : bufferView.byteStride;
+        ValidateAccessor(accessor, bufferView, buffer, stride, packedSize);
+
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        switch (accessor.componentType)
+        {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            ReadIntegerAccessorToVertexField<int8_t, ComponentCount>(accessor.normalized, bufferPtr, stride, accessor.count, field, primitive);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            ReadIntegerAccessorToVertexField<uint8_t, ComponentCount>(accessor.normalized, bufferPtr, stride, accessor.count, field, primitive);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            ReadIntegerAccessorToVertexField<int16_t, ComponentCount>(accessor.normalized, bufferPtr, stride, accessor.count, field, primitive);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            ReadIntegerAccessorToVertexField<uint16_t, ComponentCount>(accessor.normalized, bufferPtr, stride, accessor.count, field, primitive);
+            break;
+        default:
+            throw std::exception("Accessor for primitive attribute has incorrect component type (8 or 16-bit integer expected).");
+        }
+    }
+
+    // KHR_mesh_quantization stores normals and tangents as normalized bytes or shorts.
+    bool IsSignedNormalized(const tinygltf::Accessor& accessor)
+    {
+        return accessor.normalized &&
+               (accessor.componentType == TINYGLTF_COMPONENT_TYPE_BYTE || accessor.componentType == TINYGLTF_COMPONENT_TYPE_SHORT);
+    }
+
     // Reads the tangent data (VEC4) from a glTF primitive into a GltfHelper Primitive.
-    void XM_CALLCONV ReadTangentToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void XM_CALLCONV ReadTangentToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, bool meshQuantization, GltfHelper::Primitive& primitive)
     {
         if (accessor.type != TINYGLTF_TYPE_VEC4)
         {
             throw std::exception("Accessor for primitive attribute has incorrect type (VEC4 expected).");
         }
 
+        if (meshQuantization && IsSignedNormalized(accessor))
+        {
+            ReadIntegerToVertexField<4>(accessor, bufferView, buffer, &GltfHelper::Vertex::Tangent, primitive);
+            return;
+        }
+
         if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
         {
             throw std::exception("Accessor for primitive attribute has incorrect component type (FLOAT expected).");
@@ -184,51 +619,43 @@ namespace
         const size_t stride = bufferView.byteStride == 0 ? PackedSize : bufferView.byteStride;
         ValidateAccessor(accessor, bufferView, buffer, stride, PackedSize);
 
-        // Resize the vertices vector, if necessary, to include room for the attribute data.
-        // If there are multiple attributes for a primitive, the first one will resize, and the subsequent will not need to.
-        primitive.Vertices.resize(accessor.count);
-
         // Copy the attribute value over from the glTF buffer into the appropriate vertex field.
-        const uint8_t* bufferPtr = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-        for (size_t i = 0; i < accessor.count; i++, bufferPtr += stride)
-        {
-            primitive.Vertices[i].Tangent = *reinterpret_cast<const XMFLOAT4*>(bufferPtr);
-        }
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        ReadAccessorToVertexField<float, false, 4>(bufferPtr, stride, accessor.count, &GltfHelper::Vertex::Tangent, primitive);
     }
 
     // Reads the TexCoord data (VEC2) from a glTF primitive into a GltfHelper Primitive.
     // This function uses a template type to express the VEC2 component type (byte, ushort, or float).
     template <typename TComponentType, XMFLOAT2 GltfHelper::Vertex::*field>
-    void ReadTexCoordToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void ReadTexCoordToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, GltfHelper::Primitive& primitive)
     {
         // If stride is not specified, it is tightly packed.
         constexpr size_t PackedSize = sizeof(TComponentType) * 2;
         const size_t stride = bufferView.byteStride == 0 ? PackedSize : bufferView.byteStride;
         ValidateAccessor(accessor, bufferView, buffer, stride, PackedSize);
 
-        // Resize the vertices vector, if necessary, to include room for the attribute data.
-        // If there are multiple attributes for a primitive, the first one will resize, and the subsequent will not need to.
-        primitive.Vertices.resize(accessor.count);
-
         // Copy the attribute value over from the glTF buffer into the appropriate vertex field.
-        const uint8_t* bufferPtr = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-        for (size_t i = 0; i < accessor.count; i++, bufferPtr += stride)
-        {
-            (primitive.Vertices[i].*field).x = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 0);
-            (primitive.Vertices[i].*field).y = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 1);
-        }
+        // Integer texcoords have to be normalized, which the caller validates.
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        constexpr bool Normalized = !std::is_same_v<TComponentType, float>;
+        ReadAccessorToVertexField<TComponentType, Normalized, 2>(bufferPtr, stride, accessor.count, field, primitive);
     }
 
     // Reads the TexCoord data (VEC2) from a glTF primitive into a GltfHelper Primitive.
     template <XMFLOAT2 GltfHelper::Vertex::*field>
-    void ReadTexCoordToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void ReadTexCoordToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, bool meshQuantization, GltfHelper::Primitive& primitive)
     {
         if (accessor.type != TINYGLTF_TYPE_VEC2)
         {
             throw std::exception("Accessor for primitive TexCoord must have VEC2 type.");
         }
 
-        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
+        if (meshQuantization && accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            // Quantized texture coordinates may be any 8 or 16-bit integers, normalized or not.
+            ReadIntegerToVertexField<2>(accessor, bufferView, buffer, field, primitive);
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
         {
             ReadTexCoordToVertexField<float, field>(accessor, bufferView, buffer, primitive);
         }
@@ -251,35 +678,30 @@ namespace
     // Reads the Color data (VEC3 or VEC4) from a glTF primitive into a GltfHelper Primitive.
     // This function uses a template type to express the VEC3/4 component type (byte, ushort, or float).
     template <typename TComponentType, XMFLOAT4 GltfHelper::Vertex::*field>
-    void ReadColorToVertexField(size_t componentCount, const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void ReadColorToVertexField(size_t componentCount, const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, GltfHelper::Primitive& primitive)
     {
         // If stride is not specified, it is tightly packed.
         const size_t packedSize = sizeof(TComponentType) * componentCount;
         const size_t stride = bufferView.byteStride == 0 ? packedSize : bufferView.byteStride;
         ValidateAccessor(accessor, bufferView, buffer, stride, packedSize);
 
-        // Resize the vertices vector, if necessary, to include room for the attribute data.
-        // If there are multiple attributes for a primitive, the first one will resize, and the subsequent will not need to.
-        primitive.Vertices.resize(accessor.count);
-
-        // Copy the attribute value over from the glTF buffer into the appropriate vertex field.
-        const uint8_t* bufferPtr = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-        for (size_t i = 0; i < accessor.count; i++, bufferPtr += stride)
+        // Copy the attribute value over from the glTF buffer into the appropriate vertex field. The alpha of VEC3 colors is left as is.
+        // Integer colors have to be normalized, which the caller validates.
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        constexpr bool Normalized = !std::is_same_v<TComponentType, float>;
+        if (componentCount == 4)
         {
-            (primitive.Vertices[i].*field).x = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 0);
-            (primitive.Vertices[i].*field).y = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 1);
-            (primitive.Vertices[i].*field).z = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 2);
-
-            if (componentCount == 4) // Alpha
-            {
-                (primitive.Vertices[i].*field).w = ReadNormalizedFloat<TComponentType>(bufferPtr + sizeof(TComponentType) * 3);
-            }
+            ReadAccessorToVertexField<TComponentType, Normalized, 4>(bufferPtr, stride, accessor.count, field, primitive);
+        }
+        else
+        {
+            ReadAccessorToVertexField<TComponentType, Normalized, 3>(bufferPtr, stride, accessor.count, field, primitive);
         }
     }
 
     // Reads the Color data (VEC3/4) from a glTF primitive into a GltfHelper Primitive.
     template <XMFLOAT4 GltfHelper::Vertex::*field>
-    void ReadColorToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void ReadColorToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, GltfHelper::Primitive& primitive)
     {
         int componentCount;
         if (accessor.type == TINYGLTF_TYPE_VEC3)
@@ -319,12 +741,18 @@ namespace
     template <XMFLOAT3 GltfHelper::Vertex::*field>
     void XM_CALLCONV ReadVec3ToVertexField(const tinygltf::Accessor& accessor,
                                            const tinygltf::BufferView& bufferView,
-                                           const tinygltf::Buffer& buffer,
+                                           const GltfHelper::BufferData& buffer,
+                                           bool meshQuantization,
                                            GltfHelper::Primitive& primitive) {
         if (accessor.type != TINYGLTF_TYPE_VEC3) {
             throw std::exception("Accessor for primitive attribute has incorrect type (VEC3 expected).");
         }
 
+        if (meshQuantization && IsSignedNormalized(accessor)) {
+            ReadIntegerToVertexField<3>(accessor, bufferView, buffer, field, primitive);
+            return;
+        }
+
         if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
             throw std::exception("Accessor for primitive attribute has incorrect component type (FLOAT expected).");
         }
@@ -334,20 +762,14 @@ namespace
         const size_t stride = bufferView.byteStride == 0 ? PackedSize : bufferView.byteStride;
         ValidateAccessor(accessor, bufferView, buffer, stride, PackedSize);
 
-        // Resize the vertices vector, if necessary, to include room for the attribute data.
-        // If there are multiple attributes for a primitive, the first one will resize, and the subsequent will not need to.
-        primitive.Vertices.resize(accessor.count);
-
         // Copy the attribute value over from the glTF buffer into the appropriate vertex field.
-        const uint8_t* bufferPtr = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-        for (size_t i = 0; i < accessor.count; i++, bufferPtr += stride) {
-            (primitive.Vertices[i].*field) = *reinterpret_cast<const XMFLOAT3*>(bufferPtr);
-        }
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        ReadAccessorToVertexField<float, false, 3>(bufferPtr, stride, accessor.count, field, primitive);
     }
 
     // Reads VEC4 attribute data (like POSITION and NORMAL) from a glTF primitive into a GltfHelper Primitive. The specific Vertex field is specified as a template parameter.
     template <XMFLOAT4 GltfHelper::Vertex::*field>
-    void XM_CALLCONV ReadVec4ToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void XM_CALLCONV ReadVec4ToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, GltfHelper::Primitive& primitive)
     {
         if (accessor.type != TINYGLTF_TYPE_VEC4)
         {
@@ -364,68 +786,541 @@ namespace
         const size_t stride = bufferView.byteStride == 0 ? PackedSize : bufferView.byteStride;
         ValidateAccessor(accessor, bufferView, buffer, stride, PackedSize);
 
-        // Resize the vertices vector, if necessary, to include room for the attribute data.
-        // If there are multiple attributes for a primitive, the first one will resize, and the subsequent will not need to.
-        primitive.Vertices.resize(accessor.count);
-
         // Copy the attribute value over from the glTF buffer into the appropriate vertex field.
-        const uint8_t* bufferPtr = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
-        for (size_t i = 0; i < accessor.count; i++, bufferPtr += stride)
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        ReadAccessorToVertexField<float, false, 4>(bufferPtr, stride, accessor.count, field, primitive);
+    }
+
+    // Reads the position data from a glTF primitive into a GltfHelper Primitive. glTF positions are VEC3, which get a w of 1, but
+    // VEC4 positions are accepted as well. Quantized positions are left for the transform of their node to dequantize.
+    void XM_CALLCONV ReadPositionToVertexField(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, bool meshQuantization, GltfHelper::Primitive& primitive)
+    {
+        if (accessor.type == TINYGLTF_TYPE_VEC4)
         {
-            (primitive.Vertices[i].*field) = *reinterpret_cast<const XMFLOAT4*>(bufferPtr);
+            ReadVec4ToVertexField<&GltfHelper::Vertex::Position>(accessor, bufferView, buffer, primitive);
+            return;
+        }
+
+        if (accessor.type != TINYGLTF_TYPE_VEC3)
+        {
+            throw std::exception("Accessor for primitive POSITION must have VEC3 or VEC4 type.");
+        }
+
+        if (meshQuantization && accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            ReadIntegerToVertexField<3>(accessor, bufferView, buffer, &GltfHelper::Vertex::Position, primitive);
+        }
+        else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            constexpr size_t PackedSize = sizeof(XMFLOAT3);
+            const size_t stride = bufferView.byteStride == 0 ? PackedSize : bufferView.byteStride;
+            ValidateAccessor(accessor, bufferView, buffer, stride, PackedSize);
+
+            const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+            ReadAccessorToVertexField<float, false, 3>(bufferPtr, stride, accessor.count, &GltfHelper::Vertex::Position, primitive);
+        }
+        else
+        {
+            throw std::exception("Accessor for primitive attribute has incorrect component type (FLOAT expected).");
+        }
+
+        for (GltfHelper::Vertex& vertex : primitive.Vertices)
+        {
+            vertex.Position.w = 1;
         }
     }
 
-    // Load a primitive's (vertex) attributes. Vertex attributes can be positions, normals, tangents, texture coordinates, colors, and more.
-    void XM_CALLCONV LoadAttributeAccessor(const tinygltf::Model& gltfModel, const std::string& attributeName, int accessorId, GltfHelper::Primitive& primitive)
+    // Reads the KHR_texture_transform extension of a texture as the matrix it applies to texture coordinates, which scales them,
+    // then rotates them and then offsets them. Returns false if the texture has none.
+    bool ReadTextureTransform(int textureIndex, const tinygltf::ExtensionMap& extensions, XMMATRIX& transform)
     {
-        const auto& accessor = gltfModel.accessors.at(accessorId);
-
-        if (accessor.bufferView == -1)
+        const auto extension = extensions.find("KHR_texture_transform");
+        if (textureIndex == -1 || extension == extensions.end())
         {
-            throw std::exception("Accessor for primitive attribute specifies no bufferview.");
+            return false;
         }
 
-        // WARNING: This version of the tinygltf loader does not support sparse accessors, so neither does this renderer.
+        const tinygltf::Value& value = extension->second;
+        const auto readVector = [&value](const char* name, XMFLOAT2 defaultVector) {
+            if (value.Has(name) && value.Get(name).ArrayLen() == 2)
+            {
+                const tinygltf::Value& vector = value.Get(name);
+                return XMFLOAT2((float)vector.Get(0).GetNumberAsDouble(), (float)vector.Get(1).GetNumberAsDouble());
+            }
+            return defaultVector;
+        };
+        const XMFLOAT2 offset = readVector("offset", {0, 0});
+        const XMFLOAT2 scale = readVector("scale", {1, 1});
+        const float rotation = value.Has("rotation") ? (float)value.Get("rotation").GetNumberAsDouble() : 0.0f;
+
+        const float cosine = std::cos(rotation);
+        const float sine = std::sin(rotation);
+        transform = XMMATRIX(cosine * scale.x, -sine * scale.x, 0, 0,
+                             sine * scale.y, cosine * scale.y, 0, 0,
+                             0, 0, 1, 0,
+                             offset.x, offset.y, 0, 1);
+        return true;
+    }
+
+    // The PBR shaders sample all textures of a material with the same texture coordinates, so the first texture transform found
+    // is taken for all of them. Quantized texture coordinates share theirs.
+    bool ReadMaterialTextureTransform(const tinygltf::Material& gltfMaterial, XMMATRIX& transform)
+    {
+        const tinygltf::PbrMetallicRoughness& pbr = gltfMaterial.pbrMetallicRoughness;
+        return ReadTextureTransform(pbr.baseColorTexture.index, pbr.baseColorTexture.extensions, transform) ||
+               ReadTextureTransform(pbr.metallicRoughnessTexture.index, pbr.metallicRoughnessTexture.extensions, transform) ||
+               ReadTextureTransform(gltfMaterial.normalTexture.index, gltfMaterial.normalTexture.extensions, transform) ||
+               ReadTextureTransform(gltfMaterial.occlusionTexture.index, gltfMaterial.occlusionTexture.extensions, transform) ||
+               ReadTextureTransform(gltfMaterial.emissiveTexture.index, gltfMaterial.emissiveTexture.extensions, transform);
+    }
 
-        const tinygltf::BufferView& bufferView = gltfModel.bufferViews.at(accessor.bufferView);
-        if (bufferView.target != TINYGLTF_TARGET_ARRAY_BUFFER && bufferView.target != 0)  // Allow 0 (not specified) even though spec doesn't seem to allow this (BoomBox GLB fails)
+    // Resolves the buffer view an accessor reads, and the data of its buffer. A view compressed with EXT_meshopt_compression which
+    // was decoded is read from its decoded contents instead, through a copy of the view starting at their beginning.
+    const tinygltf::BufferView& ReadAccessorBufferView(const tinygltf::Model& gltfModel,
+                                                       const GltfHelper::BufferData& binaryChunk,
+                                                       const GltfHelper::DecodedBufferViews& decodedBufferViews,
+                                                       int bufferViewIndex,
+                                                       tinygltf::BufferView& decodedView,
+                                                       GltfHelper::BufferData& buffer)
+    {
+        const tinygltf::BufferView& bufferView = gltfModel.bufferViews.at(bufferViewIndex);
+        const auto decoded = decodedBufferViews.find(bufferViewIndex);
+        if (decoded == decodedBufferViews.end())
         {
-            throw std::exception("Accessor for primitive attribute uses bufferview with invalid 'target' type.");
+            buffer = GltfHelper::ReadBuffer(gltfModel, bufferView.buffer, binaryChunk);
+            return bufferView;
         }
 
-        const tinygltf::Buffer& buffer = gltfModel.buffers.at(bufferView.buffer);
+        decodedView.buffer = bufferView.buffer;
+        decodedView.byteLength = decoded->second.size();
+        decodedView.byteStride = bufferView.byteStride;
+        decodedView.target = bufferView.target;
+        buffer = {decoded->second.data(), decoded->second.size()};
+        return decodedView;
+    }
 
+    // Reads the elements of an attribute accessor into the vertex field of the attribute. Returns false, reading nothing, for
+    // attributes which are not supported.
+    bool ReadAttributeToVertexField(const std::string& attributeName,
+                                    const tinygltf::Accessor& accessor,
+                                    const tinygltf::BufferView& bufferView,
+                                    const GltfHelper::BufferData& buffer,
+                                    bool meshQuantization,
+                                    GltfHelper::Primitive& primitive)
+    {
         if (attributeName.compare("POSITION") == 0)
         {
-            ReadVec4ToVertexField<&GltfHelper::Vertex::Position>(accessor, bufferView, buffer, primitive);
+            ReadPositionToVertexField(accessor, bufferView, buffer, meshQuantization, primitive);
         }
         else if (attributeName.compare("NORMAL") == 0)
         {
-            ReadVec3ToVertexField<&GltfHelper::Vertex::Normal>(accessor, bufferView, buffer, primitive);
+            ReadVec3ToVertexField<&GltfHelper::Vertex::Normal>(accessor, bufferView, buffer, meshQuantization, primitive);
         }
         else if (attributeName.compare("TANGENT") == 0)
         {
-            ReadTangentToVertexField(accessor, bufferView, buffer, primitive);
+            ReadTangentToVertexField(accessor, bufferView, buffer, meshQuantization, primitive);
         }
         else if (attributeName.compare("TEXCOORD_0") == 0)
         {
-            ReadTexCoordToVertexField<&GltfHelper::Vertex::TexCoord0>(accessor, bufferView, buffer, primitive);
+            ReadTexCoordToVertexField<&GltfHelper::Vertex::TexCoord0>(accessor, bufferView, buffer, meshQuantization, primitive);
         }
         else if (attributeName.compare("COLOR_0") == 0)
         {
             ReadColorToVertexField<&GltfHelper::Vertex::Color0>(accessor, bufferView, buffer, primitive);
         }
         else
+        {
+            return false;
+        }
+
+        return true;
+    }
+
+    // Byte range of the vertex field an attribute is read into.
+    struct VertexField
+    {
+        size_t Offset;
+        size_t Size;
+    };
+
+    VertexField GetAttributeVertexField(const std::string& attributeName)
+    {
+        if (attributeName.compare("POSITION") == 0)
+        {
+            return {offsetof(GltfHelper::Vertex, Position), sizeof(GltfHelper::Vertex::Position)};
+        }
+        else if (attributeName.compare("NORMAL") == 0)
+        {
+            return {offsetof(GltfHelper::Vertex, Normal), sizeof(GltfHelper::Vertex::Normal)};
+        }
+        else if (attributeName.compare("TANGENT") == 0)
+        {
+            return {offsetof(GltfHelper::Vertex, Tangent), sizeof(GltfHelper::Vertex::Tangent)};
+        }
+        else if (attributeName.compare("TEXCOORD_0") == 0)
+        {
+            return {offsetof(GltfHelper::Vertex, TexCoord0), sizeof(GltfHelper::Vertex::TexCoord0)};
+        }
+        else
+        {
+            return {offsetof(GltfHelper::Vertex, Color0), sizeof(GltfHelper::Vertex::Color0)};
+        }
+    }
+
+    template <typename TIndex>
+    void ReadSparseIndices(const uint8_t* source, size_t count, std::vector<uint32_t>& indices)
+    {
+        indices.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            TIndex index;
+            memcpy(&index, source + i * sizeof(TIndex), sizeof(TIndex));
+            indices[i] = index;
+        }
+    }
+
+    // Reads the indices of the elements a sparse accessor substitutes, which are strictly increasing and within the accessor.
+    std::vector<uint32_t> ReadSparseIndices(const tinygltf::Model& gltfModel,
+                                            const GltfHelper::BufferData& binaryChunk,
+                                            const GltfHelper::DecodedBufferViews& decodedBufferViews,
+                                            const tinygltf::Accessor& accessor)
+    {
+        if (accessor.sparse.count <= 0 || accessor.sparse.indices.bufferView == -1 || accessor.sparse.values.bufferView == -1)
+        {
+            throw std::exception("Sparse accessor specifies an invalid count or no bufferview.");
+        }
+
+        tinygltf::BufferView decodedView;
+        GltfHelper::BufferData buffer;
+        const tinygltf::BufferView& bufferView =
+            ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, accessor.sparse.indices.bufferView, decodedView, buffer);
+
+        // The indices are tightly packed, so they are validated as an accessor of their own.
+        tinygltf::Accessor indicesAccessor;
+        indicesAccessor.byteOffset = accessor.sparse.indices.byteOffset;
+        indicesAccessor.count = accessor.sparse.count;
+        const int indexSize = tinygltf::GetComponentSizeInBytes(accessor.sparse.indices.componentType);
+        if (indexSize <= 0)
+        {
+            throw std::exception("Sparse accessor indices use unsupported component type.");
+        }
+        ValidateAccessor(indicesAccessor, bufferView, buffer, indexSize, indexSize);
+
+        std::vector<uint32_t> indices;
+        const uint8_t* indexData = buffer.Data + bufferView.byteOffset + indicesAccessor.byteOffset;
+        switch (accessor.sparse.indices.componentType)
+        {
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            ReadSparseIndices<uint8_t>(indexData, indicesAccessor.count, indices);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            ReadSparseIndices<uint16_t>(indexData, indicesAccessor.count, indices);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+            ReadSparseIndices<uint32_t>(indexData, indicesAccessor.count, indices);
+            break;
+        default:
+            throw std::exception("Sparse accessor indices use unsupported component type.");
+        }
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            if (indices[i] >= accessor.count || (i > 0 && indices[i] <= indices[i - 1]))
+            {
+                throw std::exception("Sparse accessor indices are out of range or not strictly increasing.");
+            }
+        }
+
+        return indices;
+    }
+
+    // An accessor for the values of a sparse accessor, which are tightly packed elements of the type of the sparse accessor.
+    tinygltf::Accessor GetSparseValuesAccessor(const tinygltf::Accessor& accessor)
+    {
+        tinygltf::Accessor valuesAccessor;
+        valuesAccessor.bufferView = accessor.sparse.values.bufferView;
+        valuesAccessor.byteOffset = accessor.sparse.values.byteOffset;
+        valuesAccessor.normalized = accessor.normalized;
+        valuesAccessor.componentType = accessor.componentType;
+        valuesAccessor.count = accessor.sparse.count;
+        valuesAccessor.type = accessor.type;
+        return valuesAccessor;
+    }
+
+    // Substitutes the elements of a sparse attribute accessor in the vertices it was read into. The values are read into vertices
+    // of their own, whose attribute field is then copied over that of the vertices they replace.
+    void ApplySparseAttribute(const tinygltf::Model& gltfModel,
+                              const GltfHelper::BufferData& binaryChunk,
+                              const GltfHelper::DecodedBufferViews& decodedBufferViews,
+                              const std::string& attributeName,
+                              const tinygltf::Accessor& accessor,
+                              bool meshQuantization,
+                              GltfHelper::Primitive& primitive)
+    {
+        const std::vector<uint32_t> indices = ReadSparseIndices(gltfModel, binaryChunk, decodedBufferViews, accessor);
+
+        const tinygltf::Accessor valuesAccessor = GetSparseValuesAccessor(accessor);
+        tinygltf::BufferView decodedView;
+        GltfHelper::BufferData buffer;
+        const tinygltf::BufferView& bufferView =
+            ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, valuesAccessor.bufferView, decodedView, buffer);
+
+        GltfHelper::Primitive values;
+        ReadAttributeToVertexField(attributeName, valuesAccessor, bufferView, buffer, meshQuantization, values);
+
+        const VertexField field = GetAttributeVertexField(attributeName);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            memcpy(reinterpret_cast<uint8_t*>(&primitive.Vertices[indices[i]]) + field.Offset,
+                   reinterpret_cast<const uint8_t*>(&values.Vertices[i]) + field.Offset,
+                   field.Size);
+        }
+    }
+
+    // Load a primitive's (vertex) attributes. Vertex attributes can be positions, normals, tangents, texture coordinates, colors, and more.
+    void XM_CALLCONV LoadAttributeAccessor(const tinygltf::Model& gltfModel, const GltfHelper::BufferData& binaryChunk, const GltfHelper::DecodedBufferViews& decodedBufferViews, const std::string& attributeName, int accessorId, bool meshQuantization, GltfHelper::Primitive& primitive)
+    {
+        const auto& accessor = gltfModel.accessors.at(accessorId);
+
+        tinygltf::BufferView decodedView;
+        GltfHelper::BufferData buffer;
+        std::vector<uint8_t> zeros;
+        const tinygltf::BufferView* bufferView = &decodedView;
+        if (accessor.bufferView == -1)
+        {
+            // A sparse accessor without a bufferview substitutes elements of zeros, which are read like tightly packed ones.
+            if (!accessor.sparse.isSparse)
+            {
+                throw std::exception("Accessor for primitive attribute specifies no bufferview.");
+            }
+
+            const int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+            const int componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+            if (componentSize <= 0 || componentCount <= 0)
+            {
+                throw std::exception("Accessor for primitive attribute specifies invalid 'type' or 'componentType'.");
+            }
+
+            zeros.resize(accessor.count * componentSize * componentCount);
+            decodedView.byteLength = zeros.size();
+            buffer = {zeros.data(), zeros.size()};
+        }
+        else
+        {
+            bufferView = &ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, accessor.bufferView, decodedView, buffer);
+            if (bufferView->target != TINYGLTF_TARGET_ARRAY_BUFFER && bufferView->target != 0)  // Allow 0 (not specified) even though spec doesn't seem to allow this (BoomBox GLB fails)
+            {
+                throw std::exception("Accessor for primitive attribute uses bufferview with invalid 'target' type.");
+            }
+        }
+
+        if (!ReadAttributeToVertexField(attributeName, accessor, *bufferView, buffer, meshQuantization, primitive))
         {
             return; // Ignore unsupported vertex accessors like TEXCOORD_1.
         }
+
+        if (accessor.sparse.isSparse)
+        {
+            ApplySparseAttribute(gltfModel, binaryChunk, decodedBufferViews, attributeName, accessor, meshQuantization, primitive);
+        }
+    }
+
+    template <typename TComponent>
+    void ReadVec3Elements(bool normalized, const uint8_t* source, size_t stride, size_t count, std::vector<XMFLOAT3>& elements)
+    {
+        // Tightly packed elements have their stride as a template parameter, so that packed float elements are copied at once.
+        uint8_t* const destination = reinterpret_cast<uint8_t*>(elements.data());
+        constexpr size_t PackedSize = sizeof(TComponent) * 3;
+        if (stride == PackedSize)
+        {
+            if (normalized)
+            {
+                ReadAccessorElements<TComponent, true, 3, PackedSize>(source, stride, count, destination, sizeof(XMFLOAT3));
+            }
+            else
+            {
+                ReadAccessorElements<TComponent, false, 3, PackedSize>(source, stride, count, destination, sizeof(XMFLOAT3));
+            }
+        }
+        else if (normalized)
+        {
+            ReadAccessorElements<TComponent, true, 3, RuntimeStride>(source, stride, count, destination, sizeof(XMFLOAT3));
+        }
+        else
+        {
+            ReadAccessorElements<TComponent, false, 3, RuntimeStride>(source, stride, count, destination, sizeof(XMFLOAT3));
+        }
+    }
+
+    // Reads the VEC3 elements of an accessor, such as the deltas of a morph target, as floats. Deltas quantized with
+    // KHR_mesh_quantization are 8 or 16-bit integers, normalized or not.
+    std::vector<XMFLOAT3> ReadVec3Elements(const tinygltf::Accessor& accessor,
+                                           const tinygltf::BufferView& bufferView,
+                                           const GltfHelper::BufferData& buffer)
+    {
+        if (accessor.type != TINYGLTF_TYPE_VEC3)
+        {
+            throw std::exception("Accessor for morph target attribute has incorrect type (VEC3 expected).");
+        }
+
+        const int componentSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+        if (componentSize <= 0 || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT ||
+            accessor.componentType == TINYGLTF_COMPONENT_TYPE_INT || accessor.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE)
+        {
+            throw std::exception("Accessor for morph target attribute uses unsupported component type.");
+        }
+
+        // If stride is not specified, it is tightly packed.
+        const size_t packedSize = (size_t)componentSize * 3;
+        const size_t stride = bufferView.byteStride == 0 ? packedSize : bufferView.byteStride;
+        ValidateAccessor(accessor, bufferView, buffer, stride, packedSize);
+
+        std::vector<XMFLOAT3> elements(accessor.count);
+        const uint8_t* bufferPtr = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        switch (accessor.componentType)
+        {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+            ReadVec3Elements<float>(false, bufferPtr, stride, accessor.count, elements);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            ReadVec3Elements<int8_t>(accessor.normalized, bufferPtr, stride, accessor.count, elements);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            ReadVec3Elements<uint8_t>(accessor.normalized, bufferPtr, stride, accessor.count, elements);
+            break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            ReadVec3Elements<int16_t>(accessor.normalized, bufferPtr, stride, accessor.count, elements);
+            break;
+        default:
+            ReadVec3Elements<uint16_t>(accessor.normalized, bufferPtr, stride, accessor.count, elements);
+            break;
+        }
+
+        return elements;
+    }
+
+    // Reads the deltas a morph target accessor gives the vertices, keeping those of the vertices it moves. Sparse accessors without
+    // a bufferview, which is how sparse morph targets are usually stored, are read as the lists of indices and deltas they hold,
+    // without expanding them to every vertex. Other accessors are read in full and reduced to their nonzero deltas.
+    void ReadMorphTargetDeltas(const tinygltf::Model& gltfModel,
+                               const GltfHelper::BufferData& binaryChunk,
+                               const GltfHelper::DecodedBufferViews& decodedBufferViews,
+                               const tinygltf::Accessor& accessor,
+                               size_t vertexCount,
+                               std::vector<uint32_t>& vertices,
+                               std::vector<XMFLOAT3>& deltas)
+    {
+        if (accessor.count != vertexCount)
+        {
+            throw std::exception("Accessor for morph target attribute does not have an element per vertex.");
+        }
+
+        vertices.clear();
+        deltas.clear();
+        if (accessor.bufferView == -1 && !accessor.sparse.isSparse)
+        {
+            return; // All deltas are zero.
+        }
+
+        std::vector<uint32_t> sparseIndices;
+        std::vector<XMFLOAT3> sparseDeltas;
+        if (accessor.sparse.isSparse)
+        {
+            sparseIndices = ReadSparseIndices(gltfModel, binaryChunk, decodedBufferViews, accessor);
+
+            const tinygltf::Accessor valuesAccessor = GetSparseValuesAccessor(accessor);
+            tinygltf::BufferView decodedView;
+            GltfHelper::BufferData buffer;
+            const tinygltf::BufferView& bufferView =
+                ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, valuesAccessor.bufferView, decodedView, buffer);
+            sparseDeltas = ReadVec3Elements(valuesAccessor, bufferView, buffer);
+
+            if (accessor.bufferView == -1)
+            {
+                vertices = std::move(sparseIndices);
+                deltas = std::move(sparseDeltas);
+                return;
+            }
+        }
+
+        tinygltf::BufferView decodedView;
+        GltfHelper::BufferData buffer;
+        const tinygltf::BufferView& bufferView =
+            ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, accessor.bufferView, decodedView, buffer);
+        std::vector<XMFLOAT3> denseDeltas = ReadVec3Elements(accessor, bufferView, buffer);
+        for (size_t i = 0; i < sparseIndices.size(); i++)
+        {
+            denseDeltas[sparseIndices[i]] = sparseDeltas[i];
+        }
+
+        for (size_t i = 0; i < denseDeltas.size(); i++)
+        {
+            if (!XMVector3Equal(XMLoadFloat3(&denseDeltas[i]), g_XMZero))
+            {
+                vertices.push_back((uint32_t)i);
+                deltas.push_back(denseDeltas[i]);
+            }
+        }
+    }
+
+    // Reads the POSITION, NORMAL and TANGENT deltas of a morph target. The target moves the union of the vertices each of them
+    // moves, and the deltas of each attribute are spread over that union, with zeros for the vertices the attribute leaves as is.
+    GltfHelper::MorphTarget ReadMorphTarget(const tinygltf::Model& gltfModel,
+                                            const GltfHelper::BufferData& binaryChunk,
+                                            const GltfHelper::DecodedBufferViews& decodedBufferViews,
+                                            const std::map<std::string, int>& gltfTarget,
+                                            size_t vertexCount)
+    {
+        GltfHelper::MorphTarget target;
+        std::vector<XMFLOAT3>* const targetDeltas[] = {&target.PositionDeltas, &target.NormalDeltas, &target.TangentDeltas};
+        const char* const attributeNames[] = {"POSITION", "NORMAL", "TANGENT"};
+
+        std::vector<uint32_t> attributeVertices[std::size(attributeNames)];
+        std::vector<XMFLOAT3> attributeDeltas[std::size(attributeNames)];
+        for (size_t i = 0; i < std::size(attributeNames); i++)
+        {
+            const auto attribute = gltfTarget.find(attributeNames[i]);
+            if (attribute != gltfTarget.end())
+            {
+                ReadMorphTargetDeltas(gltfModel,
+                                      binaryChunk,
+                                      decodedBufferViews,
+                                      gltfModel.accessors.at(attribute->second),
+                                      vertexCount,
+                                      attributeVertices[i],
+                                      attributeDeltas[i]);
+                target.Vertices.insert(target.Vertices.end(), attributeVertices[i].begin(), attributeVertices[i].end());
+            }
+        }
+
+        std::sort(target.Vertices.begin(), target.Vertices.end());
+        target.Vertices.erase(std::unique(target.Vertices.begin(), target.Vertices.end()), target.Vertices.end());
+
+        for (size_t i = 0; i < std::size(attributeNames); i++)
+        {
+            if (attributeVertices[i].empty())
+            {
+                continue;
+            }
+
+            // Both vertex lists are sorted, so each vertex of the attribute is found past the previous one.
+            std::vector<XMFLOAT3>& deltas = *targetDeltas[i];
+            deltas.resize(target.Vertices.size(), XMFLOAT3(0, 0, 0));
+            auto position = target.Vertices.begin();
+            for (size_t j = 0; j < attributeVertices[i].size(); j++)
+            {
+                position = std::lower_bound(position, target.Vertices.end(), attributeVertices[i][j]);
+                deltas[position - target.Vertices.begin()] = attributeDeltas[i][j];
+            }
+        }
+
+        return target;
     }
 
     // Reads index data from a glTF primitive into a GltfHelper Primitive. glTF indices may be 8bit, 16bit or 32bit integers.
     // This will coalesce indices from the source type(s) into a 32bit integer.
     template <typename TSrcIndex>
-    void ReadIndices(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const tinygltf::Buffer& buffer, GltfHelper::Primitive& primitive)
+    void ReadIndices(const tinygltf::Accessor& accessor, const tinygltf::BufferView& bufferView, const GltfHelper::BufferData& buffer, GltfHelper::Primitive& primitive)
     {
         if (bufferView.target != TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER && bufferView.target != 0) // Allow 0 (not specified) even though spec doesn't seem to allow this (BoomBox GLB fails)
         {
@@ -445,15 +1340,26 @@ namespace
             throw std::exception("Unexpected number of indices for triangle primitive");
         }
 
-        const TSrcIndex* indexBuffer = reinterpret_cast<const TSrcIndex*>(buffer.data.data() + bufferView.byteOffset + accessor.byteOffset);
-        for (uint32_t i = 0; i < accessor.count; i++)
+        const uint8_t* indexData = buffer.Data + bufferView.byteOffset + accessor.byteOffset;
+        primitive.Indices.resize(accessor.count);
+        if constexpr (std::is_same_v<TSrcIndex, uint32_t>)
         {
-            primitive.Indices.push_back(*(indexBuffer + i));
+            memcpy(primitive.Indices.data(), indexData, accessor.count * sizeof(uint32_t));
+        }
+        else
+        {
+            // A plain widening loop, which the compiler vectorizes.
+            const TSrcIndex* indexBuffer = reinterpret_cast<const TSrcIndex*>(indexData);
+            uint32_t* indices = primitive.Indices.data();
+            for (size_t i = 0; i < accessor.count; i++)
+            {
+                indices[i] = indexBuffer[i];
+            }
         }
     }
 
     // Reads index data from a glTF primitive into a GltfHelper Primitive.
-    void LoadIndexAccessor(const tinygltf::Model& gltfModel, const tinygltf::Accessor& accessor, GltfHelper::Primitive& primitive)
+    void LoadIndexAccessor(const tinygltf::Model& gltfModel, const GltfHelper::BufferData& binaryChunk, const GltfHelper::DecodedBufferViews& decodedBufferViews, const tinygltf::Accessor& accessor, GltfHelper::Primitive& primitive)
     {
         if (accessor.type != TINYGLTF_TYPE_SCALAR)
         {
@@ -465,8 +1371,10 @@ namespace
             throw std::exception("Index accessor without bufferView is currently not supported.");
         }
 
-        const tinygltf::BufferView& bufferView = gltfModel.bufferViews.at(accessor.bufferView);
-        const tinygltf::Buffer& buffer = gltfModel.buffers.at(bufferView.buffer);
+        tinygltf::BufferView decodedView;
+        GltfHelper::BufferData buffer;
+        const tinygltf::BufferView& bufferView =
+            ReadAccessorBufferView(gltfModel, binaryChunk, decodedBufferViews, accessor.bufferView, decodedView, buffer);
 
         if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
         {
@@ -509,7 +1417,29 @@ namespace GltfHelper
         }
     }
 
-    Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive)
+    bool UsesExtension(const tinygltf::Model& gltfModel, std::string_view extension)
+    {
+        return std::find(gltfModel.extensionsUsed.begin(), gltfModel.extensionsUsed.end(), extension) != gltfModel.extensionsUsed.end();
+    }
+
+    BufferData ReadBuffer(const tinygltf::Model& gltfModel, int bufferIndex, const BufferData& binaryChunk)
+    {
+        const tinygltf::Buffer& buffer = gltfModel.buffers.at(bufferIndex);
+
+        // Only the first buffer of a GLB file may be backed by the binary chunk, in which case it has no uri.
+        if (bufferIndex == 0 && buffer.uri.empty() && buffer.data.empty() && binaryChunk.Data != nullptr)
+        {
+            return binaryChunk;
+        }
+
+        return {buffer.data.data(), buffer.data.size()};
+    }
+
+    Primitive ReadPrimitive(const tinygltf::Model& gltfModel,
+                            const tinygltf::Primitive& gltfPrimitive,
+                            const BufferData& binaryChunk,
+                            const TangentOptions& tangentOptions,
+                            const DecodedBufferViews& decodedBufferViews)
     {
         if (gltfPrimitive.mode != TINYGLTF_MODE_TRIANGLES)
         {
@@ -519,15 +1449,39 @@ namespace GltfHelper
         Primitive primitive;
 
         // glTF vertex data is stored in an attribute dictionary. Loop through each attribute and insert it into the GltfHelper primitive.
+        const bool meshQuantization = UsesExtension(gltfModel, "KHR_mesh_quantization");
         for (const auto& attribute : gltfPrimitive.attributes)
         {
-            LoadAttributeAccessor(gltfModel, attribute.first /* attribute name */, attribute.second /* accessor index */, primitive);
+            LoadAttributeAccessor(gltfModel, binaryChunk, decodedBufferViews, attribute.first /* attribute name */, attribute.second /* accessor index */, meshQuantization, primitive);
+        }
+
+        // Morph targets hold the deltas of the vertices they move, by vertex index.
+        primitive.Targets.reserve(gltfPrimitive.targets.size());
+        for (const auto& gltfTarget : gltfPrimitive.targets)
+        {
+            primitive.Targets.push_back(ReadMorphTarget(gltfModel, binaryChunk, decodedBufferViews, gltfTarget, primitive.Vertices.size()));
+        }
+
+        // Quantized texture coordinates are dequantized by the texture transform of the material, which the PBR shaders do not apply.
+        // It is applied before tangents are generated, since they follow the texture coordinates.
+        const auto texCoord = gltfPrimitive.attributes.find("TEXCOORD_0");
+        if (meshQuantization && gltfPrimitive.material != -1 && texCoord != std::end(gltfPrimitive.attributes) &&
+            gltfModel.accessors.at(texCoord->second).componentType != TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            XMMATRIX textureTransform;
+            if (ReadMaterialTextureTransform(gltfModel.materials.at(gltfPrimitive.material), textureTransform))
+            {
+                for (Vertex& vertex : primitive.Vertices)
+                {
+                    XMStoreFloat2(&vertex.TexCoord0, XMVector2Transform(XMLoadFloat2(&vertex.TexCoord0), textureTransform));
+                }
+            }
         }
 
         if (gltfPrimitive.indices != -1)
         {
             // If indices are specified for the glTF primitive, read them into the GltfHelper Primitive.
-            LoadIndexAccessor(gltfModel, gltfModel.accessors.at(gltfPrimitive.indices), primitive);
+            LoadIndexAccessor(gltfModel, binaryChunk, decodedBufferViews, gltfModel.accessors.at(gltfPrimitive.indices), primitive);
         }
         else
         {
@@ -555,7 +1509,7 @@ namespace GltfHelper
         // If tangents are missing, compute tangents.
         if (gltfPrimitive.attributes.find("TANGENT") == std::end(gltfPrimitive.attributes))
         {
-            ComputeTriangleTangents(primitive);
+            ComputeTriangleTangents(primitive, tangentOptions);
         }
 
         // If colors are missing, set to default.
@@ -570,114 +1524,164 @@ namespace GltfHelper
         return primitive;
     }
 
-    Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial)
+    void XM_CALLCONV TransformPrimitive(Primitive& primitive, FXMMATRIX transform)
     {
-        // Read an optional VEC4 parameter if available, otherwise use the default.
-        auto readParameterFactorAsVec4 = [](const tinygltf::ParameterMap& parameters, std::string_view name, const XMFLOAT4& defaultValue) {
-            auto c = parameters.find(name.data());
-            return (c != parameters.end() && c->second.number_array.size() == 4) ?
-                XMFLOAT4((float)c->second.number_array[0], (float)c->second.number_array[1], (float)c->second.number_array[2], (float)c->second.number_array[3]) :
-                defaultValue;
-        };
+        // Normals are transformed by the inverse transpose, which keeps them perpendicular to the surface under non-uniform scales.
+        XMVECTOR determinant;
+        const XMMATRIX normalTransform = XMMatrixTranspose(XMMatrixInverse(&determinant, transform));
+        const bool mirrored = XMVectorGetX(determinant) < 0;
 
-        // Read an optional VEC3 parameter if available, otherwise use the default.
-        auto readParameterFactorAsVec3 = [](const tinygltf::ParameterMap& parameters, std::string_view name, const XMFLOAT3& defaultValue) {
-            auto c = parameters.find(name.data());
-            return (c != parameters.end() && c->second.number_array.size() == 3) ?
-                XMFLOAT3((float)c->second.number_array[0], (float)c->second.number_array[1], (float)c->second.number_array[2]) :
-                defaultValue;
-        };
+        for (Vertex& vertex : primitive.Vertices)
+        {
+            const XMVECTOR position = XMLoadFloat4(&vertex.Position);
+            XMStoreFloat4(&vertex.Position, XMVectorSelect(position, XMVector3TransformCoord(position, transform), g_XMSelect1110));
+            XMStoreFloat3(&vertex.Normal, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&vertex.Normal), normalTransform)));
 
-        // Read an optional scalar parameter if available, otherwise use the default.
-        auto readParameterFactorAsScalar = [](const tinygltf::ParameterMap& parameters, std::string_view name, double defaultValue) {
-            auto c = parameters.find(name.data());
-            return (c != parameters.end() && c->second.number_array.size() == 1) ? c->second.number_array[0] : defaultValue;
-        };
+            // The handedness of the tangent frame flips along with the mirrored normal and tangent.
+            const XMVECTOR tangent = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat4(&vertex.Tangent), transform));
+            XMStoreFloat4(&vertex.Tangent, XMVectorSetW(tangent, mirrored ? -vertex.Tangent.w : vertex.Tangent.w));
+        }
 
-        // Read an optional boolean parameter if available, otherwise use the default.
-        auto readParameterFactorAsBoolean = [](const tinygltf::ParameterMap& parameters, std::string_view name, bool defaultValue) {
-            auto c = parameters.find(name.data());
-            return c != parameters.end() ? c->second.bool_value : defaultValue;
-        };
-        
-        // Read an optional boolean parameter if available, otherwise use the default.
-        auto readParameterFactorAsString = [](const tinygltf::ParameterMap& parameters, std::string_view name, std::string_view defaultValue) {
-            auto c = parameters.find(name.data());
-            return c != parameters.end() ? c->second.string_value : defaultValue;
-        };
+        // Deltas are differences of vectors, so only the linear part of the transforms applies to them. They are not normalized,
+        // since it is the morphed normals and tangents which are unit length.
+        for (MorphTarget& target : primitive.Targets)
+        {
+            for (XMFLOAT3& delta : target.PositionDeltas)
+            {
+                XMStoreFloat3(&delta, XMVector3TransformNormal(XMLoadFloat3(&delta), transform));
+            }
+            for (XMFLOAT3& delta : target.NormalDeltas)
+            {
+                XMStoreFloat3(&delta, XMVector3TransformNormal(XMLoadFloat3(&delta), normalTransform));
+            }
+            for (XMFLOAT3& delta : target.TangentDeltas)
+            {
+                XMStoreFloat3(&delta, XMVector3TransformNormal(XMLoadFloat3(&delta), transform));
+            }
+        }
+
+        if (mirrored)
+        {
+            for (size_t i = 0; i + 2 < primitive.Indices.size(); i += 3)
+            {
+                std::swap(primitive.Indices[i + 1], primitive.Indices[i + 2]);
+            }
+        }
+    }
 
-        // Read a specific texture from a tinygltf material parameter map.
-        auto loadTextureFromParameter = [&](const tinygltf::ParameterMap& parameterMap, std::string_view textureName)
+    Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial)
+    {
+        // Read the texture and sampler a material texture refers to, if any.
+        auto readTexture = [&](int textureIndex)
         {
             Material::Texture texture{};
 
-            const auto& textureIt = parameterMap.find(textureName.data());
-            if (textureIt != std::end(parameterMap))
+            if (textureIndex != -1)
             {
-                const int textureIndex = (int)textureIt->second.json_double_value.at("index");
                 const tinygltf::Texture& gltfTexture = gltfModel.textures.at(textureIndex);
                 if (gltfTexture.source != -1)
                 {
                     texture.Image = &gltfModel.images.at(gltfTexture.source);
                 }
 
-                if (gltfTexture.sampler != -1)
+                // MSFT_texture_dds gives a DDS image, usually block compressed with its mips, to use instead of the source.
+                const auto dds = gltfTexture.extensions.find("MSFT_texture_dds");
+                if (dds != gltfTexture.extensions.end() && dds->second.Has("source") && dds->second.Get("source").IsInt())
                 {
-                    texture.Sampler = &gltfModel.samplers.at(gltfTexture.sampler);
+                    texture.DdsImage = &gltfModel.images.at(dds->second.Get("source").Get<int>());
                 }
-            }
-
-            return texture;
-        };
 
-        // Read a scalar value from a tinygltf material parameter map.
-        auto loadScalarFromParameter = [&](const tinygltf::ParameterMap& parameterMap, std::string_view name, std::string_view scalarField, double defaultValue)
-        {
-            const auto& textureIt = parameterMap.find(name.data());
-            if (textureIt != std::end(parameterMap))
-            {
-                const auto& jsonDoubleValues = textureIt->second.json_double_value;
-                const auto& jsonDoubleIt = jsonDoubleValues.find(scalarField.data());
-                if (jsonDoubleIt != std::end(jsonDoubleValues))
+                if (gltfTexture.sampler != -1)
                 {
-                    return jsonDoubleIt->second;
+                    texture.Sampler = &gltfModel.samplers.at(gltfTexture.sampler);
                 }
             }
 
-            return defaultValue;
+            return texture;
         };
 
         //
-        // Read all of the optional material fields from the tinygltf object model and store them in a GltfHelper Material object
-        // coalesced with proper defaults when needed.
+        // Read the material fields tinygltf parsed into its structured material, which holds the glTF defaults for the fields the
+        // material leaves out, and store them in a GltfHelper Material object. Factors with the wrong number of components fall
+        // back to the defaults as well.
         //
+        const tinygltf::PbrMetallicRoughness& pbr = gltfMaterial.pbrMetallicRoughness;
         Material material;
 
-        material.BaseColorTexture = loadTextureFromParameter(gltfMaterial.values, "baseColorTexture");
-        material.BaseColorFactor = readParameterFactorAsVec4(gltfMaterial.values, "baseColorFactor", XMFLOAT4(1, 1, 1, 1));
+        material.BaseColorTexture = readTexture(pbr.baseColorTexture.index);
+        material.BaseColorFactor = pbr.baseColorFactor.size() == 4 ?
+            XMFLOAT4((float)pbr.baseColorFactor[0], (float)pbr.baseColorFactor[1], (float)pbr.baseColorFactor[2], (float)pbr.baseColorFactor[3]) :
+            XMFLOAT4(1, 1, 1, 1);
 
-        material.MetallicRoughnessTexture = loadTextureFromParameter(gltfMaterial.values, "metallicRoughnessTexture");
-        material.MetallicFactor = (float)readParameterFactorAsScalar(gltfMaterial.values, "metallicFactor", 1);
-        material.RoughnessFactor = (float)readParameterFactorAsScalar(gltfMaterial.values, "roughnessFactor", 1);
+        material.MetallicRoughnessTexture = readTexture(pbr.metallicRoughnessTexture.index);
+        material.MetallicFactor = (float)pbr.metallicFactor;
+        material.RoughnessFactor = (float)pbr.roughnessFactor;
 
-        material.EmissiveTexture = loadTextureFromParameter(gltfMaterial.additionalValues, "emissiveTexture");
-        material.EmissiveFactor = readParameterFactorAsVec3(gltfMaterial.additionalValues, "emissiveFactor", XMFLOAT3(0, 0, 0));
+        material.EmissiveTexture = readTexture(gltfMaterial.emissiveTexture.index);
+        material.EmissiveFactor = gltfMaterial.emissiveFactor.size() == 3 ?
+            XMFLOAT3((float)gltfMaterial.emissiveFactor[0], (float)gltfMaterial.emissiveFactor[1], (float)gltfMaterial.emissiveFactor[2]) :
+            XMFLOAT3(0, 0, 0);
 
-        material.NormalTexture = loadTextureFromParameter(gltfMaterial.additionalValues, "normalTexture");
-        material.NormalScale = (float)loadScalarFromParameter(gltfMaterial.additionalValues, "normalTexture", "scale", 1.0);
+        material.NormalTexture = readTexture(gltfMaterial.normalTexture.index);
+        material.NormalScale = (float)gltfMaterial.normalTexture.scale;
 
-        material.OcclusionTexture = loadTextureFromParameter(gltfMaterial.additionalValues, "occlusionTexture");
-        material.OcclusionStrength = (float)loadScalarFromParameter(gltfMaterial.additionalValues, "occlusionTexture", "strength", 1.0);
+        material.OcclusionTexture = readTexture(gltfMaterial.occlusionTexture.index);
+        material.OcclusionStrength = (float)gltfMaterial.occlusionTexture.strength;
 
-        auto alphaMode = readParameterFactorAsString(gltfMaterial.additionalValues, "alphaMode", "OPAQUE");
-        material.AlphaMode = alphaMode == "MASK" ? AlphaMode::Mask :
-                             alphaMode == "BLEND" ? AlphaMode::Blend : AlphaMode::Opaque;
-        material.DoubleSided = readParameterFactorAsBoolean(gltfMaterial.additionalValues, "doubleSided", false);
-        material.AlphaCutoff = (float)readParameterFactorAsScalar(gltfMaterial.additionalValues, "alphaCutoff", 0.5f);
+        material.AlphaMode = gltfMaterial.alphaMode == "MASK" ? AlphaMode::Mask :
+                             gltfMaterial.alphaMode == "BLEND" ? AlphaMode::Blend : AlphaMode::Opaque;
+        material.DoubleSided = gltfMaterial.doubleSided;
+        material.AlphaCutoff = (float)gltfMaterial.alphaCutoff;
 
         return material;
     }
 
+    BufferData ReadEncodedImage(const tinygltf::Model& gltfModel, const tinygltf::Image& image, const BufferData& binaryChunk)
+    {
+        if (image.bufferView == -1)
+        {
+            return {};
+        }
+
+        const tinygltf::BufferView& bufferView = gltfModel.bufferViews.at(image.bufferView);
+        const BufferData buffer = ReadBuffer(gltfModel, bufferView.buffer, binaryChunk);
+        if (bufferView.byteOffset + bufferView.byteLength > buffer.Size)
+        {
+            throw std::out_of_range("BufferView goes out of range of buffer.");
+        }
+
+        return {buffer.Data + bufferView.byteOffset, bufferView.byteLength};
+    }
+
+    bool DecodeImage(const tinygltf::Model& gltfModel, const tinygltf::Image& image, const BufferData& binaryChunk, _Out_ tinygltf::Image* decodedImage)
+    {
+        const BufferData encodedImage = ReadEncodedImage(gltfModel, image, binaryChunk);
+        if (encodedImage.Data == nullptr)
+        {
+            return false;
+        }
+
+        // Only the pixels are decoded here, the other image properties were read along with the document. Unlike tinygltf, which
+        // expands every image to RGBA, the pixels keep the channels of the encoded image, and 16-bit images are reduced to 8 bits.
+        int width, height, component;
+        const std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels(
+            stbi_load_from_memory(encodedImage.Data, (int)encodedImage.Size, &width, &height, &component, 0),
+            &stbi_image_free);
+        if (pixels == nullptr || width < 1 || height < 1)
+        {
+            return false;
+        }
+
+        *decodedImage = image;
+        decodedImage->width = width;
+        decodedImage->height = height;
+        decodedImage->component = component;
+        decodedImage->bits = 8;
+        decodedImage->pixel_type = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+        decodedImage->image.assign(pixels.get(), pixels.get() + (size_t)width * height * component);
+        return true;
+    }
+
     const uint8_t* ReadImageAsRGBA(const tinygltf::Image& image, _Inout_ std::vector<uint8_t>* tempBuffer)
     {
         // The image vector (image.image) will be populated if the image was successfully loaded by glTF.
@@ -688,28 +1692,51 @@ namespace GltfHelper
                 throw std::exception("Invalid image buffer size");
             }
 
-            // Not supported: STBI_grey (DXGI_FORMAT_R8_UNORM?) and STBI_grey_alpha.
-            if (image.component == 3)
+            if (image.component == 4)
             {
-                // Convert RGB to RGBA.
-                tempBuffer->resize(image.width * image.height * 4);
-                for (int y = 0; y < image.height; ++y)
-                {
-                    const uint8_t *src = image.image.data() + y * image.width * 3;
-                    uint8_t *dest = tempBuffer->data() + y * image.width * 4;
-                    for (int x = image.width - 1; x >= 0; --x, src += 3, dest += 4)
-                    {
-                        dest[0] = src[0]; dest[1] = src[1]; dest[2] = src[2]; dest[3] = 255;
-                    }
-                }
+                // Already RGBA, no conversion needed
+                return image.image.data();
+            }
 
+            const size_t pixelCount = (size_t)image.width * image.height;
+            tempBuffer->resize(pixelCount * 4);
+            switch (image.component)
+            {
+            case 1:
+                ConvertGreyToRgba(image.image.data(), tempBuffer->data(), pixelCount);
+                return tempBuffer->data();
+            case 2:
+                ConvertGreyAlphaToRgba(image.image.data(), tempBuffer->data(), pixelCount);
+                return tempBuffer->data();
+            case 3:
+                ConvertRgbToRgba(image.image.data(), tempBuffer->data(), pixelCount);
                 return tempBuffer->data();
             }
-            else if (image.component == 4)
+        }
+
+        return nullptr;
+    }
+
+    const uint8_t* ReadImageAsR8(const tinygltf::Image& image, _Inout_ std::vector<uint8_t>* tempBuffer)
+    {
+        if (image.width > 0 && image.height > 0)
+        {
+            if (image.width * image.height * image.component != image.image.size())
+            {
+                throw std::exception("Invalid image buffer size");
+            }
+
+            if (image.component == 1)
             {
-                // Already RGBA, no conversion needed
                 return image.image.data();
             }
+            else if (image.component == 2)
+            {
+                const size_t pixelCount = (size_t)image.width * image.height;
+                tempBuffer->resize(pixelCount);
+                ConvertGreyAlphaToGrey(image.image.data(), tempBuffer->data(), pixelCount);
+                return tempBuffer->data();
+            }
         }
 
         return nullptr;
@@ -10,6 +10,8 @@
 #include "pch.h"
 
 #include <DirectXMath.h>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace tinygltf
@@ -24,22 +26,34 @@ namespace tinygltf
 
 namespace GltfHelper
 {
-    // Vertex data.
+    // Vertex data. The fields are tightly packed floats in the order of the usual full precision vertex layout of a renderer, so
+    // that vertices can be copied into a vertex buffer of that layout as a whole.
     struct Vertex
     {
         DirectX::XMFLOAT4 Position;
         DirectX::XMFLOAT3 Normal;
         DirectX::XMFLOAT4 Tangent;
-        DirectX::XMFLOAT2 TexCoord0;
         DirectX::XMFLOAT4 Color0;
+        DirectX::XMFLOAT2 TexCoord0;
         // Note: This implementation does not currently support TexCoord1 attributes.
     };
 
-    // A primitive is a collection of vertices and indices.
+    // A morph target of a primitive, holding the displacements of only the vertices it moves. Vertices is sorted, and each of
+    // the delta arrays is either empty, when the target does not displace that attribute, or holds a delta per entry of Vertices.
+    struct MorphTarget
+    {
+        std::vector<uint32_t> Vertices;
+        std::vector<DirectX::XMFLOAT3> PositionDeltas;
+        std::vector<DirectX::XMFLOAT3> NormalDeltas;
+        std::vector<DirectX::XMFLOAT3> TangentDeltas;
+    };
+
+    // A primitive is a collection of vertices and indices, and the morph targets which displace the vertices.
     struct Primitive
     {
         std::vector<Vertex> Vertices;
         std::vector<uint32_t> Indices;
+        std::vector<MorphTarget> Targets;
     };
 
     enum class AlphaMode { Opaque, Mask, Blend };
@@ -50,6 +64,7 @@ namespace GltfHelper
         struct Texture
         {
             const tinygltf::Image* Image;
+            const tinygltf::Image* DdsImage; // The DDS source of MSFT_texture_dds, preferred over Image, which is its fallback.
             const tinygltf::Sampler* Sampler;
         };
 
@@ -72,15 +87,77 @@ namespace GltfHelper
         bool DoubleSided;
     };
 
+    // Binary data of a glTF buffer.
+    struct BufferData
+    {
+        const uint8_t* Data;
+        size_t Size;
+    };
+
+    // Gets the data of a glTF buffer. When the model was parsed without copying the GLB binary chunk
+    // (see GltfHelper::ParseGltfJson), the chunk must be given as binaryChunk.
+    BufferData ReadBuffer(const tinygltf::Model& gltfModel, int bufferIndex, const BufferData& binaryChunk = {});
+
+    // Contents of buffer views compressed with EXT_meshopt_compression once decoded, by buffer view index. Accessors of these views
+    // read the decoded contents instead of the fallback buffer, which usually has no data.
+    using DecodedBufferViews = std::unordered_map<int, std::vector<uint8_t>>;
+
     // Reads the "transform" or "TRS" data for a Node as an XMMATRIX.
     DirectX::XMMATRIX XM_CALLCONV ReadNodeLocalTransform(const tinygltf::Node& gltfNode);
 
+    // Whether the model lists the extension in its extensionsUsed.
+    bool UsesExtension(const tinygltf::Model& gltfModel, std::string_view extension);
+
+    // Algorithm used to generate tangents for primitives which have none.
+    enum class TangentMode
+    {
+        MikkTSpace, // The MikkTSpace algorithm recommended by the glTF 2.0 specification, which normal maps are usually baked with.
+        Fast,       // Per-vertex sums of the triangle tangents, orthogonalized against the normals. Approximates MikkTSpace.
+    };
+
+    struct TangentOptions
+    {
+        TangentMode Mode{TangentMode::MikkTSpace};
+
+        // In Fast mode, primitives with at least this many triangles are split across up to MaxThreadCount threads.
+        // The result does not depend on the split.
+        uint32_t ParallelTriangleThreshold{64 * 1024};
+        uint32_t MaxThreadCount{4};
+    };
+
     // Parses the primitive attributes and indices from the glTF accessors/bufferviews/buffers into a common simplified data structure, the Primitive.
-    Primitive ReadPrimitive(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive);
+    // Missing normals and tangents are generated. Attributes quantized with KHR_mesh_quantization are converted to floats as they
+    // are stored, except for texture coordinates, which are dequantized by the KHR_texture_transform of the material. Positions
+    // are left for the transform of their node to dequantize (see TransformPrimitive). Compressed buffer views are read from
+    // decodedBufferViews. Sparse attributes are applied to the vertices, while the POSITION, NORMAL and TANGENT deltas of morph
+    // targets are read as lists of the vertices they move, straight from the sparse accessors they are usually stored in.
+    Primitive ReadPrimitive(const tinygltf::Model& gltfModel,
+                            const tinygltf::Primitive& gltfPrimitive,
+                            const BufferData& binaryChunk = {},
+                            const TangentOptions& tangentOptions = {},
+                            const DecodedBufferViews& decodedBufferViews = {});
+
+    // Transforms the positions, normals and tangents of a primitive, such as by the transform of its node, along with the deltas of
+    // its morph targets. Transforms which mirror the primitive also reverse the winding of its triangles, so that they keep facing
+    // outwards.
+    void XM_CALLCONV TransformPrimitive(Primitive& primitive, DirectX::FXMMATRIX transform);
 
     // Parses the material values into a simplified data structure, the Material.
     Material ReadMaterial(const tinygltf::Model& gltfModel, const tinygltf::Material& gltfMaterial);
 
+    // Gets the encoded content of an image stored in a buffer view, such as a PNG or DDS file. Returns empty data if the image is
+    // not stored in a buffer view.
+    BufferData ReadEncodedImage(const tinygltf::Model& gltfModel, const tinygltf::Image& image, const BufferData& binaryChunk = {});
+
+    // Decodes an image stored in a buffer view whose pixels were not decoded by tinygltf, such as an image in a GLB binary chunk
+    // that is read in place. The decoded image has 8-bit channels, as many as the encoded image. Returns false if the image is not
+    // stored in a buffer view or cannot be decoded.
+    bool DecodeImage(const tinygltf::Model& gltfModel, const tinygltf::Image& image, const BufferData& binaryChunk, _Out_ tinygltf::Image* decodedImage);
+
     // Converts the image to RGBA if necessary. Requires a temporary buffer only if it needs to be converted.
     const uint8_t* ReadImageAsRGBA(const tinygltf::Image& image, _Inout_ std::vector<uint8_t>* tempBuffer);
+
+    // Reads a grey or grey-alpha image as single channel pixels, dropping the alpha. Returns null for color images.
+    // Requires a temporary buffer only if it needs to be converted.
+    const uint8_t* ReadImageAsR8(const tinygltf::Image& image, _Inout_ std::vector<uint8_t>* tempBuffer);
 }
@@ -0,0 +1,998 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#define TINYGLTF_USE_RAPIDJSON
+#define TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#include <tiny_gltf.h>
+#include "memorystream.h"
+#include "reader.h"
+#include "GltfSaxParser.h"
+
+namespace
+{
+    enum class TokenType { Null, Boolean, Number, String, Key, StartObject, EndObject, StartArray, EndArray };
+
+    // Handler receiving the single event of each parsing step. Strings and keys are copied, since rapidjson only keeps them until
+    // the next step, into a buffer which is reused from step to step.
+    struct JsonToken
+    {
+        TokenType Type{TokenType::Null};
+        bool Boolean{false};
+        double Number{0};
+        bool IsInteger{false};
+        std::string Text;
+
+        bool Null() { return Set(TokenType::Null); }
+        bool Bool(bool value) { Boolean = value; return Set(TokenType::Boolean); }
+        bool Int(int value) { return SetInteger(value); }
+        bool Uint(unsigned value) { return SetInteger(value); }
+        bool Int64(int64_t value) { return SetInteger((double)value); }
+        bool Uint64(uint64_t value) { return SetInteger((double)value); }
+        bool Double(double value) { Number = value; IsInteger = false; return Set(TokenType::Number); }
+        bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; } // Only used with kParseNumbersAsStringsFlag.
+        bool String(const char* text, rapidjson::SizeType length, bool) { Text.assign(text, length); return Set(TokenType::String); }
+        bool Key(const char* text, rapidjson::SizeType length, bool) { Text.assign(text, length); return Set(TokenType::Key); }
+        bool StartObject() { return Set(TokenType::StartObject); }
+        bool EndObject(rapidjson::SizeType) { return Set(TokenType::EndObject); }
+        bool StartArray() { return Set(TokenType::StartArray); }
+        bool EndArray(rapidjson::SizeType) { return Set(TokenType::EndArray); }
+
+    private:
+        bool Set(TokenType type)
+        {
+            Type = type;
+            return true;
+        }
+
+        bool SetInteger(double value)
+        {
+            Number = value;
+            IsInteger = true;
+            return Set(TokenType::Number);
+        }
+    };
+
+    // Pulls the tokens of a JSON document one at a time, so that each glTF property is read straight into the member of the
+    // tinygltf model it belongs to. Throws if the document is not valid JSON or a value does not have the expected type.
+    class JsonReader
+    {
+    public:
+        explicit JsonReader(std::string_view json)
+            : m_stream(json.data(), json.size())
+        {
+            m_reader.IterativeParseInit();
+        }
+
+        // Reads an object, calling readMember with the key of each member. readMember reads the values of the members it knows
+        // and returns false for the others, which are skipped. The key is only valid until the value is read.
+        template <typename TReadMember>
+        void ReadObject(TReadMember&& readMember)
+        {
+            Expect(TokenType::StartObject);
+            while (Next().Type != TokenType::EndObject)
+            {
+                if (!readMember(std::string_view(m_token.Text)))
+                {
+                    SkipValue();
+                }
+            }
+        }
+
+        // Reads an array, calling readElement to read each element.
+        template <typename TReadElement>
+        void ReadArray(TReadElement&& readElement)
+        {
+            Expect(TokenType::StartArray);
+            while (Next().Type != TokenType::EndArray)
+            {
+                m_peeked = true; // The element starts with the token just read.
+                readElement();
+            }
+        }
+
+        double ReadNumber()
+        {
+            return Expect(TokenType::Number).Number;
+        }
+
+        int ReadInt()
+        {
+            const JsonToken& token = Expect(TokenType::Number);
+            if (!token.IsInteger || token.Number < std::numeric_limits<int>::min() || token.Number > std::numeric_limits<int>::max())
+            {
+                throw std::exception("Expected an integer in glTF JSON.");
+            }
+            return (int)token.Number;
+        }
+
+        size_t ReadSize()
+        {
+            const JsonToken& token = Expect(TokenType::Number);
+            if (!token.IsInteger || token.Number < 0)
+            {
+                throw std::exception("Expected an unsigned integer in glTF JSON.");
+            }
+            return (size_t)token.Number;
+        }
+
+        bool ReadBool()
+        {
+            return Expect(TokenType::Boolean).Boolean;
+        }
+
+        void ReadString(std::string& value)
+        {
+            value = Expect(TokenType::String).Text;
+        }
+
+        void ReadNumbers(std::vector<double>& values)
+        {
+            values.clear();
+            ReadArray([&] { values.push_back(ReadNumber()); });
+        }
+
+        void ReadInts(std::vector<int>& values)
+        {
+            values.clear();
+            ReadArray([&] { values.push_back(ReadInt()); });
+        }
+
+        void ReadStrings(std::vector<std::string>& values)
+        {
+            values.clear();
+            ReadArray([&] { ReadString(values.emplace_back()); });
+        }
+
+        // Reads any value into a tinygltf value, for the extensions which are read by name once the document is loaded.
+        tinygltf::Value ReadValue()
+        {
+            const JsonToken& token = Next();
+            switch (token.Type)
+            {
+            case TokenType::Boolean:
+                return tinygltf::Value(token.Boolean);
+            case TokenType::Number:
+                return token.IsInteger && std::abs(token.Number) <= std::numeric_limits<int>::max() ? tinygltf::Value((int)token.Number)
+                                                                                                     : tinygltf::Value(token.Number);
+            case TokenType::String:
+                return tinygltf::Value(token.Text);
+            case TokenType::StartArray:
+            {
+                tinygltf::Value::Array array;
+                m_peeked = true;
+                ReadArray([&] { array.push_back(ReadValue()); });
+                return tinygltf::Value(std::move(array));
+            }
+            case TokenType::StartObject:
+            {
+                tinygltf::Value::Object object;
+                m_peeked = true;
+                ReadObject([&](std::string_view key) {
+                    std::string name(key);
+                    object.emplace(std::move(name), ReadValue());
+                    return true;
+                });
+                return tinygltf::Value(std::move(object));
+            }
+            default:
+                return tinygltf::Value();
+            }
+        }
+
+        // Skips a value, along with all of its members or elements.
+        void SkipValue()
+        {
+            int depth = 0;
+            do
+            {
+                switch (Next().Type)
+                {
+                case TokenType::StartObject:
+                case TokenType::StartArray:
+                    depth++;
+                    break;
+                case TokenType::EndObject:
+                case TokenType::EndArray:
+                    depth--;
+                    break;
+                default:
+                    break;
+                }
+            } while (depth > 0);
+        }
+
+    private:
+        const JsonToken& Next()
+        {
+            if (m_peeked)
+            {
+                m_peeked = false;
+            }
+            else if (!m_reader.IterativeParseNext<rapidjson::kParseDefaultFlags>(m_stream, m_token))
+            {
+                throw std::exception("Invalid glTF JSON.");
+            }
+            return m_token;
+        }
+
+        const JsonToken& Expect(TokenType type)
+        {
+            const JsonToken& token = Next();
+            if (token.Type != type)
+            {
+                throw std::exception("Unexpected value type in glTF JSON.");
+            }
+            return token;
+        }
+
+        rapidjson::MemoryStream m_stream;
+        rapidjson::Reader m_reader;
+        JsonToken m_token;
+        bool m_peeked{false};
+    };
+
+    void ReadExtensions(JsonReader& reader, tinygltf::ExtensionMap& extensions)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            std::string name(key);
+            extensions.emplace(std::move(name), reader.ReadValue());
+            return true;
+        });
+    }
+
+    // Reads the members which all kinds of texture references have.
+    template <typename TTextureInfo>
+    bool ReadTextureInfoMember(JsonReader& reader, std::string_view key, TTextureInfo& textureInfo)
+    {
+        if (key == "index")
+        {
+            textureInfo.index = reader.ReadInt();
+        }
+        else if (key == "texCoord")
+        {
+            textureInfo.texCoord = reader.ReadInt();
+        }
+        else if (key == "extensions")
+        {
+            ReadExtensions(reader, textureInfo.extensions);
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    void ReadTextureInfo(JsonReader& reader, tinygltf::TextureInfo& textureInfo)
+    {
+        reader.ReadObject([&](std::string_view key) { return ReadTextureInfoMember(reader, key, textureInfo); });
+    }
+
+    void ReadNormalTextureInfo(JsonReader& reader, tinygltf::NormalTextureInfo& textureInfo)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "scale")
+            {
+                textureInfo.scale = reader.ReadNumber();
+                return true;
+            }
+            return ReadTextureInfoMember(reader, key, textureInfo);
+        });
+    }
+
+    void ReadOcclusionTextureInfo(JsonReader& reader, tinygltf::OcclusionTextureInfo& textureInfo)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "strength")
+            {
+                textureInfo.strength = reader.ReadNumber();
+                return true;
+            }
+            return ReadTextureInfoMember(reader, key, textureInfo);
+        });
+    }
+
+    void ReadAsset(JsonReader& reader, tinygltf::Asset& asset)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "version")
+            {
+                reader.ReadString(asset.version);
+            }
+            else if (key == "minVersion")
+            {
+                reader.ReadString(asset.minVersion);
+            }
+            else if (key == "generator")
+            {
+                reader.ReadString(asset.generator);
+            }
+            else if (key == "copyright")
+            {
+                reader.ReadString(asset.copyright);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadScene(JsonReader& reader, tinygltf::Scene& scene)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "nodes")
+            {
+                reader.ReadInts(scene.nodes);
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(scene.name);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadNode(JsonReader& reader, tinygltf::Node& node)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "mesh")
+            {
+                node.mesh = reader.ReadInt();
+            }
+            else if (key == "children")
+            {
+                reader.ReadInts(node.children);
+            }
+            else if (key == "matrix")
+            {
+                reader.ReadNumbers(node.matrix);
+            }
+            else if (key == "translation")
+            {
+                reader.ReadNumbers(node.translation);
+            }
+            else if (key == "rotation")
+            {
+                reader.ReadNumbers(node.rotation);
+            }
+            else if (key == "scale")
+            {
+                reader.ReadNumbers(node.scale);
+            }
+            else if (key == "weights")
+            {
+                reader.ReadNumbers(node.weights);
+            }
+            else if (key == "camera")
+            {
+                node.camera = reader.ReadInt();
+            }
+            else if (key == "skin")
+            {
+                node.skin = reader.ReadInt();
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(node.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, node.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Reads the attributes of a primitive, or of one of its morph targets, by attribute name.
+    void ReadAttributes(JsonReader& reader, std::map<std::string, int>& attributes)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            std::string name(key);
+            attributes[std::move(name)] = reader.ReadInt();
+            return true;
+        });
+    }
+
+    void ReadPrimitive(JsonReader& reader, tinygltf::Primitive& primitive)
+    {
+        primitive.mode = TINYGLTF_MODE_TRIANGLES;
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "attributes")
+            {
+                ReadAttributes(reader, primitive.attributes);
+            }
+            else if (key == "indices")
+            {
+                primitive.indices = reader.ReadInt();
+            }
+            else if (key == "material")
+            {
+                primitive.material = reader.ReadInt();
+            }
+            else if (key == "mode")
+            {
+                primitive.mode = reader.ReadInt();
+            }
+            else if (key == "targets")
+            {
+                reader.ReadArray([&] { ReadAttributes(reader, primitive.targets.emplace_back()); });
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, primitive.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadMesh(JsonReader& reader, tinygltf::Mesh& mesh)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "primitives")
+            {
+                reader.ReadArray([&] { ReadPrimitive(reader, mesh.primitives.emplace_back()); });
+            }
+            else if (key == "weights")
+            {
+                reader.ReadNumbers(mesh.weights);
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(mesh.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, mesh.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    int ReadAccessorType(JsonReader& reader)
+    {
+        std::string type;
+        reader.ReadString(type);
+        return type == "SCALAR" ? TINYGLTF_TYPE_SCALAR :
+               type == "VEC2" ? TINYGLTF_TYPE_VEC2 :
+               type == "VEC3" ? TINYGLTF_TYPE_VEC3 :
+               type == "VEC4" ? TINYGLTF_TYPE_VEC4 :
+               type == "MAT2" ? TINYGLTF_TYPE_MAT2 :
+               type == "MAT3" ? TINYGLTF_TYPE_MAT3 :
+               type == "MAT4" ? TINYGLTF_TYPE_MAT4 : -1;
+    }
+
+    void ReadSparseAccessor(JsonReader& reader, tinygltf::Accessor& accessor)
+    {
+        accessor.sparse.isSparse = true;
+        accessor.sparse.count = 0;
+        accessor.sparse.indices = {0, -1, -1};
+        accessor.sparse.values = {-1, 0};
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "count")
+            {
+                accessor.sparse.count = reader.ReadInt();
+            }
+            else if (key == "indices")
+            {
+                reader.ReadObject([&](std::string_view indicesKey) {
+                    if (indicesKey == "bufferView")
+                    {
+                        accessor.sparse.indices.bufferView = reader.ReadInt();
+                    }
+                    else if (indicesKey == "byteOffset")
+                    {
+                        accessor.sparse.indices.byteOffset = reader.ReadInt();
+                    }
+                    else if (indicesKey == "componentType")
+                    {
+                        accessor.sparse.indices.componentType = reader.ReadInt();
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            else if (key == "values")
+            {
+                reader.ReadObject([&](std::string_view valuesKey) {
+                    if (valuesKey == "bufferView")
+                    {
+                        accessor.sparse.values.bufferView = reader.ReadInt();
+                    }
+                    else if (valuesKey == "byteOffset")
+                    {
+                        accessor.sparse.values.byteOffset = reader.ReadInt();
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadAccessor(JsonReader& reader, tinygltf::Accessor& accessor)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "bufferView")
+            {
+                accessor.bufferView = reader.ReadInt();
+            }
+            else if (key == "byteOffset")
+            {
+                accessor.byteOffset = reader.ReadSize();
+            }
+            else if (key == "componentType")
+            {
+                accessor.componentType = reader.ReadInt();
+            }
+            else if (key == "normalized")
+            {
+                accessor.normalized = reader.ReadBool();
+            }
+            else if (key == "count")
+            {
+                accessor.count = reader.ReadSize();
+            }
+            else if (key == "type")
+            {
+                accessor.type = ReadAccessorType(reader);
+            }
+            else if (key == "min")
+            {
+                reader.ReadNumbers(accessor.minValues);
+            }
+            else if (key == "max")
+            {
+                reader.ReadNumbers(accessor.maxValues);
+            }
+            else if (key == "sparse")
+            {
+                ReadSparseAccessor(reader, accessor);
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(accessor.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, accessor.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadBufferView(JsonReader& reader, tinygltf::BufferView& bufferView)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "buffer")
+            {
+                bufferView.buffer = reader.ReadInt();
+            }
+            else if (key == "byteOffset")
+            {
+                bufferView.byteOffset = reader.ReadSize();
+            }
+            else if (key == "byteLength")
+            {
+                bufferView.byteLength = reader.ReadSize();
+            }
+            else if (key == "byteStride")
+            {
+                bufferView.byteStride = reader.ReadSize();
+            }
+            else if (key == "target")
+            {
+                bufferView.target = reader.ReadInt();
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(bufferView.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, bufferView.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Reads a buffer, which is left without data since the binary chunk is read in place and the fallback buffers of
+    // EXT_meshopt_compression are not read at all. Throws for the buffers tinygltf has to load.
+    void ReadBuffer(JsonReader& reader, tinygltf::Buffer& buffer, bool firstBuffer, size_t binaryChunkSize)
+    {
+        size_t byteLength = 0;
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "byteLength")
+            {
+                byteLength = reader.ReadSize();
+            }
+            else if (key == "uri")
+            {
+                reader.ReadString(buffer.uri);
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(buffer.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, buffer.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+
+        const auto meshopt = buffer.extensions.find("EXT_meshopt_compression");
+        const bool fallback = meshopt != buffer.extensions.end() && meshopt->second.Has("fallback") &&
+                              meshopt->second.Get("fallback").IsBool() && meshopt->second.Get("fallback").Get<bool>();
+        if (!buffer.uri.empty() || (!fallback && (!firstBuffer || byteLength > binaryChunkSize)))
+        {
+            throw std::exception("Buffer is not backed by the binary chunk.");
+        }
+    }
+
+    void ReadMaterial(JsonReader& reader, tinygltf::Material& material)
+    {
+        material.emissiveFactor = {0.0, 0.0, 0.0};
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "pbrMetallicRoughness")
+            {
+                tinygltf::PbrMetallicRoughness& pbr = material.pbrMetallicRoughness;
+                reader.ReadObject([&](std::string_view pbrKey) {
+                    if (pbrKey == "baseColorFactor")
+                    {
+                        reader.ReadNumbers(pbr.baseColorFactor);
+                    }
+                    else if (pbrKey == "baseColorTexture")
+                    {
+                        ReadTextureInfo(reader, pbr.baseColorTexture);
+                    }
+                    else if (pbrKey == "metallicFactor")
+                    {
+                        pbr.metallicFactor = reader.ReadNumber();
+                    }
+                    else if (pbrKey == "roughnessFactor")
+                    {
+                        pbr.roughnessFactor = reader.ReadNumber();
+                    }
+                    else if (pbrKey == "metallicRoughnessTexture")
+                    {
+                        ReadTextureInfo(reader, pbr.metallicRoughnessTexture);
+                    }
+                    else if (pbrKey == "extensions")
+                    {
+                        ReadExtensions(reader, pbr.extensions);
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    return true;
+                });
+            }
+            else if (key == "normalTexture")
+            {
+                ReadNormalTextureInfo(reader, material.normalTexture);
+            }
+            else if (key == "occlusionTexture")
+            {
+                ReadOcclusionTextureInfo(reader, material.occlusionTexture);
+            }
+            else if (key == "emissiveTexture")
+            {
+                ReadTextureInfo(reader, material.emissiveTexture);
+            }
+            else if (key == "emissiveFactor")
+            {
+                reader.ReadNumbers(material.emissiveFactor);
+            }
+            else if (key == "alphaMode")
+            {
+                reader.ReadString(material.alphaMode);
+            }
+            else if (key == "alphaCutoff")
+            {
+                material.alphaCutoff = reader.ReadNumber();
+            }
+            else if (key == "doubleSided")
+            {
+                material.doubleSided = reader.ReadBool();
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(material.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, material.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    void ReadTexture(JsonReader& reader, tinygltf::Texture& texture)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "source")
+            {
+                texture.source = reader.ReadInt();
+            }
+            else if (key == "sampler")
+            {
+                texture.sampler = reader.ReadInt();
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(texture.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, texture.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+
+    // Reads an image stored in a buffer view, whose pixels are decoded later on (see GltfHelper::DecodeImage). Throws for images
+    // with a uri, which tinygltf has to load.
+    void ReadImage(JsonReader& reader, tinygltf::Image& image)
+    {
+        image.width = 0;
+        image.height = 0;
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "bufferView")
+            {
+                image.bufferView = reader.ReadInt();
+            }
+            else if (key == "mimeType")
+            {
+                reader.ReadString(image.mimeType);
+            }
+            else if (key == "uri")
+            {
+                reader.ReadString(image.uri);
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(image.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, image.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+
+        if (image.bufferView == -1 || !image.uri.empty())
+        {
+            throw std::exception("Image is not stored in a buffer view.");
+        }
+    }
+
+    void ReadSampler(JsonReader& reader, tinygltf::Sampler& sampler)
+    {
+        reader.ReadObject([&](std::string_view key) {
+            if (key == "magFilter")
+            {
+                sampler.magFilter = reader.ReadInt();
+            }
+            else if (key == "minFilter")
+            {
+                sampler.minFilter = reader.ReadInt();
+            }
+            else if (key == "wrapS")
+            {
+                sampler.wrapS = reader.ReadInt();
+            }
+            else if (key == "wrapT")
+            {
+                sampler.wrapT = reader.ReadInt();
+            }
+            else if (key == "name")
+            {
+                reader.ReadString(sampler.name);
+            }
+            else if (key == "extensions")
+            {
+                ReadExtensions(reader, sampler.extensions);
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        });
+    }
+}
+
+namespace GltfHelper
+{
+    bool ParseGltfJson(std::string_view json, size_t binaryChunkSize, tinygltf::Model* gltfModel)
+    {
+        tinygltf::Model model;
+        try
+        {
+            JsonReader reader(json);
+            reader.ReadObject([&](std::string_view key) {
+                if (key == "asset")
+                {
+                    ReadAsset(reader, model.asset);
+                }
+                else if (key == "extensionsUsed")
+                {
+                    reader.ReadStrings(model.extensionsUsed);
+                }
+                else if (key == "extensionsRequired")
+                {
+                    reader.ReadStrings(model.extensionsRequired);
+                }
+                else if (key == "scene")
+                {
+                    model.defaultScene = reader.ReadInt();
+                }
+                else if (key == "scenes")
+                {
+                    reader.ReadArray([&] { ReadScene(reader, model.scenes.emplace_back()); });
+                }
+                else if (key == "nodes")
+                {
+                    reader.ReadArray([&] { ReadNode(reader, model.nodes.emplace_back()); });
+                }
+                else if (key == "meshes")
+                {
+                    reader.ReadArray([&] { ReadMesh(reader, model.meshes.emplace_back()); });
+                }
+                else if (key == "accessors")
+                {
+                    reader.ReadArray([&] { ReadAccessor(reader, model.accessors.emplace_back()); });
+                }
+                else if (key == "bufferViews")
+                {
+                    reader.ReadArray([&] { ReadBufferView(reader, model.bufferViews.emplace_back()); });
+                }
+                else if (key == "buffers")
+                {
+                    reader.ReadArray([&] {
+                        const bool firstBuffer = model.buffers.empty();
+                        ReadBuffer(reader, model.buffers.emplace_back(), firstBuffer, binaryChunkSize);
+                    });
+                }
+                else if (key == "materials")
+                {
+                    reader.ReadArray([&] { ReadMaterial(reader, model.materials.emplace_back()); });
+                }
+                else if (key == "textures")
+                {
+                    reader.ReadArray([&] { ReadTexture(reader, model.textures.emplace_back()); });
+                }
+                else if (key == "images")
+                {
+                    reader.ReadArray([&] { ReadImage(reader, model.images.emplace_back()); });
+                }
+                else if (key == "samplers")
+                {
+                    reader.ReadArray([&] { ReadSampler(reader, model.samplers.emplace_back()); });
+                }
+                else
+                {
+                    return false;
+                }
+                return true;
+            });
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        // Like tinygltf, check the buffer views of images while loading the document. Other references are checked as they are used.
+        for (const tinygltf::Image& image : model.images)
+        {
+            if ((size_t)image.bufferView >= model.bufferViews.size())
+            {
+                return false;
+            }
+        }
+
+        // Like tinygltf, set the targets of the buffer views which primitives read, since accessors check them.
+        const auto setTarget = [&](int accessorIndex, int target, bool required) {
+            if (accessorIndex < 0 || (size_t)accessorIndex >= model.accessors.size())
+            {
+                return false;
+            }
+            const int bufferViewIndex = model.accessors[accessorIndex].bufferView;
+            if (bufferViewIndex < 0 || (size_t)bufferViewIndex >= model.bufferViews.size())
+            {
+                return !required; // Sparse accessors may have no buffer view.
+            }
+            model.bufferViews[bufferViewIndex].target = target;
+            return true;
+        };
+        for (const tinygltf::Mesh& mesh : model.meshes)
+        {
+            for (const tinygltf::Primitive& primitive : mesh.primitives)
+            {
+                if (primitive.indices != -1 && !setTarget(primitive.indices, TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER, true))
+                {
+                    return false;
+                }
+                for (const auto& attribute : primitive.attributes)
+                {
+                    if (!setTarget(attribute.second, TINYGLTF_TARGET_ARRAY_BUFFER, false))
+                    {
+                        return false;
+                    }
+                }
+                for (const auto& target : primitive.targets)
+                {
+                    for (const auto& attribute : target)
+                    {
+                        if (!setTarget(attribute.second, TINYGLTF_TARGET_ARRAY_BUFFER, false))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        *gltfModel = std::move(model);
+        return true;
+    }
+}
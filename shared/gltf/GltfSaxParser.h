@@ -0,0 +1,28 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+// A streaming parser for the JSON of glTF 2.0 documents, built on the rapidjson SAX reader. It fills the same tinygltf object
+// model as tinygltf, without building a JSON DOM first, so that documents with thousands of nodes parse much faster.
+
+#pragma once
+
+#include "pch.h"
+
+#include <string_view>
+
+namespace tinygltf
+{
+    class Model;
+}
+
+namespace GltfHelper
+{
+    // Parses the JSON chunk of a GLB file into a tinygltf model, as tinygltf::TinyGLTF::LoadBinaryFromMemory does, except that the
+    // buffer backed by the binary chunk is left empty so that it is read in place. Only what this library renders is read: scenes, nodes,
+    // meshes, accessors, buffers, buffer views, materials, textures, images and samplers, along with their extensions. Extras,
+    // cameras, skins and animations are skipped.
+    //
+    // Returns false, leaving the model untouched, if the document is not valid or has content only tinygltf loads, such as buffers
+    // or images with a uri. The document should then be loaded with tinygltf instead, which also reports what is wrong with it.
+    bool ParseGltfJson(std::string_view json, size_t binaryChunkSize, _Out_ tinygltf::Model* gltfModel);
+}
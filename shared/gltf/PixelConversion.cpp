@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "PixelConversion.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#define PIXEL_CONVERSION_X86
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#ifdef PIXEL_CONVERSION_X86
+    // SSE2 is part of the x64 baseline and of the default x86 code generation, so only the later extensions are detected.
+    struct CpuFeatures
+    {
+        bool Ssse3{false};
+        bool Avx2{false};
+    };
+
+    CpuFeatures DetectCpuFeatures()
+    {
+        CpuFeatures features;
+        int registers[4]; // EAX, EBX, ECX, EDX
+        __cpuid(registers, 0);
+        const int maxLeaf = registers[0];
+
+        __cpuid(registers, 1);
+        features.Ssse3 = (registers[2] & (1 << 9)) != 0;
+        const bool osSavesAvxState = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+        if (maxLeaf >= 7 && osSavesAvxState)
+        {
+            __cpuidex(registers, 7, 0);
+            features.Avx2 = (registers[1] & (1 << 5)) != 0;
+        }
+        return features;
+    }
+
+    const CpuFeatures& GetCpuFeatures()
+    {
+        static const CpuFeatures features = DetectCpuFeatures();
+        return features;
+    }
+
+    // Each kernel converts as many whole blocks of pixels as it can without reading past the source, and returns how many
+    // pixels it converted. The remaining pixels are converted by the scalar code.
+
+    size_t ConvertRgbToRgbaSsse3(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+    {
+        // Each 16-byte load holds 4 whole pixels, but 6 are needed to be able to load 16 bytes.
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+        size_t i = 0;
+        for (; i + 6 <= pixelCount; i += 4)
+        {
+            const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(source, shuffle), alpha));
+        }
+        return i;
+    }
+
+    size_t ConvertRgbToRgbaAvx2(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+    {
+        // The shuffle does not cross 128-bit lanes, so each lane is loaded with 4 pixels of its own.
+        const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+        size_t i = 0;
+        for (; i + 10 <= pixelCount; i += 8)
+        {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3 + 12));
+            const __m256i source = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(rgba + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(source, shuffle), alpha));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyToRgbaSse2(const uint8_t* grey, uint8_t* rgba, size_t pixelCount)
+    {
+        const __m128i alpha = _mm_set1_epi8(-1);
+        size_t i = 0;
+        for (; i + 16 <= pixelCount; i += 16)
+        {
+            const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(grey + i));
+            const __m128i greyGreyLow = _mm_unpacklo_epi8(source, source);
+            const __m128i greyGreyHigh = _mm_unpackhi_epi8(source, source);
+            const __m128i greyAlphaLow = _mm_unpacklo_epi8(source, alpha);
+            const __m128i greyAlphaHigh = _mm_unpackhi_epi8(source, alpha);
+            __m128i* const destination = reinterpret_cast<__m128i*>(rgba + i * 4);
+            _mm_storeu_si128(destination + 0, _mm_unpacklo_epi16(greyGreyLow, greyAlphaLow));
+            _mm_storeu_si128(destination + 1, _mm_unpackhi_epi16(greyGreyLow, greyAlphaLow));
+            _mm_storeu_si128(destination + 2, _mm_unpacklo_epi16(greyGreyHigh, greyAlphaHigh));
+            _mm_storeu_si128(destination + 3, _mm_unpackhi_epi16(greyGreyHigh, greyAlphaHigh));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyToRgbaAvx2(const uint8_t* grey, uint8_t* rgba, size_t pixelCount)
+    {
+        // The unpacks work within 128-bit lanes, so the lanes of the results are regrouped in pixel order when stored.
+        const __m256i alpha = _mm256_set1_epi8(-1);
+        size_t i = 0;
+        for (; i + 32 <= pixelCount; i += 32)
+        {
+            const __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(grey + i));
+            const __m256i greyGreyLow = _mm256_unpacklo_epi8(source, source);
+            const __m256i greyGreyHigh = _mm256_unpackhi_epi8(source, source);
+            const __m256i greyAlphaLow = _mm256_unpacklo_epi8(source, alpha);
+            const __m256i greyAlphaHigh = _mm256_unpackhi_epi8(source, alpha);
+            const __m256i pixels0 = _mm256_unpacklo_epi16(greyGreyLow, greyAlphaLow);   // Pixels 0-3 and 16-19.
+            const __m256i pixels1 = _mm256_unpackhi_epi16(greyGreyLow, greyAlphaLow);   // Pixels 4-7 and 20-23.
+            const __m256i pixels2 = _mm256_unpacklo_epi16(greyGreyHigh, greyAlphaHigh); // Pixels 8-11 and 24-27.
+            const __m256i pixels3 = _mm256_unpackhi_epi16(greyGreyHigh, greyAlphaHigh); // Pixels 12-15 and 28-31.
+            __m256i* const destination = reinterpret_cast<__m256i*>(rgba + i * 4);
+            _mm256_storeu_si256(destination + 0, _mm256_permute2x128_si256(pixels0, pixels1, 0x20));
+            _mm256_storeu_si256(destination + 1, _mm256_permute2x128_si256(pixels2, pixels3, 0x20));
+            _mm256_storeu_si256(destination + 2, _mm256_permute2x128_si256(pixels0, pixels1, 0x31));
+            _mm256_storeu_si256(destination + 3, _mm256_permute2x128_si256(pixels2, pixels3, 0x31));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyAlphaToRgbaSse2(const uint8_t* greyAlpha, uint8_t* rgba, size_t pixelCount)
+    {
+        const __m128i greyMask = _mm_set1_epi16(0x00FF);
+        size_t i = 0;
+        for (; i + 8 <= pixelCount; i += 8)
+        {
+            const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(greyAlpha + i * 2));
+            const __m128i grey = _mm_and_si128(source, greyMask);
+            const __m128i greyGrey = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+            __m128i* const destination = reinterpret_cast<__m128i*>(rgba + i * 4);
+            _mm_storeu_si128(destination + 0, _mm_unpacklo_epi16(greyGrey, source));
+            _mm_storeu_si128(destination + 1, _mm_unpackhi_epi16(greyGrey, source));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyAlphaToRgbaAvx2(const uint8_t* greyAlpha, uint8_t* rgba, size_t pixelCount)
+    {
+        const __m256i greyMask = _mm256_set1_epi16(0x00FF);
+        size_t i = 0;
+        for (; i + 16 <= pixelCount; i += 16)
+        {
+            const __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(greyAlpha + i * 2));
+            const __m256i grey = _mm256_and_si256(source, greyMask);
+            const __m256i greyGrey = _mm256_or_si256(grey, _mm256_slli_epi16(grey, 8));
+            const __m256i pixels0 = _mm256_unpacklo_epi16(greyGrey, source); // Pixels 0-3 and 8-11.
+            const __m256i pixels1 = _mm256_unpackhi_epi16(greyGrey, source); // Pixels 4-7 and 12-15.
+            __m256i* const destination = reinterpret_cast<__m256i*>(rgba + i * 4);
+            _mm256_storeu_si256(destination + 0, _mm256_permute2x128_si256(pixels0, pixels1, 0x20));
+            _mm256_storeu_si256(destination + 1, _mm256_permute2x128_si256(pixels0, pixels1, 0x31));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyAlphaToGreySse2(const uint8_t* greyAlpha, uint8_t* grey, size_t pixelCount)
+    {
+        const __m128i greyMask = _mm_set1_epi16(0x00FF);
+        size_t i = 0;
+        for (; i + 16 <= pixelCount; i += 16)
+        {
+            const __m128i* const source = reinterpret_cast<const __m128i*>(greyAlpha + i * 2);
+            const __m128i low = _mm_and_si128(_mm_loadu_si128(source + 0), greyMask);
+            const __m128i high = _mm_and_si128(_mm_loadu_si128(source + 1), greyMask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(grey + i), _mm_packus_epi16(low, high));
+        }
+        return i;
+    }
+
+    size_t ConvertGreyAlphaToGreyAvx2(const uint8_t* greyAlpha, uint8_t* grey, size_t pixelCount)
+    {
+        // The pack interleaves the 128-bit lanes of its sources, which the permute puts back in pixel order.
+        const __m256i greyMask = _mm256_set1_epi16(0x00FF);
+        size_t i = 0;
+        for (; i + 32 <= pixelCount; i += 32)
+        {
+            const __m256i* const source = reinterpret_cast<const __m256i*>(greyAlpha + i * 2);
+            const __m256i low = _mm256_and_si256(_mm256_loadu_si256(source + 0), greyMask);
+            const __m256i high = _mm256_and_si256(_mm256_loadu_si256(source + 1), greyMask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(grey + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8));
+        }
+        return i;
+    }
+#endif
+}
+
+namespace GltfHelper
+{
+    void ConvertRgbToRgba(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount)
+    {
+        size_t i = 0;
+#ifdef PIXEL_CONVERSION_X86
+        if (GetCpuFeatures().Avx2)
+        {
+            i = ConvertRgbToRgbaAvx2(rgb, rgba, pixelCount);
+        }
+        else if (GetCpuFeatures().Ssse3)
+        {
+            i = ConvertRgbToRgbaSsse3(rgb, rgba, pixelCount);
+        }
+#endif
+        for (; i < pixelCount; i++)
+        {
+            rgba[i * 4 + 0] = rgb[i * 3 + 0];
+            rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    void ConvertGreyToRgba(const uint8_t* grey, uint8_t* rgba, size_t pixelCount)
+    {
+        size_t i = 0;
+#ifdef PIXEL_CONVERSION_X86
+        i = GetCpuFeatures().Avx2 ? ConvertGreyToRgbaAvx2(grey, rgba, pixelCount) : ConvertGreyToRgbaSse2(grey, rgba, pixelCount);
+#endif
+        for (; i < pixelCount; i++)
+        {
+            rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = grey[i];
+            rgba[i * 4 + 3] = 255;
+        }
+    }
+
+    void ConvertGreyAlphaToRgba(const uint8_t* greyAlpha, uint8_t* rgba, size_t pixelCount)
+    {
+        size_t i = 0;
+#ifdef PIXEL_CONVERSION_X86
+        i = GetCpuFeatures().Avx2 ? ConvertGreyAlphaToRgbaAvx2(greyAlpha, rgba, pixelCount)
+                                  : ConvertGreyAlphaToRgbaSse2(greyAlpha, rgba, pixelCount);
+#endif
+        for (; i < pixelCount; i++)
+        {
+            rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = greyAlpha[i * 2 + 0];
+            rgba[i * 4 + 3] = greyAlpha[i * 2 + 1];
+        }
+    }
+
+    void ConvertGreyAlphaToGrey(const uint8_t* greyAlpha, uint8_t* grey, size_t pixelCount)
+    {
+        size_t i = 0;
+#ifdef PIXEL_CONVERSION_X86
+        i = GetCpuFeatures().Avx2 ? ConvertGreyAlphaToGreyAvx2(greyAlpha, grey, pixelCount)
+                                  : ConvertGreyAlphaToGreySse2(greyAlpha, grey, pixelCount);
+#endif
+        for (; i < pixelCount; i++)
+        {
+            grey[i] = greyAlpha[i * 2];
+        }
+    }
+}
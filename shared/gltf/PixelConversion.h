@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+// Conversions between the 8-bit pixel layouts of decoded images and the layouts textures are created with.
+// On x86 and x64, the conversions use AVX2 or SSE when the processor supports them.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GltfHelper
+{
+    // Expands RGB pixels to RGBA with an opaque alpha.
+    void ConvertRgbToRgba(_In_reads_(pixelCount * 3) const uint8_t* rgb, _Out_writes_(pixelCount * 4) uint8_t* rgba, size_t pixelCount);
+
+    // Expands grey pixels to RGBA, with the grey value in each color channel and an opaque alpha.
+    void ConvertGreyToRgba(_In_reads_(pixelCount) const uint8_t* grey, _Out_writes_(pixelCount * 4) uint8_t* rgba, size_t pixelCount);
+
+    // Expands grey-alpha pixels to RGBA, with the grey value in each color channel.
+    void ConvertGreyAlphaToRgba(_In_reads_(pixelCount * 2) const uint8_t* greyAlpha,
+                                _Out_writes_(pixelCount * 4) uint8_t* rgba,
+                                size_t pixelCount);
+
+    // Drops the alpha channel of grey-alpha pixels.
+    void ConvertGreyAlphaToGrey(_In_reads_(pixelCount * 2) const uint8_t* greyAlpha,
+                                _Out_writes_(pixelCount) uint8_t* grey,
+                                size_t pixelCount);
+}
@@ -9,23 +9,403 @@
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include <tiny_gltf.h>
 #include "..\Gltf\GltfHelper.h"
+#include "..\Gltf\GltfSaxParser.h"
+#include "..\Gltf\PixelConversion.h"
 #include "GltfLoader.h"
+#include "GltfPreparedModel.h"
 #include "SampleShared/BgfxUtility.h"
+#include "SampleShared/FileUtility.h"
+#include "SampleShared/ScopeGuard.h"
+#include "SampleShared/TextureContainer.h"
+#include "SampleShared/ThreadPool.h"
+#include <SampleShared/meshoptimizer/src/meshoptimizer.h>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <set>
 using namespace DirectX;
+using Gltf::Internal::ImageFormat;
+using Gltf::Internal::PreparedImage;
+using Gltf::Internal::PreparedMaterial;
+using Gltf::Internal::PreparedSampler;
+using Gltf::Internal::TextureBinding;
 
 namespace {
-    // Create a DirectX texture view from a tinygltf Image.
-    bgfx::TextureHandle LoadImage(const tinygltf::Image& image, bool sRGB) {
-        // First convert the image to RGBA if it isn't already.
-        std::vector<uint8_t> tempBuffer;
-        const uint8_t* rgbaBuffer = GltfHelper::ReadImageAsRGBA(image, &tempBuffer);
-        if (rgbaBuffer == nullptr) {
+    // The GLB header is followed by the JSON chunk, and then by the optional binary chunk.
+    constexpr uint32_t GlbHeaderSize = 12;
+    constexpr uint32_t GlbChunkHeaderSize = 8;
+    constexpr uint32_t GlbMagic = 0x46546C67;           // "glTF"
+    constexpr uint32_t GlbVersion = 2;
+    constexpr uint32_t GlbJsonChunkType = 0x4E4F534A;   // "JSON"
+    constexpr uint32_t GlbBinaryChunkType = 0x004E4942; // "BIN"
+
+    // Locate the JSON chunk of GLB file content. Returns an empty chunk if the header is not valid, which tinygltf then reports.
+    std::string_view ReadGlbJsonChunk(_In_reads_bytes_(bufferBytes) const uint8_t* buffer, uint32_t bufferBytes) {
+        if (bufferBytes < GlbHeaderSize + GlbChunkHeaderSize) {
+            return {};
+        }
+
+        uint32_t magic, version, jsonChunkLength, jsonChunkType;
+        memcpy(&magic, buffer, sizeof(magic));
+        memcpy(&version, buffer + sizeof(magic), sizeof(version));
+        memcpy(&jsonChunkLength, buffer + GlbHeaderSize, sizeof(jsonChunkLength));
+        memcpy(&jsonChunkType, buffer + GlbHeaderSize + sizeof(jsonChunkLength), sizeof(jsonChunkType));
+        if (magic != GlbMagic || version != GlbVersion || jsonChunkType != GlbJsonChunkType ||
+            jsonChunkLength > bufferBytes - GlbHeaderSize - GlbChunkHeaderSize) {
+            return {};
+        }
+
+        return {reinterpret_cast<const char*>(buffer) + GlbHeaderSize + GlbChunkHeaderSize, jsonChunkLength};
+    }
+
+    // Locate the binary chunk of GLB file content, whose header has already been validated.
+    GltfHelper::BufferData ReadGlbBinaryChunk(_In_reads_bytes_(bufferBytes) const uint8_t* buffer, uint32_t bufferBytes) {
+        uint32_t jsonChunkLength;
+        memcpy(&jsonChunkLength, buffer + GlbHeaderSize, sizeof(jsonChunkLength));
+
+        const size_t binaryChunkOffset = (size_t)GlbHeaderSize + GlbChunkHeaderSize + jsonChunkLength;
+        if (binaryChunkOffset + GlbChunkHeaderSize > bufferBytes) {
+            return {}; // The binary chunk is optional.
+        }
+
+        uint32_t binaryChunkLength, binaryChunkType;
+        memcpy(&binaryChunkLength, buffer + binaryChunkOffset, sizeof(binaryChunkLength));
+        memcpy(&binaryChunkType, buffer + binaryChunkOffset + sizeof(binaryChunkLength), sizeof(binaryChunkType));
+        if (binaryChunkType != GlbBinaryChunkType || binaryChunkOffset + GlbChunkHeaderSize + binaryChunkLength > bufferBytes) {
+            throw std::exception("Invalid binary chunk in glTF binary.");
+        }
+
+        return {buffer + binaryChunkOffset + GlbChunkHeaderSize, binaryChunkLength};
+    }
+
+    // Run a function on the thread pool, or on the calling thread when there is no thread pool.
+    template <typename TFunction>
+    auto RunAsync(sample::ThreadPool* threadPool, TFunction&& function) {
+        std::packaged_task<std::invoke_result_t<TFunction>()> task(std::forward<TFunction>(function));
+        auto result = task.get_future();
+        if (threadPool != nullptr) {
+            threadPool->Submit(std::move(task));
+        } else {
+            task();
+        }
+        return result;
+    }
+
+    // How the materials use an image, and its MSFT_texture_dds alternative if any. An image used with several contents is filtered
+    // for the first one, which is rare enough.
+    struct ImageUsage {
+        const tinygltf::Image* Image;
+        const tinygltf::Image* DdsImage;
+        Pbr::TextureContent Content;
+        bool OcclusionOnly;
+        bool AlphaUsed;
+    };
+
+    // The prepared image format of the texture format of a DDS image, if a prepared image can hold it.
+    std::optional<ImageFormat> GetContainerImageFormat(bgfx::TextureFormat::Enum format) {
+        switch (format) {
+        case bgfx::TextureFormat::RGBA8:
+            return ImageFormat::RGBA8;
+        case bgfx::TextureFormat::R8:
+            return ImageFormat::R8;
+        case bgfx::TextureFormat::BC1:
+            return ImageFormat::BC1;
+        case bgfx::TextureFormat::BC2:
+            return ImageFormat::BC2;
+        case bgfx::TextureFormat::BC3:
+            return ImageFormat::BC3;
+        case bgfx::TextureFormat::BC4:
+            return ImageFormat::BC4;
+        case bgfx::TextureFormat::BC5:
+            return ImageFormat::BC5;
+        case bgfx::TextureFormat::BC6H:
+            return ImageFormat::BC6H;
+        case bgfx::TextureFormat::BC7:
+            return ImageFormat::BC7;
+        default:
+            return std::nullopt;
+        }
+    }
+
+    // Read the DDS image of MSFT_texture_dds, whose blocks and mips are kept as they are stored. The image is read in place when
+    // the buffer holding it has an owner which can outlive the preparation, which bgfx then reads it from, and is copied otherwise.
+    // Returns an image without data if it is not a single 2D texture in a format of prepared images, so that the fallback image is
+    // read instead.
+    PreparedImage ReadDdsImage(const tinygltf::Model& gltfModel,
+                               const GltfHelper::BufferData& binaryChunk,
+                               const tinygltf::Image& image,
+                               const std::shared_ptr<const void>& modelStorage,
+                               const std::shared_ptr<const void>& binaryChunkStorage) {
+        const GltfHelper::BufferData encodedImage = GltfHelper::ReadEncodedImage(gltfModel, image, binaryChunk);
+        if (encodedImage.Data == nullptr || !sample::IsTextureContainer(encodedImage.Data, encodedImage.Size)) {
+            return {};
+        }
+
+        sample::TextureContainer container;
+        try {
+            container = sample::ReadTextureContainer(encodedImage.Data, encodedImage.Size);
+        } catch (const std::exception&) {
+            return {};
+        }
+
+        const std::optional<ImageFormat> format = GetContainerImageFormat(container.Format);
+        if (!format || container.Depth > 1 || container.LayerCount > 1 || container.CubeMap || !container.IsContiguous()) {
+            return {};
+        }
+
+        PreparedImage preparedImage;
+        preparedImage.Width = (int)container.Width;
+        preparedImage.Height = (int)container.Height;
+        preparedImage.MipCount = container.MipCount;
+        preparedImage.Format = *format;
+
+        const uint8_t* pixels = container.Images.front().Data;
+        const size_t size = container.Images.back().Data + container.Images.back().Size - pixels;
+        if (size != preparedImage.GetSize()) {
+            return {};
+        }
+
+        const bool inBinaryChunk =
+            binaryChunk.Data != nullptr && pixels >= binaryChunk.Data && pixels < binaryChunk.Data + binaryChunk.Size;
+        const std::shared_ptr<const void>& storage = inBinaryChunk ? binaryChunkStorage : modelStorage;
+        if (storage) {
+            preparedImage.Storage = storage;
+        } else {
+            preparedImage.Pixels.assign(pixels, pixels + size);
+            pixels = preparedImage.Pixels.data();
+        }
+        preparedImage.Data = pixels;
+        return preparedImage;
+    }
+
+    // Convert a tinygltf Image to the layout of its texture: RGBA, or a single channel for grey images which are only used for
+    // occlusion. Images in a binary chunk which is read in place are decoded here. Pixels which tinygltf decoded in the layout
+    // of the texture are read from the glTF model, which modelStorage owns unless it is null.
+    PreparedImage ReadSourceImage(const tinygltf::Model& gltfModel,
+                                  const GltfHelper::BufferData& binaryChunk,
+                                  const tinygltf::Image& image,
+                                  bool occlusionOnly,
+                                  const std::shared_ptr<const void>& modelStorage) {
+        PreparedImage preparedImage;
+        const tinygltf::Image* decodedImage = &image;
+        tinygltf::Image lazilyDecodedImage;
+        if (image.image.empty() && image.bufferView != -1) {
+            if (!GltfHelper::DecodeImage(gltfModel, image, binaryChunk, &lazilyDecodedImage)) {
+                return preparedImage;
+            }
+            decodedImage = &lazilyDecodedImage;
+        }
+
+        std::vector<uint8_t> convertedPixels;
+        const uint8_t* pixels = occlusionOnly ? GltfHelper::ReadImageAsR8(*decodedImage, &convertedPixels) : nullptr;
+        if (pixels != nullptr) {
+            preparedImage.Format = ImageFormat::R8;
+        } else {
+            pixels = GltfHelper::ReadImageAsRGBA(*decodedImage, &convertedPixels);
+            if (pixels == nullptr) {
+                return preparedImage;
+            }
+        }
+
+        // Keep ownership of pixels which would otherwise be released with the local image. Moving a vector keeps its storage.
+        if (!convertedPixels.empty() && pixels == convertedPixels.data()) {
+            preparedImage.Pixels = std::move(convertedPixels);
+        } else if (decodedImage == &lazilyDecodedImage) {
+            preparedImage.Pixels = std::move(lazilyDecodedImage.image);
+        } else {
+            preparedImage.Storage = modelStorage;
+        }
+
+        preparedImage.Data = pixels;
+        preparedImage.Width = decodedImage->width;
+        preparedImage.Height = decodedImage->height;
+        return preparedImage;
+    }
+
+    // Read the image of a texture, preferring its MSFT_texture_dds image, followed by its mip chain when mipGeneration is set and
+    // the image has a single level of RGBA or single channel pixels. This does not touch bgfx, so it can run on any thread.
+    PreparedImage ReadImage(const tinygltf::Model& gltfModel,
+                            const GltfHelper::BufferData& binaryChunk,
+                            const ImageUsage& usage,
+                            const std::optional<Pbr::MipGenerationOptions>& mipGeneration,
+                            const std::shared_ptr<const void>& modelStorage,
+                            const std::shared_ptr<const void>& binaryChunkStorage) {
+        PreparedImage preparedImage;
+        if (usage.DdsImage != nullptr) {
+            preparedImage = ReadDdsImage(gltfModel, binaryChunk, *usage.DdsImage, modelStorage, binaryChunkStorage);
+        }
+        if (preparedImage.Data == nullptr && usage.Image != nullptr) {
+            preparedImage = ReadSourceImage(gltfModel, binaryChunk, *usage.Image, usage.OcclusionOnly, modelStorage);
+        }
+
+        const bool uncompressed = preparedImage.Format == ImageFormat::RGBA8 || preparedImage.Format == ImageFormat::R8;
+        if (mipGeneration && preparedImage.Data != nullptr && uncompressed && preparedImage.MipCount == 1 &&
+            (preparedImage.Width > 1 || preparedImage.Height > 1)) {
+            const uint32_t width = (uint32_t)preparedImage.Width;
+            const uint32_t height = (uint32_t)preparedImage.Height;
+            const uint32_t channelCount = preparedImage.Format == ImageFormat::R8 ? 1 : 4;
+            preparedImage.Pixels =
+                Pbr::GenerateMipChain(preparedImage.Data, channelCount, width, height, usage.Content, *mipGeneration);
+            preparedImage.Data = preparedImage.Pixels.data();
+            preparedImage.Storage.reset();
+            preparedImage.MipCount = Pbr::GetMipCount(width, height);
+        }
+        return preparedImage;
+    }
+
+    ImageFormat GetImageFormat(bgfx::TextureFormat::Enum blockFormat) {
+        switch (blockFormat) {
+        case bgfx::TextureFormat::BC1:
+            return ImageFormat::BC1;
+        case bgfx::TextureFormat::BC3:
+            return ImageFormat::BC3;
+        case bgfx::TextureFormat::BC4:
+            return ImageFormat::BC4;
+        case bgfx::TextureFormat::BC7:
+            return ImageFormat::BC7;
+        default:
+            throw std::exception("Unsupported block compressed image format.");
+        }
+    }
+
+    bgfx::TextureFormat::Enum GetBlockFormat(ImageFormat format) {
+        switch (format) {
+        case ImageFormat::BC1:
+            return bgfx::TextureFormat::BC1;
+        case ImageFormat::BC2:
+            return bgfx::TextureFormat::BC2;
+        case ImageFormat::BC3:
+            return bgfx::TextureFormat::BC3;
+        case ImageFormat::BC4:
+            return bgfx::TextureFormat::BC4;
+        case ImageFormat::BC5:
+            return bgfx::TextureFormat::BC5;
+        case ImageFormat::BC6H:
+            return bgfx::TextureFormat::BC6H;
+        case ImageFormat::BC7:
+            return bgfx::TextureFormat::BC7;
+        default:
+            throw std::exception("Image format is not block compressed.");
+        }
+    }
+
+    // An image being block compressed by tasks which each compress a band of rows of blocks.
+    struct PendingCompression {
+        size_t Image;
+        ImageFormat Format;
+        std::vector<uint8_t> Pixels;
+        std::vector<std::future<void>> BlockRows;
+    };
+
+    // Rows of 4x4 blocks compressed by each task, so that large images are spread over the worker threads.
+    constexpr uint32_t CompressionBlockRowsPerTask = 16;
+
+    // Start block compressing each mip level of an image, unless it failed to decode, is already block compressed, is smaller than
+    // the options allow, or its largest level does not divide into blocks. The pixels of the image must stay in place until the
+    // compression is complete.
+    void StartCompressingImage(const PreparedImage& image,
+                               size_t imageIndex,
+                               bool alphaUsed,
+                               const Pbr::TextureCompressionOptions& options,
+                               sample::ThreadPool* threadPool,
+                               std::vector<PendingCompression>& pendingCompressions) {
+        const size_t pixelCount = (size_t)image.Width * image.Height;
+        if (image.Data == nullptr || (image.Format != ImageFormat::RGBA8 && image.Format != ImageFormat::R8) ||
+            pixelCount < options.MinPixelCount || (image.Width % 4) != 0 || (image.Height % 4) != 0) {
+            return;
+        }
+
+        const uint32_t channelCount = image.Format == ImageFormat::R8 ? 1 : 4;
+        const bgfx::TextureFormat::Enum blockFormat = Pbr::ChooseBlockFormat(image.Data, channelCount, pixelCount, alphaUsed, options);
+
+        PreparedImage compressedImage;
+        compressedImage.Width = image.Width;
+        compressedImage.Height = image.Height;
+        compressedImage.MipCount = image.MipCount;
+        compressedImage.Format = GetImageFormat(blockFormat);
+
+        PendingCompression& compression = pendingCompressions.emplace_back();
+        compression.Image = imageIndex;
+        compression.Format = compressedImage.Format;
+        compression.Pixels.resize(compressedImage.GetSize());
+
+        const uint8_t* levelPixels = image.Data;
+        uint8_t* levelBlocks = compression.Pixels.data();
+        for (uint32_t level = 0; level < image.MipCount; level++) {
+            const uint32_t width = std::max(1, image.Width >> level);
+            const uint32_t height = std::max(1, image.Height >> level);
+            const uint32_t blockRowCount = (height + 3) / 4;
+            for (uint32_t firstBlockRow = 0; firstBlockRow < blockRowCount; firstBlockRow += CompressionBlockRowsPerTask) {
+                const uint32_t taskBlockRowCount = std::min(CompressionBlockRowsPerTask, blockRowCount - firstBlockRow);
+                const auto compressBlockRows = [=, &options] {
+                    Pbr::CompressBlockRows(
+                        levelPixels, channelCount, width, height, firstBlockRow, taskBlockRowCount, blockFormat, options, levelBlocks);
+                };
+                compression.BlockRows.push_back(RunAsync(threadPool, compressBlockRows));
+            }
+            levelPixels += image.GetLevelSize(level);
+            levelBlocks += compressedImage.GetLevelSize(level);
+        }
+    }
+
+    // Hash of the layout and pixels of an image, or zero if it failed to decode.
+    uint64_t HashImage(const PreparedImage& image) {
+        if (image.Data == nullptr) {
+            return 0;
+        }
+
+        const uint64_t layout[] = {(uint64_t)image.Width, (uint64_t)image.Height, image.MipCount, (uint64_t)image.Format};
+        const uint64_t seed = Gltf::TextureCache::HashContent(layout, sizeof(layout));
+        return Gltf::TextureCache::HashContent(image.Data, image.GetSize(), seed);
+    }
+
+    // Create a texture from a prepared image. Single channel images are linear, since they are only used for occlusion, and are
+    // expanded to RGBA if the renderer cannot sample R8 textures. Block compressed images are created as they are. Images with mips
+    // are created with all of their levels. Images read in place are given to bgfx by reference rather than copied.
+    bgfx::TextureHandle LoadImage(const PreparedImage& image, bool sRGB) {
+        if (image.Data == nullptr) {
             return {bgfx::kInvalidHandle};
         }
 
+        const bool hasMips = image.MipCount > 1;
+        if (image.Format != ImageFormat::RGBA8 && image.Format != ImageFormat::R8) {
+            const bgfx::TextureFormat::Enum blockFormat = GetBlockFormat(image.Format);
+            if ((bgfx::getCaps()->formats[blockFormat] & BGFX_CAPS_FORMAT_TEXTURE_2D) == 0) {
+                throw std::exception("The renderer does not support the block compressed format of an image.");
+            }
+            return Pbr::Texture::CreateTexture(
+                image.Data, (uint32_t)image.GetSize(), image.Width, image.Height, blockFormat, hasMips, image.Storage);
+        }
+
+        if (image.Format == ImageFormat::R8) {
+            if ((bgfx::getCaps()->formats[bgfx::TextureFormat::R8] & BGFX_CAPS_FORMAT_TEXTURE_2D) != 0) {
+                return Pbr::Texture::CreateTexture(image.Data,
+                                                   (uint32_t)image.GetSize(),
+                                                   image.Width,
+                                                   image.Height,
+                                                   sample::bg::DxgiFormatToBgfxFormat(DXGI_FORMAT_R8_UNORM),
+                                                   hasMips,
+                                                   image.Storage);
+            }
+
+            std::vector<uint8_t> rgba(image.GetSize() * 4);
+            GltfHelper::ConvertGreyToRgba(image.Data, rgba.data(), image.GetSize());
+            return Pbr::Texture::CreateTexture(rgba.data(),
+                                               (uint32_t)rgba.size(),
+                                               image.Width,
+                                               image.Height,
+                                               sample::bg::DxgiFormatToBgfxFormat(DXGI_FORMAT_R8G8B8A8_UNORM),
+                                               hasMips);
+        }
+
         const DXGI_FORMAT format = sRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
-        return Pbr::Texture::CreateTexture(
-            rgbaBuffer, image.width * image.height * 4, image.width, image.height, sample::bg::DxgiFormatToBgfxFormat(format));
+        return Pbr::Texture::CreateTexture(image.Data,
+                                           (uint32_t)image.GetSize(),
+                                           image.Width,
+                                           image.Height,
+                                           sample::bg::DxgiFormatToBgfxFormat(format),
+                                           hasMips,
+                                           image.Storage);
     }
 
     D3D11_FILTER ConvertFilter(int glMinFilter, int glMagFilter) {
@@ -64,21 +444,21 @@ namespace {
         return filter;
     }
 
-    // Create a Bgfx sampler state from a tinygltf Sampler.
-    bgfx::UniformHandle CreateSampler(const char* _name, const tinygltf::Model& gltfModel, const tinygltf::Sampler& sampler) {
+    // Create a Bgfx sampler state from a glTF sampler.
+    bgfx::UniformHandle CreateSampler(const char* _name, const PreparedSampler& sampler) {
         // Seyi NOTE: I should be giving all this information to the texture being created
 
         /*D3D11_SAMPLER_DESC samplerDesc{};
 
-        samplerDesc.Filter = ConvertFilter(sampler.minFilter, sampler.magFilter);
+        samplerDesc.Filter = ConvertFilter(sampler.MinFilter, sampler.MagFilter);
         samplerDesc.AddressU =
-            sampler.wrapS == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE
+            sampler.WrapS == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE
                 ? D3D11_TEXTURE_ADDRESS_CLAMP
-                : sampler.wrapS == TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT ? D3D11_TEXTURE_ADDRESS_MIRROR : D3D11_TEXTURE_ADDRESS_WRAP;
+                : sampler.WrapS == TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT ? D3D11_TEXTURE_ADDRESS_MIRROR : D3D11_TEXTURE_ADDRESS_WRAP;
         samplerDesc.AddressV =
-            sampler.wrapT == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE
+            sampler.WrapT == TINYGLTF_TEXTURE_WRAP_CLAMP_TO_EDGE
                 ? D3D11_TEXTURE_ADDRESS_CLAMP
-                : sampler.wrapT == TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT ? D3D11_TEXTURE_ADDRESS_MIRROR : D3D11_TEXTURE_ADDRESS_WRAP;
+                : sampler.WrapT == TINYGLTF_TEXTURE_WRAP_MIRRORED_REPEAT ? D3D11_TEXTURE_ADDRESS_MIRROR : D3D11_TEXTURE_ADDRESS_WRAP;
         samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
         samplerDesc.MaxAnisotropy = 1;
         samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
@@ -95,12 +475,120 @@ namespace {
     // which node it corresponds to any appropriate node transformation be happen in the shader.
     using PrimitiveBuilderMap = std::map<int, Pbr::PrimitiveBuilder>;
 
-    // Load a glTF node from the tinygltf object model. This will process the node's mesh (if specified) and then recursively load the child
-    // nodes too.
+    // Whether the positions of a primitive are integers quantized with KHR_mesh_quantization.
+    bool HasQuantizedPositions(const tinygltf::Model& gltfModel, const tinygltf::Primitive& gltfPrimitive) {
+        const auto position = gltfPrimitive.attributes.find("POSITION");
+        return position != gltfPrimitive.attributes.end() &&
+               gltfModel.accessors.at(position->second).componentType != TINYGLTF_COMPONENT_TYPE_FLOAT;
+    }
+
+    // The buffer views read by the accessors of primitives which are compressed with EXT_meshopt_compression, in index order.
+    std::vector<int> FindCompressedBufferViews(const tinygltf::Model& gltfModel) {
+        std::set<int> bufferViews;
+        const auto addAccessor = [&](int accessorIndex) {
+            if (accessorIndex == -1) {
+                return;
+            }
+            const int bufferViewIndex = gltfModel.accessors.at(accessorIndex).bufferView;
+            if (bufferViewIndex != -1 && gltfModel.bufferViews.at(bufferViewIndex).extensions.count("EXT_meshopt_compression") > 0) {
+                bufferViews.insert(bufferViewIndex);
+            }
+        };
+
+        for (const tinygltf::Mesh& gltfMesh : gltfModel.meshes) {
+            for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+                for (const auto& attribute : gltfPrimitive.attributes) {
+                    addAccessor(attribute.second);
+                }
+                addAccessor(gltfPrimitive.indices);
+            }
+        }
+        return {bufferViews.begin(), bufferViews.end()};
+    }
+
+    // Decode a buffer view compressed with EXT_meshopt_compression, and undo the filter its attributes were encoded with. The
+    // decoded contents have the size and layout of the uncompressed buffer view. meshoptimizer only asserts on the parameters it
+    // is given, so they are validated first.
+    std::vector<uint8_t> DecodeBufferView(const tinygltf::Model& gltfModel,
+                                          const GltfHelper::BufferData& binaryChunk,
+                                          int bufferViewIndex) {
+        const tinygltf::BufferView& bufferView = gltfModel.bufferViews.at(bufferViewIndex);
+        const tinygltf::Value& extension = bufferView.extensions.at("EXT_meshopt_compression");
+        const auto readSize = [&extension](const char* name) {
+            return extension.Has(name) ? (size_t)extension.Get(name).GetNumberAsDouble() : 0;
+        };
+        const auto readString = [&extension](const char* name, const char* defaultValue) {
+            return extension.Has(name) ? extension.Get(name).Get<std::string>() : std::string(defaultValue);
+        };
+        const int bufferIndex = extension.Has("buffer") ? extension.Get("buffer").GetNumberAsInt() : -1;
+        const size_t byteOffset = readSize("byteOffset");
+        const size_t byteLength = readSize("byteLength");
+        const size_t byteStride = readSize("byteStride");
+        const size_t count = readSize("count");
+        const std::string mode = readString("mode", "");
+        const std::string filter = readString("filter", "NONE");
+
+        if (bufferIndex < 0 || (size_t)bufferIndex >= gltfModel.buffers.size()) {
+            throw std::exception("Compressed bufferview specifies an invalid buffer.");
+        }
+        const GltfHelper::BufferData buffer = GltfHelper::ReadBuffer(gltfModel, bufferIndex, binaryChunk);
+        if (byteOffset + byteLength > buffer.Size) {
+            throw std::out_of_range("Compressed bufferview goes out of range of buffer.");
+        }
+        if (count * byteStride != bufferView.byteLength) {
+            throw std::exception("Compressed bufferview does not decode to the length of the bufferview.");
+        }
+
+        std::vector<uint8_t> decoded(count * byteStride);
+        const uint8_t* const source = buffer.Data + byteOffset;
+        int result;
+        if (mode == "ATTRIBUTES") {
+            const bool validFilter = filter == "NONE" || (filter == "OCTAHEDRAL" && (byteStride == 4 || byteStride == 8)) ||
+                                     (filter == "QUATERNION" && byteStride == 8) || filter == "EXPONENTIAL";
+            if (byteStride == 0 || byteStride > 256 || byteStride % 4 != 0 || !validFilter) {
+                throw std::exception("Compressed bufferview specifies an invalid byteStride or filter for attributes.");
+            }
+            result = meshopt_decodeVertexBuffer(decoded.data(), count, byteStride, source, byteLength);
+            if (result == 0 && filter == "OCTAHEDRAL") {
+                meshopt_decodeFilterOct(decoded.data(), count, byteStride);
+            } else if (result == 0 && filter == "QUATERNION") {
+                meshopt_decodeFilterQuat(decoded.data(), count, byteStride);
+            } else if (result == 0 && filter == "EXPONENTIAL") {
+                meshopt_decodeFilterExp(decoded.data(), count, byteStride);
+            }
+        } else if (mode == "TRIANGLES" || mode == "INDICES") {
+            if ((byteStride != 2 && byteStride != 4) || filter != "NONE" || (mode == "TRIANGLES" && count % 3 != 0)) {
+                throw std::exception("Compressed bufferview specifies an invalid byteStride, filter or count for indices.");
+            }
+            result = mode == "TRIANGLES" ? meshopt_decodeIndexBuffer(decoded.data(), count, byteStride, source, byteLength)
+                                         : meshopt_decodeIndexSequence(decoded.data(), count, byteStride, source, byteLength);
+        } else {
+            throw std::exception("Compressed bufferview specifies an unsupported mode.");
+        }
+
+        if (result != 0) {
+            throw std::exception("Failed to decode bufferview compressed with EXT_meshopt_compression.");
+        }
+        return decoded;
+    }
+
+    // A glTF primitive being read, possibly on another thread, the material it is merged by and the node whose morph weights
+    // blend its morph targets, if it has any.
+    struct PendingPrimitive {
+        int Material;
+        Pbr::NodeIndex_t Node;
+        std::future<GltfHelper::Primitive> Primitive;
+    };
+
+    // Load a glTF node from the tinygltf object model. This adds the node to the Pbr Model, starts reading the node's mesh
+    // (if specified) and then recursively loads the child nodes too. The primitives are queued in traversal order.
     void XM_CALLCONV LoadNode(Pbr::NodeIndex_t parentNodeIndex,
                               const tinygltf::Model& gltfModel,
+                              const GltfHelper::BufferData& binaryChunk,
+                              const GltfHelper::DecodedBufferViews& decodedBufferViews,
                               int nodeId,
-                              PrimitiveBuilderMap& primitiveBuilderMap,
+                              const LoadOptions& options,
+                              std::vector<PendingPrimitive>& pendingPrimitives,
                               Pbr::Model& model) {
         const tinygltf::Node& gltfNode = gltfModel.nodes.at(nodeId);
 
@@ -110,192 +598,835 @@ namespace {
 
         if (gltfNode.mesh != -1) // Load the node's optional mesh when specified.
         {
-            // A glTF mesh is composed of primitives.
+            // Positions quantized with KHR_mesh_quantization are dequantized by the transform of their node, which the Pbr::Node
+            // carries. Primitives are merged by material and drawn in model space though, so that transform is applied to the
+            // vertices of such primitives as they are read.
+            XMFLOAT4X4 nodeToRoot;
+            XMStoreFloat4x4(&nodeToRoot, model.GetNodeToModelRootTransform(transformIndex));
+
+            // A glTF mesh is composed of primitives. Reading a primitive includes generating any missing normals and tangents,
+            // which is the bulk of the loading work, so each primitive is read concurrently.
             const tinygltf::Mesh& gltfMesh = gltfModel.meshes.at(gltfNode.mesh);
-            for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
-                // Read the primitive data from the glTF buffers.
-                const GltfHelper::Primitive primitive = GltfHelper::ReadPrimitive(gltfModel, gltfPrimitive);
-
-                // Insert or append the primitive into the PBR primitive builder. Primitives which use the same
-                // material are appended to reduce the number of draw calls.
-                Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderMap[gltfPrimitive.material];
-
-                // Use the starting offset for vertices and indices since multiple glTF primitives can
-                // be put into the same primitive builder.
-                const uint32_t startVertex = (uint32_t)primitiveBuilder.Vertices.size();
-                const uint32_t startIndex = (uint32_t)primitiveBuilder.Indices.size();
-
-                // Convert the GltfHelper vertices into the PBR vertex format.
-                primitiveBuilder.Vertices.resize(startVertex + primitive.Vertices.size());
-                for (size_t i = 0; i < primitive.Vertices.size(); i++) {
-                    const GltfHelper::Vertex& vertex = primitive.Vertices[i];
-                    Pbr::Vertex vert; // used to be pbrVertex
-
-                    //pbrVertex.Position = vertex.Position;
-                    //pbrVertex.Normal = vertex.Normal;
-                    //pbrVertex.Tangent = vertex.Tangent;
-                    //pbrVertex.Color0 = vertex.Color0;
-                    //pbrVertex.TexCoord0 = vertex.TexCoord0;
-                    memcpy(vert.Position, &(vertex.Position), sizeof(vert.Position));
-                    memcpy(vert.Normal, &(vertex.Normal), sizeof(vert.Normal));
-                    memcpy(vert.Tangent, &(vertex.Tangent), sizeof(vert.Tangent));
-                    memcpy(vert.TexCoord0, &(vertex.TexCoord0), sizeof(vert.TexCoord0));
-                    memcpy(vert.Color0, &(vertex.Color0), sizeof(vert.Color0));
-                    //pbrVertex.ModelTransformIndex = transformIndex;
-
-                    primitiveBuilder.Vertices[i + startVertex] = vert;
-                }
 
-                // Insert indicies with reverse winding order.
-                primitiveBuilder.Indices.resize(startIndex + primitive.Indices.size());
-                for (size_t i = 0; i < primitive.Indices.size(); i += 3) {
-                    primitiveBuilder.Indices[startIndex + i + 0] = startVertex + primitive.Indices[i + 0];
-                    primitiveBuilder.Indices[startIndex + i + 1] = startVertex + primitive.Indices[i + 2];
-                    primitiveBuilder.Indices[startIndex + i + 2] = startVertex + primitive.Indices[i + 1];
-                }
+            // The morph targets of the mesh are blended with the weights of the node, which default to those of the mesh.
+            const std::vector<double>& weights = gltfNode.weights.empty() ? gltfMesh.weights : gltfNode.weights;
+            if (!weights.empty()) {
+                model.GetNode(transformIndex).SetMorphWeights(std::vector<float>(weights.begin(), weights.end()));
+            }
+
+            for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+                const bool dequantize = HasQuantizedPositions(gltfModel, gltfPrimitive);
+                auto readPrimitive = [&gltfModel, &binaryChunk, &decodedBufferViews, &gltfPrimitive, &options, dequantize, nodeToRoot] {
+                    GltfHelper::Primitive primitive =
+                        GltfHelper::ReadPrimitive(gltfModel, gltfPrimitive, binaryChunk, options.Tangents, decodedBufferViews);
+                    if (dequantize) {
+                        GltfHelper::TransformPrimitive(primitive, XMLoadFloat4x4(&nodeToRoot));
+                    }
+                    return primitive;
+                };
+                pendingPrimitives.push_back(
+                    {gltfPrimitive.material, transformIndex, RunAsync(options.ThreadPool, std::move(readPrimitive))});
             }
         }
 
         // Recursively load all children.
         for (const int childNodeId : gltfNode.children) {
-            LoadNode(transformIndex, gltfModel, childNodeId, primitiveBuilderMap, model);
+            LoadNode(transformIndex, gltfModel, binaryChunk, decodedBufferViews, childNodeId, options, pendingPrimitives, model);
         }
     }
+
+    static_assert(sizeof(GltfHelper::Vertex) == sizeof(Pbr::Vertex) &&
+                      offsetof(GltfHelper::Vertex, Normal) == offsetof(Pbr::Vertex, Normal) &&
+                      offsetof(GltfHelper::Vertex, Tangent) == offsetof(Pbr::Vertex, Tangent) &&
+                      offsetof(GltfHelper::Vertex, Color0) == offsetof(Pbr::Vertex, Color0) &&
+                      offsetof(GltfHelper::Vertex, TexCoord0) == offsetof(Pbr::Vertex, TexCoord0),
+                  "GltfHelper vertices must have the layout of PBR vertices.");
+
+    // Insert or append a primitive read from the glTF buffers into the PBR primitive builder.
+    void AppendPrimitive(const GltfHelper::Primitive& primitive, Pbr::PrimitiveBuilder& primitiveBuilder) {
+        // Use the starting offset for vertices and indices since multiple glTF primitives can
+        // be put into the same primitive builder.
+        const uint32_t startVertex = (uint32_t)primitiveBuilder.Vertices.size();
+        const uint32_t startIndex = (uint32_t)primitiveBuilder.Indices.size();
+
+        // The GltfHelper vertices are laid out like the PBR vertices, so they are copied as a whole.
+        primitiveBuilder.Vertices.resize(startVertex + primitive.Vertices.size());
+        if (!primitive.Vertices.empty()) {
+            memcpy(&primitiveBuilder.Vertices[startVertex], primitive.Vertices.data(), primitive.Vertices.size() * sizeof(Pbr::Vertex));
+        }
+
+        // Insert indicies with reverse winding order.
+        primitiveBuilder.Indices.resize(startIndex + primitive.Indices.size());
+        for (size_t i = 0; i < primitive.Indices.size(); i += 3) {
+            primitiveBuilder.Indices[startIndex + i + 0] = startVertex + primitive.Indices[i + 0];
+            primitiveBuilder.Indices[startIndex + i + 1] = startVertex + primitive.Indices[i + 2];
+            primitiveBuilder.Indices[startIndex + i + 2] = startVertex + primitive.Indices[i + 1];
+        }
+    }
+
+    // Move the morph targets of a primitive read from the glTF buffers into the PBR primitive builder it was appended to alone.
+    void AppendMorphTargets(std::vector<GltfHelper::MorphTarget>&& targets,
+                            Pbr::NodeIndex_t morphNode,
+                            Pbr::PrimitiveBuilder& primitiveBuilder) {
+        primitiveBuilder.MorphNode = morphNode;
+        primitiveBuilder.MorphTargets.reserve(targets.size());
+        for (GltfHelper::MorphTarget& target : targets) {
+            primitiveBuilder.MorphTargets.push_back({std::move(target.Vertices),
+                                                     std::move(target.PositionDeltas),
+                                                     std::move(target.NormalDeltas),
+                                                     std::move(target.TangentDeltas)});
+        }
+    }
+
+    // Split, optimize and simplify a merged primitive as configured by the load options. This does not touch bgfx,
+    // so it can run on any thread.
+    std::vector<Pbr::PrimitiveBuilder> ProcessPrimitiveBuilder(Pbr::PrimitiveBuilder&& mergedPrimitiveBuilder,
+                                                               const Gltf::LoadOptions& options) {
+        // Merged primitives with too many vertices for 16-bit indices become several primitives sharing the material.
+        std::vector<Pbr::PrimitiveBuilder> primitiveBuilders;
+        if (options.SplitForIndex16) {
+            primitiveBuilders = Pbr::SplitForIndex16(std::move(mergedPrimitiveBuilder));
+        } else {
+            primitiveBuilders.push_back(std::move(mergedPrimitiveBuilder));
+        }
+
+        for (Pbr::PrimitiveBuilder& primitiveBuilder : primitiveBuilders) {
+            // Primitives sharing a material are merged by now, so the whole draw is optimized at once.
+            if (options.MeshOptimization) {
+                const std::optional<Pbr::MeshOptimizationReport> report =
+                    Pbr::OptimizeMesh(primitiveBuilder, options.MeshOptimization.value());
+                if (report) {
+                    sample::Trace(L"Optimized primitive with {} triangles: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                                  primitiveBuilder.Indices.size() / 3,
+                                  report->Before.Acmr,
+                                  report->After.Acmr,
+                                  report->Before.Atvr,
+                                  report->After.Atvr);
+                }
+            }
+
+            // Simplified levels of detail share the vertex buffer and are appended to the index buffer.
+            if (options.LodGeneration) {
+                Pbr::GenerateLods(primitiveBuilder, options.LodGeneration.value());
+            }
+
+            // Meshlets reorder the triangles of the full resolution level, which is the only level they are culled for.
+            if (options.MeshletGeneration) {
+                Pbr::BuildMeshlets(primitiveBuilder, options.MeshletGeneration.value());
+            }
+        }
+
+        return primitiveBuilders;
+    }
+
+    // CPU memory of the buffers and decoded images of a tinygltf model. Buffers which reference a GLB binary chunk are empty.
+    size_t GetSourceBytes(const tinygltf::Model& gltfModel) {
+        size_t bytes = 0;
+        for (const tinygltf::Buffer& buffer : gltfModel.buffers) {
+            bytes += buffer.data.size();
+        }
+        for (const tinygltf::Image& image : gltfModel.images) {
+            bytes += image.image.size();
+        }
+        return bytes;
+    }
+
+    // CPU memory of the arrays of a primitive read from glTF.
+    size_t GetPrimitiveBytes(const GltfHelper::Primitive& primitive) {
+        size_t bytes = primitive.Vertices.size() * sizeof(GltfHelper::Vertex) + primitive.Indices.size() * sizeof(uint32_t);
+        for (const GltfHelper::MorphTarget& target : primitive.Targets) {
+            const size_t deltaCount = target.PositionDeltas.size() + target.NormalDeltas.size() + target.TangentDeltas.size();
+            bytes += target.Vertices.size() * sizeof(uint32_t) + deltaCount * sizeof(XMFLOAT3);
+        }
+        return bytes;
+    }
+
+    // Size of the vertex and index buffers created for a primitive builder.
+    size_t GetUploadBytes(const Pbr::PrimitiveBuilder& primitiveBuilder, Pbr::VertexFormat vertexFormat) {
+        const bool compact = vertexFormat == Pbr::VertexFormat::Compact && primitiveBuilder.MorphTargets.empty();
+        const size_t vertexSize = compact ? sizeof(Pbr::CompactVertex) : sizeof(Pbr::Vertex);
+        const size_t indexSize = primitiveBuilder.Vertices.size() <= Pbr::MaxIndex16VertexCount ? sizeof(uint16_t) : sizeof(uint32_t);
+        return primitiveBuilder.Vertices.size() * vertexSize + primitiveBuilder.Indices.size() * indexSize;
+    }
 } // namespace
 
 namespace Gltf {
-    std::shared_ptr<Pbr::Model> FromGltfObject(const Pbr::Resources& pbrResources, const tinygltf::Model& gltfModel) {
+    void PreparedModel::Impl::CreateMaterials(const Pbr::Resources& pbrResources) {
+        std::map<int32_t, shared_bgfx_handle<bgfx::UniformHandle>> samplerMap;
+        ImageBindingCounts.assign(Images.size(), 0);
+
+        // PrimitiveBuilders is grouped by material. Loop through the referenced materials and load their resources. This will only
+        // load materials which are used by the active scene.
+        for (const auto& primitiveBuilderPair : PrimitiveBuilders) {
+            std::shared_ptr<Pbr::Material> pbrMaterial;
+
+            const int materialIndex = primitiveBuilderPair.first;
+            if (materialIndex == -1) // No material was referenced. Make up a material for it.
+            {
+                // Default material is a grey material, 50% roughness, non-metallic.
+                pbrMaterial = Pbr::Material::CreateFlat(pbrResources, {0.5f, 0.5f, 0.5f, 0.5f}, 0.5f);
+            } else {
+                const PreparedMaterial& material = Materials.at(materialIndex);
+                pbrMaterial = std::make_shared<Pbr::Material>(pbrResources);
+
+                // Set the default color of a texture slot, and queue the tinygltf texture and sampler to replace it if there is one.
+                auto loadTexture = [&](const char* _name,
+                                       Pbr::ShaderSlots::PSMaterial slot,
+                                       const PreparedMaterial::Texture& texture,
+                                       bool sRGB,
+                                       Pbr::RGBAColor defaultRGBA) {
+                    // Find or create the sampler referenced by the texture.
+                    shared_bgfx_handle<bgfx::UniformHandle> samplerState = samplerMap[texture.Sampler];
+
+                    if (!samplerState) // If not cached, create the sampler and store it in the sampler cache.
+                    {
+                        samplerState.reset(texture.Sampler != -1 ? CreateSampler(_name, Samplers.at(texture.Sampler))
+                                                                 : Pbr::Texture::CreateSampler(_name));
+                        samplerMap[texture.Sampler] = samplerState;
+                    }
+
+                    // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
+                    // mipmapping), resize to power-of-two.
+                    pbrMaterial->SetTexture(slot, pbrResources.CreateSolidColorTexture(defaultRGBA), samplerState);
+                    if (texture.Image != -1) {
+                        TextureBindings.push_back({pbrMaterial, slot, texture.Image, sRGB, samplerState});
+                        ImageBindingCounts.at(texture.Image)++;
+                    }
+                };
+
+                pbrMaterial->Name = material.Name;
+
+                loadTexture(
+                    "u_baseColorTexture", Pbr::ShaderSlots::BaseColor, material.BaseColorTexture, true /* sRGB */, Pbr::RGBA::White);
+                loadTexture("u_metallicRoughnessTexture",
+                            Pbr::ShaderSlots::MetallicRoughness,
+                            material.MetallicRoughnessTexture,
+                            false /* sRGB */,
+                            Pbr::RGBA::White);
+                loadTexture("u_emissiveTexture", Pbr::ShaderSlots::Emissive, material.EmissiveTexture, true /* sRGB */, Pbr::RGBA::White);
+                loadTexture(
+                    "u_normalTexture", Pbr::ShaderSlots::Normal, material.NormalTexture, false /* sRGB */, Pbr::RGBA::FlatNormal);
+                loadTexture(
+                    "u_occlusionTexture", Pbr::ShaderSlots::Occlusion, material.OcclusionTexture, false /* sRGB */, Pbr::RGBA::White);
+
+                pbrMaterial->SetDoubleSided(material.DoubleSided);
+                pbrMaterial->SetAlphaBlended(material.AlphaMode == GltfHelper::AlphaMode::Blend);
+
+                Pbr::Material::ConstantBufferData& parameters = pbrMaterial->Parameters();
+                parameters.BaseColorFactor = material.BaseColorFactor;
+                parameters.MetallicFactor = material.MetallicFactor;
+                parameters.RoughnessFactor = material.RoughnessFactor;
+                parameters.EmissiveFactor = material.EmissiveFactor;
+                parameters.OcclusionStrength = material.OcclusionStrength;
+                parameters.NormalScale = material.NormalScale;
+                parameters.AlphaCutoff =
+                    material.AlphaMode == GltfHelper::AlphaMode::Mask ? material.AlphaCutoff : std::numeric_limits<float>::lowest();
+            }
+
+            MaterialMap.insert(std::make_pair(materialIndex, std::move(pbrMaterial)));
+        }
+
+        MaterialsCreated = true;
+    }
+
+    void PreparedModel::Impl::CreateProxy(const Pbr::Resources& pbrResources) {
+        const XMVECTOR boundsMin = XMLoadFloat3(&BoundsMin);
+        const XMVECTOR boundsMax = XMLoadFloat3(&BoundsMax);
+        XMFLOAT3 sideLengths;
+        XMStoreFloat3(&sideLengths, XMVectorSubtract(boundsMax, boundsMin));
+
+        Pbr::PrimitiveBuilder proxyBuilder;
+        proxyBuilder.AddCube(sideLengths, XMVectorScale(XMVectorAdd(boundsMin, boundsMax), 0.5f));
+        std::shared_ptr<Pbr::Material> proxyMaterial = Pbr::Material::CreateFlat(pbrResources, {0.5f, 0.5f, 0.5f, 0.25f});
+        proxyMaterial->SetAlphaBlended(true);
+        Model->AddPrimitive(Pbr::Primitive(pbrResources,
+                                           proxyBuilder,
+                                           std::move(proxyMaterial),
+                                           false /* updatableBuffers */,
+                                           VertexFormat));
+    }
+
+    void PreparedModel::Impl::RecordMemory() {
+        Memory.HighWaterBytes = std::max(Memory.HighWaterBytes, Memory.SourceBytes + Memory.GeometryBytes + Memory.ImageBytes);
+    }
+
+    void PreparedModel::Impl::ReleaseImage(int32_t image) {
+        Memory.ImageBytes -= Images[image].Pixels.size();
+        Images[image] = {};
+        ReleaseUnreferencedSources();
+    }
+
+    void PreparedModel::Impl::ReleaseUnreferencedSources() {
+        for (auto it = SourceSizes.begin(); it != SourceSizes.end();) {
+            const void* storage = it->first;
+            const auto readsStorage = [storage](const PreparedImage& image) { return image.Storage.get() == storage; };
+            if (std::any_of(Images.begin(), Images.end(), readsStorage)) {
+                ++it;
+            } else {
+                Memory.SourceBytes -= it->second;
+                it = SourceSizes.erase(it);
+            }
+        }
+    }
+
+    PreparedModel::PreparedModel(std::unique_ptr<Impl> impl)
+        : m_impl(std::move(impl)) {
+    }
+
+    PreparedModel::~PreparedModel() = default;
+
+    const std::shared_ptr<Pbr::Model>& PreparedModel::GetModel() const {
+        return m_impl->Model;
+    }
+
+    PreparedModel::Stage PreparedModel::GetStage() const {
+        return m_impl->CurrentStage;
+    }
+
+    LoadMemoryReport PreparedModel::GetMemoryReport() const {
+        return m_impl->Memory;
+    }
+
+    size_t PreparedModel::Upload(const Pbr::Resources& pbrResources, size_t byteBudget) {
+        Impl& impl = *m_impl;
+        size_t uploadedBytes = 0;
+        const auto fitsBudget = [&](size_t bytes) { return uploadedBytes == 0 || uploadedBytes + bytes <= byteBudget; };
+
+        if (!impl.MaterialsCreated) {
+            impl.CreateMaterials(pbrResources);
+
+            size_t geometryBytes = 0;
+            for (const auto& primitiveBuilderPair : impl.PrimitiveBuilders) {
+                for (const Pbr::PrimitiveBuilder& primitiveBuilder : primitiveBuilderPair.second) {
+                    geometryBytes += GetUploadBytes(primitiveBuilder, impl.VertexFormat);
+                }
+            }
+            if (geometryBytes > byteBudget) {
+                impl.CreateProxy(pbrResources);
+            }
+        }
+
+        // Convert the primitive builders into primitives with their respective material, in material order.
+        while (impl.CurrentStage == Stage::Geometry) {
+            if (impl.NextMaterialGroup == impl.PrimitiveBuilders.size()) {
+                // Swap the proxy for all of the primitives at once, so that a partially created model is never shown.
+                impl.Model->Clear();
+                for (Pbr::Primitive& primitive : impl.Primitives) {
+                    impl.Model->AddPrimitive(std::move(primitive));
+                }
+                impl.Primitives.clear();
+                impl.PrimitiveBuilders.clear();
+                impl.CurrentStage = Stage::Textures;
+                break;
+            }
+
+            auto& primitiveBuilderPair = impl.PrimitiveBuilders[impl.NextMaterialGroup];
+            if (impl.NextPrimitiveBuilder == primitiveBuilderPair.second.size()) {
+                impl.NextMaterialGroup++;
+                impl.NextPrimitiveBuilder = 0;
+                continue;
+            }
+
+            Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderPair.second[impl.NextPrimitiveBuilder];
+            const size_t bytes = GetUploadBytes(primitiveBuilder, impl.VertexFormat);
+            if (!fitsBudget(bytes)) {
+                return uploadedBytes;
+            }
+
+            // The vertices and indices are given to bgfx, or copied into bgfx memory when they are converted, and the builder is
+            // released.
+            impl.Memory.GeometryBytes -= Internal::GetMemoryBytes(primitiveBuilder);
+            impl.Primitives.push_back(Pbr::Primitive(pbrResources,
+                                                     std::move(primitiveBuilder),
+                                                     impl.MaterialMap.at(primitiveBuilderPair.first),
+                                                     false /* updatableBuffers */,
+                                                     impl.VertexFormat));
+            uploadedBytes += bytes;
+            impl.NextPrimitiveBuilder++;
+        }
+
+        // Create each image once per color space, unless the texture cache holds a texture with the same content, and replace the
+        // placeholders of the materials using it.
+        while (impl.CurrentStage == Stage::Textures) {
+            if (impl.NextTextureBinding == impl.TextureBindings.size()) {
+                // The images were released after their last texture, unless no material uses them.
+                impl.TextureBindings.clear();
+                impl.Textures.clear();
+                impl.Images.clear();
+                impl.ReleaseUnreferencedSources();
+                impl.Memory.ImageBytes = 0;
+                impl.CurrentStage = Stage::Complete;
+                sample::Trace("Loaded glTF model, which held at most {:.1f} MB of CPU memory at once",
+                              impl.Memory.HighWaterBytes / (1024.0 * 1024.0));
+                break;
+            }
+
+            const TextureBinding& binding = impl.TextureBindings[impl.NextTextureBinding];
+            shared_bgfx_handle<bgfx::TextureHandle>& texture = impl.Textures[std::make_tuple(binding.Image, binding.SRGB)];
+            if (!texture) {
+                PreparedImage& image = impl.Images.at(binding.Image);
+                const size_t bytes = image.GetSize();
+                const bool cached = impl.TextureCache && image.Data != nullptr;
+                if (cached) {
+                    texture = impl.TextureCache->Find(image.ContentHash, binding.SRGB, bytes);
+                }
+                if (!texture) {
+                    if (!fitsBudget(bytes)) {
+                        return uploadedBytes;
+                    }
+
+                    // The last texture of an image is given its pixels rather than a copy. Moving a vector keeps its storage.
+                    if (impl.ImageBindingCounts[binding.Image] == 1 && !image.Pixels.empty()) {
+                        impl.Memory.ImageBytes -= image.Pixels.size();
+                        image.Storage = std::make_shared<const std::vector<uint8_t>>(std::move(image.Pixels));
+                    }
+                    texture.reset(LoadImage(image, binding.SRGB));
+                    uploadedBytes += bytes;
+                    if (cached && texture) {
+                        texture = impl.TextureCache->Insert(image.ContentHash, binding.SRGB, std::move(texture));
+                    }
+                }
+            }
+
+            // Images which failed to decode keep the placeholder.
+            if (texture) {
+                binding.Material->SetTexture(binding.Slot, texture, binding.Sampler);
+            }
+            if (--impl.ImageBindingCounts[binding.Image] == 0) {
+                impl.ReleaseImage(binding.Image);
+            }
+            impl.NextTextureBinding++;
+        }
+
+        return uploadedBytes;
+    }
+} // namespace Gltf
+
+namespace {
+    // Read and process a tinygltf model whose GLB binary chunk, if any, may be read in place. The glTF model and the binary chunk
+    // are only read during this call, unless gltfModelStorage and binaryChunkStorage own them. The images which read their pixels
+    // in place from an owned source then keep it alive until they are uploaded, and the source is released after the last one.
+    std::unique_ptr<Gltf::PreparedModel> PrepareModel(const tinygltf::Model& gltfModel,
+                                                      std::shared_ptr<const void> gltfModelStorage,
+                                                      const GltfHelper::BufferData& binaryChunk,
+                                                      std::shared_ptr<const void> binaryChunkStorage,
+                                                      const Gltf::LoadOptions& options) {
+        auto prepared = std::make_unique<Gltf::PreparedModel::Impl>();
+        prepared->MeshQuantization = GltfHelper::UsesExtension(gltfModel, "KHR_mesh_quantization");
+        prepared->VertexFormat = Gltf::Internal::SelectVertexFormat(options, prepared->MeshQuantization);
+        prepared->TextureCache = options.TextureCache;
+
         // Start off with an empty Pbr Model.
-        auto model = std::make_shared<Pbr::Model>();
+        prepared->Model = std::make_shared<Pbr::Model>();
 
-        // Read and transform mesh/node data. Primitives with the same material are merged to reduce draw calls.
-        PrimitiveBuilderMap primitiveBuilderMap;
+        // The memory of the load starts with the content it reads from.
+        const size_t modelBytes = GetSourceBytes(gltfModel);
+        prepared->Memory.SourceBytes = modelBytes + binaryChunk.Size;
+        prepared->RecordMemory();
+        if (gltfModelStorage) {
+            prepared->SourceSizes.emplace(gltfModelStorage.get(), modelBytes);
+        }
+        if (binaryChunkStorage) {
+            prepared->SourceSizes.emplace(binaryChunkStorage.get(), binaryChunk.Size);
+        }
+
+        // Compressed buffer views are decoded, primitives are read and images are decoded concurrently. These tasks reference the
+        // glTF model, its binary chunk and the decoded buffer views, so all of them must finish before returning, including when an
+        // exception is thrown.
+        GltfHelper::DecodedBufferViews decodedBufferViews;
+        std::vector<std::pair<int, std::future<std::vector<uint8_t>>>> pendingBufferViews;
+        std::vector<PendingPrimitive> pendingPrimitives;
+        std::vector<std::future<PreparedImage>> pendingImages;
+        std::vector<std::pair<int, std::future<std::vector<Pbr::PrimitiveBuilder>>>> pendingPrimitiveBuilders;
+        std::vector<PendingCompression> pendingCompressions;
+        std::vector<std::future<uint64_t>> pendingImageHashes;
+        const auto waitForPendingWork = MakeScopeGuard([&] {
+            for (const auto& pendingBufferView : pendingBufferViews) {
+                if (pendingBufferView.second.valid()) {
+                    pendingBufferView.second.wait();
+                }
+            }
+            for (PendingPrimitive& pendingPrimitive : pendingPrimitives) {
+                if (pendingPrimitive.Primitive.valid()) {
+                    pendingPrimitive.Primitive.wait();
+                }
+            }
+            for (const auto& pendingImage : pendingImages) {
+                if (pendingImage.valid()) {
+                    pendingImage.wait();
+                }
+            }
+            for (const auto& pendingPrimitiveBuilder : pendingPrimitiveBuilders) {
+                if (pendingPrimitiveBuilder.second.valid()) {
+                    pendingPrimitiveBuilder.second.wait();
+                }
+            }
+            for (const PendingCompression& pendingCompression : pendingCompressions) {
+                for (const auto& blockRows : pendingCompression.BlockRows) {
+                    if (blockRows.valid()) {
+                        blockRows.wait();
+                    }
+                }
+            }
+            for (const auto& pendingImageHash : pendingImageHashes) {
+                if (pendingImageHash.valid()) {
+                    pendingImageHash.wait();
+                }
+            }
+        });
+
+        // Decode the buffer views compressed with EXT_meshopt_compression which the primitives read, one per task, before the
+        // primitives are read from them.
+        if (GltfHelper::UsesExtension(gltfModel, "EXT_meshopt_compression")) {
+            for (const int bufferViewIndex : FindCompressedBufferViews(gltfModel)) {
+                auto decodeBufferView = [&gltfModel, &binaryChunk, bufferViewIndex] {
+                    return DecodeBufferView(gltfModel, binaryChunk, bufferViewIndex);
+                };
+                pendingBufferViews.emplace_back(bufferViewIndex, RunAsync(options.ThreadPool, std::move(decodeBufferView)));
+            }
+            for (auto& pendingBufferView : pendingBufferViews) {
+                const auto decoded = decodedBufferViews.emplace(pendingBufferView.first, pendingBufferView.second.get());
+                prepared->Memory.SourceBytes += decoded.first->second.size();
+            }
+            prepared->RecordMemory();
+        }
+
+        // Read mesh/node data.
         {
             const int defaultSceneId = (gltfModel.defaultScene == -1) ? 0 : gltfModel.defaultScene;
             const tinygltf::Scene& defaultScene = gltfModel.scenes.at(defaultSceneId);
 
             // Process the root scene nodes. The children will be processed recursively.
             for (const int rootNodeId : defaultScene.nodes) {
-                LoadNode(Pbr::RootNodeIndex, gltfModel, rootNodeId, primitiveBuilderMap, *model);
+                LoadNode(Pbr::RootNodeIndex,
+                         gltfModel,
+                         binaryChunk,
+                         decodedBufferViews,
+                         rootNodeId,
+                         options,
+                         pendingPrimitives,
+                         *prepared->Model);
             }
         }
 
-        // Load the materials referenced by the primitives
-        std::map<int, std::shared_ptr<Pbr::Material>> materialMap;
-        {
-            // Create D3D cache for reuse of texture views and samplers when possible.
-            using ImageKey = std::tuple<const tinygltf::Image*, bool>; // Item1 is a pointer to the image, Item2 is sRGB.
-            std::map<ImageKey, shared_bgfx_handle<bgfx::TextureHandle>> imageMap;
-            std::map<const tinygltf::Sampler*, shared_bgfx_handle<bgfx::UniformHandle>> samplerMap;
-
-            // primitiveBuilderMap is grouped by material. Loop through the referenced materials and load their resources. This will only
-            // load materials which are used by the active scene.
-            for (const auto& primitiveBuilderPair : primitiveBuilderMap) {
-                std::shared_ptr<Pbr::Material> pbrMaterial;
-
-                const int materialIndex = primitiveBuilderPair.first;
-                if (materialIndex == -1) // No material was referenced. Make up a material for it.
-                {
-                    // Default material is a grey material, 50% roughness, non-metallic.
-                    pbrMaterial = Pbr::Material::CreateFlat(pbrResources, {0.5f, 0.5f, 0.5f, 0.5f}, 0.5f);
+        // Images and samplers are numbered in order of first use. Images are also recorded with their content, which decides how
+        // their mips are filtered, whether they are only used for occlusion, which only reads the red channel, so that grey ones
+        // can be kept single channel, and whether their alpha channel is used, which decides how they are block compressed. An
+        // image is identified by its source along with its MSFT_texture_dds image, since either may be shared without the other.
+        std::map<std::pair<const tinygltf::Image*, const tinygltf::Image*>, int32_t> imageIndices;
+        std::vector<ImageUsage> images;
+        std::map<const tinygltf::Sampler*, int32_t> samplerIndices;
+        const auto prepareTexture = [&](const GltfHelper::Material::Texture& texture,
+                                        Pbr::TextureContent content,
+                                        bool occlusion = false,
+                                        bool alphaUsed = false) {
+            PreparedMaterial::Texture preparedTexture;
+            if (texture.Image != nullptr || texture.DdsImage != nullptr) {
+                const auto [imageIndex, inserted] =
+                    imageIndices.emplace(std::make_pair(texture.Image, texture.DdsImage), (int32_t)imageIndices.size());
+                if (inserted) {
+                    images.push_back({texture.Image, texture.DdsImage, content, occlusion, alphaUsed});
                 } else {
-                    const tinygltf::Material& gltfMaterial = gltfModel.materials.at(materialIndex);
-
-                    const GltfHelper::Material material = GltfHelper::ReadMaterial(gltfModel, gltfMaterial);
-                    pbrMaterial = std::make_shared<Pbr::Material>(pbrResources);
-
-                    // Read a tinygltf texture and sampler into the Pbr Material.
-                    auto loadTexture = [&](const char* _name,
-                                           Pbr::ShaderSlots::PSMaterial slot,
-                                           const GltfHelper::Material::Texture& texture,
-                                           bool sRGB,
-                                           Pbr::RGBAColor defaultRGBA) {
-                        // Find or load the image referenced by the texture.
-
-                        const ImageKey imageKey = std::make_tuple(texture.Image, sRGB);
-                        shared_bgfx_handle<bgfx::TextureHandle> textureView = imageMap[imageKey];
-                        if (!imageMap[imageKey]) // If not cached, load the image and store it in the texture cache.
-
-                        {
-                            // TODO: Generate mipmaps if sampler's minification filter (minFilter) uses mipmapping.
-                            // TODO: If texture is not power-of-two and (sampler has wrapping=repeat/mirrored_repeat OR minFilter uses
-                            // mipmapping), resize to power-of-two.
-                            textureView = texture.Image != nullptr
-                                              ? shared_bgfx_handle<bgfx::TextureHandle>(LoadImage(*texture.Image, sRGB))
-                                              : pbrResources.CreateSolidColorTexture(defaultRGBA);
-                            imageMap[imageKey] = textureView;
-                        }
-
-                        // Find or create the sampler referenced by the texture.
-                        shared_bgfx_handle<bgfx::UniformHandle> samplerState = samplerMap[texture.Sampler];
-
-                        if (!samplerState) // If not cached, create the sampler and store it in the sampler cache.
-                        {
-                            samplerState.reset(texture.Sampler != nullptr ? CreateSampler(_name, gltfModel, *texture.Sampler)
-                                                                          : Pbr::Texture::CreateSampler(_name));
-                            samplerMap[texture.Sampler] = samplerState;
-                        }
-
-                        pbrMaterial->SetTexture(slot, textureView, samplerState);
-                    };
-
-                    pbrMaterial->Name = gltfMaterial.name;
-
-                    loadTexture(
-                        "u_baseColorTexture", Pbr::ShaderSlots::BaseColor, material.BaseColorTexture, true /* sRGB */, Pbr::RGBA::White);
-                    loadTexture("u_metallicRoughnessTexture",
-                                Pbr::ShaderSlots::MetallicRoughness,
-                                material.MetallicRoughnessTexture,
-                                false /* sRGB */,
-                                Pbr::RGBA::White);
-                    loadTexture(
-                        "u_emissiveTexture", Pbr::ShaderSlots::Emissive, material.EmissiveTexture, true /* sRGB */, Pbr::RGBA::White);
-                    loadTexture(
-                        "u_normalTexture", Pbr::ShaderSlots::Normal, material.NormalTexture, false /* sRGB */, Pbr::RGBA::FlatNormal);
-                    loadTexture(
-                        "u_occlusionTexture", Pbr::ShaderSlots::Occlusion, material.OcclusionTexture, false /* sRGB */, Pbr::RGBA::White);
-
-                    pbrMaterial->SetDoubleSided(material.DoubleSided);
-                    pbrMaterial->SetAlphaBlended(material.AlphaMode == GltfHelper::AlphaMode::Blend);
-
-                    Pbr::Material::ConstantBufferData& parameters = pbrMaterial->Parameters();
-                    parameters.BaseColorFactor = material.BaseColorFactor;
-                    parameters.MetallicFactor = material.MetallicFactor;
-                    parameters.RoughnessFactor = material.RoughnessFactor;
-                    parameters.EmissiveFactor = material.EmissiveFactor;
-                    parameters.OcclusionStrength = material.OcclusionStrength;
-                    parameters.NormalScale = material.NormalScale;
-                    parameters.AlphaCutoff =
-                        material.AlphaMode == GltfHelper::AlphaMode::Mask ? material.AlphaCutoff : std::numeric_limits<float>::lowest();
+                    ImageUsage& usage = images[imageIndex->second];
+                    if (!occlusion) {
+                        usage.OcclusionOnly = false;
+                    }
+                    if (alphaUsed) {
+                        usage.AlphaUsed = true;
+                    }
+                }
+                preparedTexture.Image = imageIndex->second;
+            }
+            if (texture.Sampler != nullptr) {
+                const auto [samplerIndex, inserted] = samplerIndices.emplace(texture.Sampler, (int32_t)samplerIndices.size());
+                if (inserted) {
+                    const tinygltf::Sampler& sampler = *texture.Sampler;
+                    prepared->Samplers.push_back({sampler.minFilter, sampler.magFilter, sampler.wrapS, sampler.wrapT});
+                }
+                preparedTexture.Sampler = samplerIndex->second;
+            }
+            return preparedTexture;
+        };
+
+        // Read the materials referenced by the primitives. This will only load materials which are used by the active scene.
+        for (const PendingPrimitive& pendingPrimitive : pendingPrimitives) {
+            const int materialIndex = pendingPrimitive.Material;
+            if (materialIndex == -1 || prepared->Materials.count(materialIndex) > 0) {
+                continue;
+            }
+
+            const tinygltf::Material& gltfMaterial = gltfModel.materials.at(materialIndex);
+            const GltfHelper::Material material = GltfHelper::ReadMaterial(gltfModel, gltfMaterial);
+            PreparedMaterial& preparedMaterial = prepared->Materials[materialIndex];
+            preparedMaterial.Name = gltfMaterial.name;
+            preparedMaterial.BaseColorTexture = prepareTexture(material.BaseColorTexture,
+                                                               Pbr::TextureContent::SRGB,
+                                                               false /* occlusion */,
+                                                               material.AlphaMode != GltfHelper::AlphaMode::Opaque);
+            preparedMaterial.MetallicRoughnessTexture = prepareTexture(material.MetallicRoughnessTexture, Pbr::TextureContent::Linear);
+            preparedMaterial.EmissiveTexture = prepareTexture(material.EmissiveTexture, Pbr::TextureContent::SRGB);
+            preparedMaterial.NormalTexture = prepareTexture(material.NormalTexture, Pbr::TextureContent::Normal);
+            preparedMaterial.OcclusionTexture =
+                prepareTexture(material.OcclusionTexture, Pbr::TextureContent::Linear, true /* occlusion */);
+            preparedMaterial.BaseColorFactor = material.BaseColorFactor;
+            preparedMaterial.MetallicFactor = material.MetallicFactor;
+            preparedMaterial.RoughnessFactor = material.RoughnessFactor;
+            preparedMaterial.EmissiveFactor = material.EmissiveFactor;
+            preparedMaterial.NormalScale = material.NormalScale;
+            preparedMaterial.OcclusionStrength = material.OcclusionStrength;
+            preparedMaterial.AlphaMode = material.AlphaMode;
+            preparedMaterial.AlphaCutoff = material.AlphaCutoff;
+            preparedMaterial.DoubleSided = material.DoubleSided;
+        }
+
+        // Decode the images and generate their mips while the primitives are being read.
+        for (const ImageUsage& usage : images) {
+            const auto readImage = [&gltfModel, &gltfModelStorage, &binaryChunk, &binaryChunkStorage, &options, usage] {
+                return ReadImage(gltfModel, binaryChunk, usage, options.MipGeneration, gltfModelStorage, binaryChunkStorage);
+            };
+            pendingImages.push_back(RunAsync(options.ThreadPool, readImage));
+        }
+
+        // Merge the primitives in traversal order, so the result does not depend on the order the reads finished in.
+        // Primitives with the same material are merged to reduce draw calls. Primitives with morph targets keep a primitive of their
+        // own, since they are morphed with the weights of their node, in a vertex buffer which is rewritten as the weights change.
+        std::vector<GltfHelper::Primitive> primitives;
+        primitives.reserve(pendingPrimitives.size());
+        for (PendingPrimitive& pendingPrimitive : pendingPrimitives) {
+            primitives.push_back(pendingPrimitive.Primitive.get());
+            prepared->Memory.GeometryBytes += GetPrimitiveBytes(primitives.back());
+        }
+        prepared->RecordMemory();
+
+        // The decoded buffer views are only read by the primitives, which are all read by now.
+        for (const auto& decodedBufferView : decodedBufferViews) {
+            prepared->Memory.SourceBytes -= decodedBufferView.second.size();
+        }
+        decodedBufferViews.clear();
+
+        // The merged vertices and indices of each material are allocated once, so that appending copies every vertex once rather
+        // than again each time the arrays grow. Each primitive is freed once appended.
+        std::map<int, std::pair<size_t, size_t>> mergedSizes; // Vertex and index counts by material.
+        for (size_t i = 0; i < primitives.size(); i++) {
+            if (primitives[i].Targets.empty()) {
+                std::pair<size_t, size_t>& mergedSize = mergedSizes[pendingPrimitives[i].Material];
+                mergedSize.first += primitives[i].Vertices.size();
+                mergedSize.second += primitives[i].Indices.size();
+            }
+        }
+        PrimitiveBuilderMap primitiveBuilderMap;
+        for (const auto& [materialIndex, mergedSize] : mergedSizes) {
+            Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderMap[materialIndex];
+            primitiveBuilder.Vertices.reserve(mergedSize.first);
+            primitiveBuilder.Indices.reserve(mergedSize.second);
+            prepared->Memory.GeometryBytes += mergedSize.first * sizeof(Pbr::Vertex) + mergedSize.second * sizeof(uint32_t);
+        }
+        prepared->RecordMemory();
+
+        std::map<int, std::vector<Pbr::PrimitiveBuilder>> morphPrimitiveBuilders;
+        for (size_t i = 0; i < primitives.size(); i++) {
+            const PendingPrimitive& pendingPrimitive = pendingPrimitives[i];
+            GltfHelper::Primitive primitive = std::move(primitives[i]);
+            if (primitive.Targets.empty()) {
+                AppendPrimitive(primitive, primitiveBuilderMap[pendingPrimitive.Material]);
+            } else {
+                Pbr::PrimitiveBuilder& primitiveBuilder = morphPrimitiveBuilders[pendingPrimitive.Material].emplace_back();
+                AppendPrimitive(primitive, primitiveBuilder);
+                AppendMorphTargets(std::move(primitive.Targets), pendingPrimitive.Node, primitiveBuilder);
+                primitiveBuilderMap.try_emplace(pendingPrimitive.Material); // Each material is processed by one task.
+            }
+        }
+        primitives.clear();
+
+        prepared->Memory.GeometryBytes = 0;
+        for (const auto& [materialIndex, primitiveBuilder] : primitiveBuilderMap) {
+            prepared->Memory.GeometryBytes += Gltf::Internal::GetMemoryBytes(primitiveBuilder);
+            for (const Pbr::PrimitiveBuilder& morphPrimitiveBuilder : morphPrimitiveBuilders[materialIndex]) {
+                prepared->Memory.GeometryBytes += Gltf::Internal::GetMemoryBytes(morphPrimitiveBuilder);
+            }
+        }
+        prepared->RecordMemory();
+
+        // Process the merged primitives concurrently. The morph targets refer to the vertices by index, so primitives with morph
+        // targets are kept as they were read rather than split, reordered or simplified.
+        for (auto& primitiveBuilderPair : primitiveBuilderMap) {
+            pendingPrimitiveBuilders.emplace_back(
+                primitiveBuilderPair.first,
+                RunAsync(options.ThreadPool,
+                         [&options,
+                          primitiveBuilder = std::move(primitiveBuilderPair.second),
+                          morphed = std::move(morphPrimitiveBuilders[primitiveBuilderPair.first])]() mutable {
+                             std::vector<Pbr::PrimitiveBuilder> primitiveBuilders;
+                             if (!primitiveBuilder.Indices.empty()) {
+                                 primitiveBuilders = ProcessPrimitiveBuilder(std::move(primitiveBuilder), options);
+                             }
+                             std::move(morphed.begin(), morphed.end(), std::back_inserter(primitiveBuilders));
+                             return primitiveBuilders;
+                         }));
+        }
+
+        // Moving the decoded images keeps the storage their pixel pointers refer to. The images are then block compressed while
+        // the primitives are processed.
+        for (auto& pendingImage : pendingImages) {
+            prepared->Images.push_back(pendingImage.get());
+            prepared->Memory.ImageBytes += prepared->Images.back().Pixels.size();
+        }
+        if (options.TextureCompression) {
+            for (size_t i = 0; i < prepared->Images.size(); i++) {
+                StartCompressingImage(
+                    prepared->Images[i], i, images[i].AlphaUsed, *options.TextureCompression, options.ThreadPool, pendingCompressions);
+            }
+            for (const PendingCompression& pendingCompression : pendingCompressions) {
+                prepared->Memory.ImageBytes += pendingCompression.Pixels.size();
+            }
+        }
+        prepared->RecordMemory();
+
+        // Collect the processed primitives in material order, with the bounds of their geometry.
+        XMVECTOR boundsMin = g_XMFltMax;
+        XMVECTOR boundsMax = XMVectorNegate(g_XMFltMax);
+        prepared->Memory.GeometryBytes = 0;
+        for (auto& pendingPrimitiveBuilder : pendingPrimitiveBuilders) {
+            std::vector<Pbr::PrimitiveBuilder> primitiveBuilders = pendingPrimitiveBuilder.second.get();
+            for (const Pbr::PrimitiveBuilder& primitiveBuilder : primitiveBuilders) {
+                prepared->Memory.GeometryBytes += Gltf::Internal::GetMemoryBytes(primitiveBuilder);
+                for (const Pbr::Vertex& vertex : primitiveBuilder.Vertices) {
+                    const XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.Position));
+                    boundsMin = XMVectorMin(boundsMin, position);
+                    boundsMax = XMVectorMax(boundsMax, position);
                 }
+            }
+            prepared->PrimitiveBuilders.emplace_back(pendingPrimitiveBuilder.first, std::move(primitiveBuilders));
+        }
+        XMStoreFloat3(&prepared->BoundsMin, boundsMin);
+        XMStoreFloat3(&prepared->BoundsMax, boundsMax);
+        prepared->RecordMemory();
+
+        // Replace the pixels of the compressed images, which are no longer read once all of their blocks are written.
+        for (PendingCompression& pendingCompression : pendingCompressions) {
+            for (auto& blockRows : pendingCompression.BlockRows) {
+                blockRows.get();
+            }
+            PreparedImage& image = prepared->Images[pendingCompression.Image];
+            prepared->Memory.ImageBytes -= image.Pixels.size();
+            image.Pixels = std::move(pendingCompression.Pixels);
+            image.Data = image.Pixels.data();
+            image.Storage.reset();
+            image.Format = pendingCompression.Format;
+        }
+
+        // Hash the final pixels on the worker threads, so that the textures can be shared with other models. The hashes are also
+        // stored in model cache entries, so they are computed whether or not a texture cache is used.
+        for (const PreparedImage& image : prepared->Images) {
+            pendingImageHashes.push_back(RunAsync(options.ThreadPool, [&image] { return HashImage(image); }));
+        }
+        for (size_t i = 0; i < pendingImageHashes.size(); i++) {
+            prepared->Images[i].ContentHash = pendingImageHashes[i].get();
+        }
+
+        // Only the owned sources which images still read from are held past this call.
+        prepared->Memory.SourceBytes = 0;
+        for (const auto& [storage, size] : prepared->SourceSizes) {
+            prepared->Memory.SourceBytes += size;
+        }
+        prepared->ReleaseUnreferencedSources();
+
+        return std::make_unique<Gltf::PreparedModel>(std::move(prepared));
+    }
 
-                materialMap.insert(std::make_pair(materialIndex, std::move(pbrMaterial)));
+    // tinygltf image loader which leaves DDS images undecoded rather than failing the load, since stb_image cannot decode them.
+    // The DDS images of MSFT_texture_dds are read from their buffer views instead (see ReadDdsImage).
+    bool LoadImageDataExceptDds(tinygltf::Image* image,
+                                const int imageIndex,
+                                std::string* err,
+                                std::string* warn,
+                                int reqWidth,
+                                int reqHeight,
+                                const unsigned char* bytes,
+                                int size,
+                                void* userData) {
+        if (image->mimeType == "image/vnd-ms.dds" || sample::IsTextureContainer(bytes, static_cast<size_t>(size))) {
+            return true;
+        }
+        return tinygltf::LoadImageData(image, imageIndex, err, warn, reqWidth, reqHeight, bytes, size, userData);
+    }
+
+    // Prepare GLB file content, which is only read during this call unless bufferStorage owns it.
+    std::unique_ptr<Gltf::PreparedModel> PrepareGlb(_In_reads_bytes_(bufferBytes) const uint8_t* buffer,
+                                                    uint32_t bufferBytes,
+                                                    std::shared_ptr<const void> bufferStorage,
+                                                    const Gltf::LoadOptions& options) {
+        // Parse the GLB buffer data into a tinygltf model object. The JSON is streamed straight into the model, unless the content
+        // is only supported by tinygltf, such as external buffers and images, or is not valid, in which case tinygltf reports why.
+        // The tinygltf fallback copies the binary chunk into the first buffer, which is then read instead of the chunk.
+        auto gltfModel = std::make_shared<tinygltf::Model>();
+        const std::string_view jsonChunk = ReadGlbJsonChunk(buffer, bufferBytes);
+        if (jsonChunk.empty() || !GltfHelper::ParseGltfJson(jsonChunk, ReadGlbBinaryChunk(buffer, bufferBytes).Size, gltfModel.get())) {
+            std::string errorMessage;
+            tinygltf::TinyGLTF loader;
+            loader.SetImageLoader(LoadImageDataExceptDds, nullptr);
+            if (!loader.LoadBinaryFromMemory(gltfModel.get(), &errorMessage, nullptr /*warn*/, buffer, bufferBytes, ".")) {
+                const auto msg =
+                    std::string("\r\nFailed to load gltf model (") + std::to_string(bufferBytes) + " bytes). Error: " + errorMessage;
+                throw std::exception(msg.c_str());
             }
         }
 
-        // Convert the primitive builders into primitives with their respective material and add it into the Pbr Model.
-        for (const auto& primitiveBuilderPair : primitiveBuilderMap) {
-            const Pbr::PrimitiveBuilder& primitiveBuilder = primitiveBuilderPair.second;
-            const std::shared_ptr<Pbr::Material>& material = materialMap.find(primitiveBuilderPair.first)->second;
-            model->AddPrimitive(Pbr::Primitive(pbrResources, primitiveBuilder, material));
+        const tinygltf::Model& gltfModelRef = *gltfModel;
+        return PrepareModel(gltfModelRef, std::move(gltfModel), ReadGlbBinaryChunk(buffer, bufferBytes), std::move(bufferStorage), options);
+    }
+
+    // Create all of the bgfx resources of a prepared model at once.
+    std::shared_ptr<Pbr::Model> UploadModel(const Pbr::Resources& pbrResources, Gltf::PreparedModel& preparedModel) {
+        preparedModel.Upload(pbrResources, std::numeric_limits<size_t>::max());
+        assert(preparedModel.GetStage() == Gltf::PreparedModel::Stage::Complete);
+        return preparedModel.GetModel();
+    }
+} // namespace
+
+namespace Gltf {
+    std::unique_ptr<PreparedModel> PrepareGltfObject(std::shared_ptr<const tinygltf::Model> gltfModel, const LoadOptions& options) {
+        const tinygltf::Model& gltfModelRef = *gltfModel;
+        return PrepareModel(gltfModelRef, std::move(gltfModel), {} /* binaryChunk */, nullptr /* binaryChunkStorage */, options);
+    }
+
+    std::unique_ptr<PreparedModel> PrepareGltfBinary(_In_reads_bytes_(bufferBytes) const uint8_t* buffer,
+                                                     uint32_t bufferBytes,
+                                                     const LoadOptions& options) {
+        return PrepareGlb(buffer, bufferBytes, nullptr /* bufferStorage */, options);
+    }
+
+    std::unique_ptr<PreparedModel> PrepareGltfFile(const std::filesystem::path& path, const LoadOptions& options) {
+        // The geometry and decoded images are copied out of the binary chunk, so the mapping only outlives the preparation when
+        // the textures of DDS images are created from it in place.
+        auto file = std::make_shared<const sample::MappedFile>(path);
+        if (file->Size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::exception("glTF binary files larger than 4 GB are not supported.");
         }
 
-        return model;
+        return PrepareGlb(file->Data(), (uint32_t)file->Size(), file, options);
+    }
+
+    std::shared_ptr<Pbr::Model> FromGltfObject(const Pbr::Resources& pbrResources,
+                                               const tinygltf::Model& gltfModel,
+                                               const LoadOptions& options) {
+        // The glTF model is only read until the upload below completes, so the images which would be read from it in place are
+        // copied by bgfx instead.
+        const std::unique_ptr<PreparedModel> preparedModel =
+            PrepareModel(gltfModel, nullptr /* gltfModelStorage */, {} /* binaryChunk */, nullptr /* binaryChunkStorage */, options);
+        return UploadModel(pbrResources, *preparedModel);
     }
 
     std::shared_ptr<Pbr::Model> FromGltfBinary(const Pbr::Resources& pbrResources,
                                                _In_reads_bytes_(bufferBytes) const uint8_t* buffer,
-                                               uint32_t bufferBytes) {
-        // Parse the GLB buffer data into a tinygltf model object.
-        tinygltf::Model gltfModel;
-        std::string errorMessage;
-        tinygltf::TinyGLTF loader;
-        if (!loader.LoadBinaryFromMemory(&gltfModel, &errorMessage, nullptr /*warn*/, buffer, bufferBytes, ".")) {
-            const auto msg =
-                std::string("\r\nFailed to load gltf model (") + std::to_string(bufferBytes) + " bytes). Error: " + errorMessage;
-            throw std::exception(msg.c_str());
-        }
-
-        return FromGltfObject(pbrResources, gltfModel);
+                                               uint32_t bufferBytes,
+                                               const LoadOptions& options) {
+        return UploadModel(pbrResources, *PrepareGltfBinary(buffer, bufferBytes, options));
+    }
+
+    std::shared_ptr<Pbr::Model> FromGltfFile(const Pbr::Resources& pbrResources,
+                                             const std::filesystem::path& path,
+                                             const LoadOptions& options) {
+        return UploadModel(pbrResources, *PrepareGltfFile(path, options));
     }
 } // namespace Gltf
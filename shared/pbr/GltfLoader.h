@@ -7,28 +7,150 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include "..\Gltf\GltfHelper.h"
+#include "GltfTextureCache.h"
 #include "PbrResources.h"
 #include "PbrModel.h"
+#include "PbrMeshOptimizer.h"
+#include "PbrMipGenerator.h"
+#include "PbrTextureCompressor.h"
 
 namespace tinygltf { class Model; }
+namespace sample { class ThreadPool; }
 
 namespace Gltf
 {
+    // Version of the loader's prepared output. Bump it whenever the output changes, so that cached models are prepared again.
+    constexpr uint32_t LoaderVersion = 6;
+
+    // Optional processing applied to the glTF content while it is loaded.
+    struct LoadOptions
+    {
+        // When set, primitives with more vertices than 16-bit indices can address are split so that every index buffer is 16-bit.
+        bool SplitForIndex16{true};
+
+        // When set, the triangles and vertices of large primitives are reordered for the GPU vertex cache, overdraw and vertex fetch.
+        std::optional<Pbr::MeshOptimizationOptions> MeshOptimization{Pbr::MeshOptimizationOptions{}};
+
+        // When set, simplified levels of detail are generated for each primitive.
+        std::optional<Pbr::LodGenerationOptions> LodGeneration;
+
+        // When set, large primitives are split into meshlets which are culled per view on the CPU.
+        std::optional<Pbr::MeshletOptions> MeshletGeneration;
+
+        // Algorithm used to generate the tangents of primitives which have none, which otherwise dominates the load time of
+        // such content. The default MikkTSpace mode matches the tangents most normal maps are baked with.
+        GltfHelper::TangentOptions Tangents;
+
+        // When set, the full mip chain of each texture is generated on the worker threads, so that minified textures do not alias.
+        std::optional<Pbr::MipGenerationOptions> MipGeneration{Pbr::MipGenerationOptions{}};
+
+        // When set, the images of large textures are block compressed while the model is prepared, to a quarter or less of their
+        // texture memory. The renderer must support the chosen formats, as all feature level 10 hardware does except for BC7.
+        std::optional<Pbr::TextureCompressionOptions> TextureCompression;
+
+        // When set, textures are shared through this cache with the other models whose images have the same content. By default,
+        // all models of the process share the same cache.
+        std::shared_ptr<Gltf::TextureCache> TextureCache{Gltf::TextureCache::GetShared()};
+
+        // Format of the vertex buffers. The compact format quantizes the vertices to about half the size.
+        Pbr::VertexFormat VertexFormat{Pbr::VertexFormat::Full};
+
+        // When set, models using KHR_mesh_quantization get compact vertex buffers whatever VertexFormat is, since their vertices
+        // are already quantized to about the same precision.
+        bool CompactQuantizedModels{true};
+
+        // When set, primitives are read and processed and images are decoded on this thread pool, otherwise on the calling thread.
+        // The load waits for this work, so it must not be called from a thread of the same pool.
+        sample::ThreadPool* ThreadPool{nullptr};
+    };
+
+    // CPU memory held by a load, which is most of the memory it uses before its data is given to bgfx. It is counted as the load
+    // collects and releases its data rather than measured from the heap, so that loads running at the same time are told apart.
+    // Data given to bgfx is no longer counted, although bgfx holds it until the next frame has read it.
+    struct LoadMemoryReport
+    {
+        size_t SourceBytes;    // glTF buffers and images, GLB file content and decoded buffer views which the load still reads.
+        size_t GeometryBytes;  // Vertices, indices and morph targets of the primitives not yet created.
+        size_t ImageBytes;     // Decoded, mip mapped or compressed pixels of the images not yet created.
+        size_t HighWaterBytes; // The most the load held at once since it started.
+    };
+
+    // glTF content which has been read and processed on the CPU, whose bgfx resources are then created incrementally. Preparing
+    // does not use bgfx, so it can run on any thread, while Upload must be called on the thread which creates bgfx resources.
+    class PreparedModel final
+    {
+    public:
+        enum class Stage
+        {
+            Geometry, // The model shows nothing, or a translucent bounding box proxy, until all of its primitives are created.
+            Textures, // All primitives are shown, with solid color placeholders until the textures replacing them are created.
+            Complete,
+        };
+
+        struct Impl; // Defined in GltfLoader.cpp.
+        explicit PreparedModel(std::unique_ptr<Impl> impl);
+        ~PreparedModel();
+
+        // The model being filled in. Its nodes are in place from the start, so it can be rendered and animated right away.
+        const std::shared_ptr<Pbr::Model>& GetModel() const;
+        Stage GetStage() const;
+
+        // Create bgfx resources until about byteBudget bytes of vertex, index and texture data are uploaded, and return the bytes
+        // uploaded. At least one resource is created per call so that the upload always progresses. The first call also creates
+        // the materials, and the bounding box proxy when the geometry does not fit in the budget.
+        size_t Upload(const Pbr::Resources& pbrResources, size_t byteBudget);
+
+        // The memory the load holds now, and the most it held so far. The geometry is released as each primitive is created, and
+        // each image, along with the glTF content it was read from, once the last texture using it is created.
+        LoadMemoryReport GetMemoryReport() const;
+
+    private:
+        friend class ModelCache;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    // Prepares a tinygltf model, which is kept alive until the images read from it are uploaded.
+    std::unique_ptr<PreparedModel> PrepareGltfObject(std::shared_ptr<const tinygltf::Model> gltfModel, const LoadOptions& options = {});
+
+    // Prepares glTF 2.0 GLB file content. The buffer is only read during this call.
+    std::unique_ptr<PreparedModel> PrepareGltfBinary(
+        _In_reads_bytes_(bufferBytes) const uint8_t* buffer,
+        uint32_t bufferBytes,
+        const LoadOptions& options = {});
+
+    // Prepares a glTF 2.0 GLB file, which is memory-mapped during this call, and until upload for the DDS images it holds.
+    std::unique_ptr<PreparedModel> PrepareGltfFile(const std::filesystem::path& path, const LoadOptions& options = {});
+
     // Creates a Pbr Model from tinygltf model.
     std::shared_ptr<Pbr::Model> FromGltfObject(
         const Pbr::Resources& pbrResources,
-        const tinygltf::Model& gltfModel);
+        const tinygltf::Model& gltfModel,
+        const LoadOptions& options = {});
 
 
-    // Creates a Pbr Model from glTF 2.0 GLB file content.
+    // Creates a Pbr Model from glTF 2.0 GLB file content. The binary chunk is read in place rather than copied,
+    // and only the images referenced by the loaded materials are decoded.
     std::shared_ptr<Pbr::Model> FromGltfBinary(
         const Pbr::Resources& pbrResources,
         _In_reads_bytes_(bufferBytes) const uint8_t* buffer,
-        uint32_t bufferBytes);
+        uint32_t bufferBytes,
+        const LoadOptions& options = {});
 
     template<typename Container>
-    std::shared_ptr<Pbr::Model> FromGltfBinary(const Pbr::Resources& pbrResources, const Container& buffer) {
-        return FromGltfBinary(pbrResources, buffer.data(), static_cast<uint32_t>(buffer.size()));
+    std::shared_ptr<Pbr::Model> FromGltfBinary(const Pbr::Resources& pbrResources,
+                                               const Container& buffer,
+                                               const LoadOptions& options = {}) {
+        return FromGltfBinary(pbrResources, buffer.data(), static_cast<uint32_t>(buffer.size()), options);
     }
+
+    // Creates a Pbr Model from a glTF 2.0 GLB file. The file is memory-mapped for the duration of the load instead of being read
+    // into memory, so accessors and images are read directly from the mapped binary chunk.
+    std::shared_ptr<Pbr::Model> FromGltfFile(
+        const Pbr::Resources& pbrResources,
+        const std::filesystem::path& path,
+        const LoadOptions& options = {});
 }
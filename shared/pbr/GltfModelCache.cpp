@@ -0,0 +1,562 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "GltfModelCache.h"
+#include "GltfPreparedModel.h"
+#include "PbrModel.h"
+#include <algorithm>
+#include <fstream>
+#include <SampleShared/FileUtility.h>
+#include <SampleShared/Trace.h>
+
+using namespace DirectX;
+using Gltf::Internal::ImageFormat;
+using Gltf::Internal::PreparedImage;
+using Gltf::Internal::PreparedMaterial;
+using Gltf::Internal::PreparedSampler;
+
+namespace {
+    // A cache entry starts with this header. Arrays in the entry are aligned so that they can be used in place once mapped.
+    struct CacheHeader {
+        uint32_t Magic;
+        uint32_t FormatVersion;
+        uint32_t LoaderVersion;
+        uint32_t Reserved;
+        uint64_t SourceHash;
+        uint64_t OptionsHash;
+        uint64_t Size; // Size of the whole entry, which detects entries truncated while being written.
+    };
+
+    constexpr uint32_t CacheMagic = 0x4D524250; // "PBRM"
+    constexpr uint32_t CacheFormatVersion = 6;  // Bump when the layout below changes.
+    constexpr size_t CacheAlignment = 16;
+    constexpr wchar_t CacheExtension[] = L".pbrmodel";
+
+    // 64-bit hash of a byte range, processed a word at a time. It tells content apart, but is not meant to resist collision attacks.
+    uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+        constexpr uint64_t Prime = 0x100000001b3ull;
+        const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+        size_t offset = 0;
+        for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, bytes + offset, sizeof(word));
+            hash = (hash ^ word) * Prime;
+            hash ^= hash >> 29;
+        }
+        for (; offset < size; offset++) {
+            hash = (hash ^ bytes[offset]) * Prime;
+        }
+
+        // Finalize so that every input bit affects every output bit.
+        hash ^= size;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 31);
+    }
+
+    template <typename T>
+    uint64_t HashValue(const T& value, uint64_t hash) {
+        static_assert(std::is_trivially_copyable_v<T>, "Only values without padding or pointers can be hashed.");
+        return HashBytes(&value, sizeof(value), hash);
+    }
+
+    // Hash the options which change the prepared output. The vertex format and thread pool only affect how it is produced or uploaded.
+    uint64_t HashOptions(const Gltf::LoadOptions& options) {
+        uint64_t hash = HashValue(Gltf::LoaderVersion, 0);
+        hash = HashValue(options.SplitForIndex16, hash);
+        hash = HashValue(options.MeshOptimization.has_value(), hash);
+        if (options.MeshOptimization) {
+            hash = HashValue(options.MeshOptimization->MinTriangleCount, hash);
+            hash = HashValue(options.MeshOptimization->OverdrawThreshold, hash);
+        }
+        hash = HashValue(options.LodGeneration.has_value(), hash);
+        if (options.LodGeneration) {
+            hash = HashValue(options.LodGeneration->LevelCount, hash);
+            hash = HashValue(options.LodGeneration->ReductionPerLevel, hash);
+            hash = HashValue(options.LodGeneration->MaxError, hash);
+            hash = HashValue(options.LodGeneration->MinTriangleCount, hash);
+        }
+        hash = HashValue(options.Tangents.Mode, hash);
+        hash = HashValue(options.MipGeneration.has_value(), hash);
+        if (options.MipGeneration) {
+            hash = HashValue(options.MipGeneration->Filter, hash);
+        }
+        hash = HashValue(options.TextureCompression.has_value(), hash);
+        if (options.TextureCompression) {
+            hash = HashValue(options.TextureCompression->Quality, hash);
+            hash = HashValue(options.TextureCompression->MinPixelCount, hash);
+        }
+        hash = HashValue(options.MeshletGeneration.has_value(), hash);
+        if (options.MeshletGeneration) {
+            hash = HashValue(options.MeshletGeneration->MaxVertices, hash);
+            hash = HashValue(options.MeshletGeneration->MaxTriangles, hash);
+            hash = HashValue(options.MeshletGeneration->MinTriangleCount, hash);
+        }
+        return hash;
+    }
+
+    class CacheWriter {
+    public:
+        explicit CacheWriter(std::ostream& stream)
+            : m_stream(stream) {
+        }
+
+        uint64_t GetOffset() const {
+            return m_offset;
+        }
+
+        void WriteBytes(const void* data, size_t size) {
+            m_stream.write(static_cast<const char*>(data), size);
+            m_offset += size;
+        }
+
+        template <typename T>
+        void Write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only values without pointers can be written.");
+            WriteBytes(&value, sizeof(value));
+        }
+
+        void WriteString(const std::string& value) {
+            Write((uint32_t)value.size());
+            WriteBytes(value.data(), value.size());
+        }
+
+        template <typename T>
+        void WriteArray(const T* values, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only values without pointers can be written.");
+            Write((uint64_t)count);
+            Align();
+            WriteBytes(values, count * sizeof(T));
+        }
+
+        template <typename T>
+        void WriteArray(const std::vector<T>& values) {
+            WriteArray(values.data(), values.size());
+        }
+
+    private:
+        void Align() {
+            constexpr char padding[CacheAlignment]{};
+            WriteBytes(padding, (size_t)((CacheAlignment - m_offset % CacheAlignment) % CacheAlignment));
+        }
+
+        std::ostream& m_stream;
+        uint64_t m_offset{0};
+    };
+
+    class CacheReader {
+    public:
+        CacheReader(const uint8_t* data, size_t size)
+            : m_data(data)
+            , m_size(size) {
+        }
+
+        const uint8_t* ReadBytes(size_t size) {
+            if (size > m_size - m_offset) {
+                throw std::exception("Truncated model cache entry.");
+            }
+            const uint8_t* bytes = m_data + m_offset;
+            m_offset += size;
+            return bytes;
+        }
+
+        template <typename T>
+        T Read() {
+            T value;
+            memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+            return value;
+        }
+
+        std::string ReadString() {
+            const uint32_t size = Read<uint32_t>();
+            return std::string(reinterpret_cast<const char*>(ReadBytes(size)), size);
+        }
+
+        // Returns the array in place, which is aligned for T.
+        template <typename T>
+        const T* ReadArrayInPlace(size_t& count) {
+            const uint64_t arrayCount = Read<uint64_t>();
+            Align();
+            if (arrayCount > (m_size - m_offset) / sizeof(T)) {
+                throw std::exception("Truncated model cache entry.");
+            }
+            count = (size_t)arrayCount;
+            return reinterpret_cast<const T*>(ReadBytes(count * sizeof(T)));
+        }
+
+        template <typename T>
+        std::vector<T> ReadArray() {
+            size_t count;
+            const T* values = ReadArrayInPlace<T>(count);
+            return std::vector<T>(values, values + count);
+        }
+
+    private:
+        void Align() {
+            ReadBytes((CacheAlignment - m_offset % CacheAlignment) % CacheAlignment);
+        }
+
+        const uint8_t* const m_data;
+        const size_t m_size;
+        size_t m_offset{0};
+    };
+
+    void WriteTexture(CacheWriter& writer, const PreparedMaterial::Texture& texture) {
+        writer.Write(texture.Image);
+        writer.Write(texture.Sampler);
+    }
+
+    PreparedMaterial::Texture ReadTexture(CacheReader& reader) {
+        PreparedMaterial::Texture texture;
+        texture.Image = reader.Read<int32_t>();
+        texture.Sampler = reader.Read<int32_t>();
+        return texture;
+    }
+} // namespace
+
+namespace Gltf {
+    ModelCache::ModelCache(std::filesystem::path folder, uint64_t maxSizeBytes)
+        : m_folder(std::move(folder))
+        , m_maxSizeBytes(maxSizeBytes) {
+        std::error_code error;
+        std::filesystem::create_directories(m_folder, error);
+    }
+
+    std::unique_ptr<PreparedModel> ModelCache::PrepareGltfBinary(_In_reads_bytes_(bufferBytes) const uint8_t* buffer,
+                                                                 uint32_t bufferBytes,
+                                                                 const LoadOptions& options) {
+        return Prepare(HashBytes(buffer, bufferBytes), options, [&] { return Gltf::PrepareGltfBinary(buffer, bufferBytes, options); });
+    }
+
+    std::unique_ptr<PreparedModel> ModelCache::PrepareGltfFile(const std::filesystem::path& path, const LoadOptions& options) {
+        const sample::MappedFile file(path);
+        if (file.Size() > std::numeric_limits<uint32_t>::max()) {
+            throw std::exception("glTF binary files larger than 4 GB are not supported.");
+        }
+
+        return PrepareGltfBinary(file.Data(), (uint32_t)file.Size(), options);
+    }
+
+    std::unique_ptr<PreparedModel> ModelCache::PrepareGltfBinary(std::string_view key,
+                                                                 const std::function<std::vector<uint8_t>()>& readContent,
+                                                                 const LoadOptions& options) {
+        // Keys are hashed separately from content, so that a key cannot name the entry of some content.
+        constexpr std::string_view KeyPrefix = "key:";
+        const uint64_t sourceHash = HashBytes(key.data(), key.size(), HashBytes(KeyPrefix.data(), KeyPrefix.size()));
+        return Prepare(sourceHash, options, [&] {
+            const std::vector<uint8_t> content = readContent();
+            return Gltf::PrepareGltfBinary(content.data(), (uint32_t)content.size(), options);
+        });
+    }
+
+    template <typename TPrepare>
+    std::unique_ptr<PreparedModel> ModelCache::Prepare(uint64_t sourceHash, const LoadOptions& options, TPrepare&& prepare) const {
+        const uint64_t optionsHash = HashOptions(options);
+        const std::filesystem::path path = m_folder / fmt::format(L"{:016x}-{:016x}{}", sourceHash, optionsHash, CacheExtension);
+
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            try {
+                std::unique_ptr<PreparedModel> preparedModel = Read(path, sourceHash, optionsHash);
+                PreparedModel::Impl& impl = *preparedModel->m_impl;
+                impl.VertexFormat = Internal::SelectVertexFormat(options, impl.MeshQuantization);
+                impl.TextureCache = options.TextureCache;
+                return preparedModel;
+            } catch (const std::exception& ex) {
+                sample::Trace("Preparing the model again, since its cache entry cannot be used: {}", ex.what());
+            }
+        }
+
+        std::unique_ptr<PreparedModel> preparedModel = prepare();
+        Write(path, sourceHash, optionsHash, *preparedModel);
+        return preparedModel;
+    }
+
+    std::unique_ptr<PreparedModel> ModelCache::Read(const std::filesystem::path& path, uint64_t sourceHash, uint64_t optionsHash) const {
+        auto file = std::make_shared<sample::MappedFile>(path);
+        CacheReader reader(file->Data(), file->Size());
+
+        const CacheHeader header = reader.Read<CacheHeader>();
+        if (header.Magic != CacheMagic || header.FormatVersion != CacheFormatVersion || header.LoaderVersion != LoaderVersion) {
+            throw std::exception("The model cache entry was written by another version.");
+        }
+        if (header.SourceHash != sourceHash || header.OptionsHash != optionsHash || header.Size != file->Size()) {
+            throw std::exception("The model cache entry does not match its source.");
+        }
+
+        auto prepared = std::make_unique<PreparedModel::Impl>();
+
+        // The root node is created along with the model, and the other nodes follow their parents.
+        prepared->Model = std::make_shared<Pbr::Model>();
+        const uint32_t nodeCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < nodeCount; i++) {
+            const XMFLOAT4X4 transform = reader.Read<XMFLOAT4X4>();
+            const Pbr::NodeIndex_t parentIndex = reader.Read<Pbr::NodeIndex_t>();
+            if (parentIndex >= prepared->Model->GetNodeCount()) {
+                throw std::exception("Invalid node in model cache entry.");
+            }
+            const Pbr::NodeIndex_t nodeIndex = prepared->Model->AddNode(XMLoadFloat4x4(&transform), parentIndex, reader.ReadString());
+            prepared->Model->GetNode(nodeIndex).SetMorphWeights(reader.ReadArray<float>());
+        }
+
+        prepared->BoundsMin = reader.Read<XMFLOAT3>();
+        prepared->BoundsMax = reader.Read<XMFLOAT3>();
+        prepared->MeshQuantization = reader.Read<uint8_t>() != 0;
+        prepared->Samplers = reader.ReadArray<PreparedSampler>();
+
+        const uint32_t materialCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < materialCount; i++) {
+            PreparedMaterial& material = prepared->Materials[reader.Read<int32_t>()];
+            material.Name = reader.ReadString();
+            material.BaseColorTexture = ReadTexture(reader);
+            material.MetallicRoughnessTexture = ReadTexture(reader);
+            material.EmissiveTexture = ReadTexture(reader);
+            material.NormalTexture = ReadTexture(reader);
+            material.OcclusionTexture = ReadTexture(reader);
+            material.BaseColorFactor = reader.Read<XMFLOAT4>();
+            material.MetallicFactor = reader.Read<float>();
+            material.RoughnessFactor = reader.Read<float>();
+            material.EmissiveFactor = reader.Read<XMFLOAT3>();
+            material.NormalScale = reader.Read<float>();
+            material.OcclusionStrength = reader.Read<float>();
+            material.AlphaMode = reader.Read<GltfHelper::AlphaMode>();
+            material.AlphaCutoff = reader.Read<float>();
+            material.DoubleSided = reader.Read<uint8_t>() != 0;
+        }
+
+        const uint32_t primitiveGroupCount = reader.Read<uint32_t>();
+        for (uint32_t i = 0; i < primitiveGroupCount; i++) {
+            const int32_t materialIndex = reader.Read<int32_t>();
+            if (materialIndex != -1 && prepared->Materials.count(materialIndex) == 0) {
+                throw std::exception("Invalid material in model cache entry.");
+            }
+
+            auto& primitiveBuilderPair = prepared->PrimitiveBuilders.emplace_back(materialIndex, std::vector<Pbr::PrimitiveBuilder>{});
+            std::vector<Pbr::PrimitiveBuilder>& primitiveBuilders = primitiveBuilderPair.second;
+            primitiveBuilders.resize(reader.Read<uint32_t>());
+            for (Pbr::PrimitiveBuilder& primitiveBuilder : primitiveBuilders) {
+                primitiveBuilder.Vertices = reader.ReadArray<Pbr::Vertex>();
+                primitiveBuilder.Indices = reader.ReadArray<uint32_t>();
+                primitiveBuilder.Lods = reader.ReadArray<Pbr::PrimitiveLod>();
+                primitiveBuilder.Meshlets = reader.ReadArray<Pbr::PrimitiveMeshlet>();
+
+                // The indices, levels of detail and meshlets are read by the renderer without checks, so an entry which is
+                // truncated or stale must not get this far.
+                const size_t vertexCount = primitiveBuilder.Vertices.size();
+                const size_t indexCount = primitiveBuilder.Indices.size();
+                const auto inIndices = [indexCount](uint32_t startIndex, uint32_t count) {
+                    return (uint64_t)startIndex + count <= indexCount && count % 3 == 0;
+                };
+                const auto validLod = [&](const Pbr::PrimitiveLod& lod) { return inIndices(lod.StartIndex, lod.IndexCount); };
+                const auto validMeshlet = [&](const Pbr::PrimitiveMeshlet& meshlet) {
+                    return inIndices(meshlet.StartIndex, meshlet.IndexCount);
+                };
+                const auto validIndex = [vertexCount](uint32_t index) { return index < vertexCount; };
+                if (indexCount % 3 != 0 || !std::all_of(primitiveBuilder.Indices.begin(), primitiveBuilder.Indices.end(), validIndex) ||
+                    !std::all_of(primitiveBuilder.Lods.begin(), primitiveBuilder.Lods.end(), validLod) ||
+                    !std::all_of(primitiveBuilder.Meshlets.begin(), primitiveBuilder.Meshlets.end(), validMeshlet)) {
+                    throw std::exception("Invalid primitive in model cache entry.");
+                }
+
+                primitiveBuilder.MorphNode = reader.Read<Pbr::NodeIndex_t>();
+                primitiveBuilder.MorphTargets.resize(reader.Read<uint32_t>());
+                for (Pbr::PrimitiveMorphTarget& target : primitiveBuilder.MorphTargets) {
+                    target.Vertices = reader.ReadArray<uint32_t>();
+                    target.PositionDeltas = reader.ReadArray<XMFLOAT3>();
+                    target.NormalDeltas = reader.ReadArray<XMFLOAT3>();
+                    target.TangentDeltas = reader.ReadArray<XMFLOAT3>();
+                    const auto validDeltas = [&target](const std::vector<XMFLOAT3>& deltas) {
+                        return deltas.empty() || deltas.size() == target.Vertices.size();
+                    };
+                    if (primitiveBuilder.MorphNode >= prepared->Model->GetNodeCount() || !validDeltas(target.PositionDeltas) ||
+                        !validDeltas(target.NormalDeltas) || !validDeltas(target.TangentDeltas) ||
+                        (!target.Vertices.empty() && target.Vertices.back() >= primitiveBuilder.Vertices.size())) {
+                        throw std::exception("Invalid morph target in model cache entry.");
+                    }
+                }
+                prepared->Memory.GeometryBytes += Internal::GetMemoryBytes(primitiveBuilder);
+            }
+        }
+
+        // The pixels are uploaded straight from the mapped entry, which is kept open until bgfx has read them.
+        prepared->Memory.SourceBytes = file->Size();
+        prepared->SourceSizes.emplace(file.get(), file->Size());
+        prepared->Images.resize(reader.Read<uint32_t>());
+        for (PreparedImage& image : prepared->Images) {
+            image.Width = reader.Read<int32_t>();
+            image.Height = reader.Read<int32_t>();
+            image.MipCount = reader.Read<uint32_t>();
+            image.Format = reader.Read<ImageFormat>();
+            image.ContentHash = reader.Read<uint64_t>();
+            size_t pixelBytes;
+            image.Data = reader.ReadArrayInPlace<uint8_t>(pixelBytes);
+            if (pixelBytes == 0) {
+                image.Data = nullptr; // The image failed to decode when the entry was written.
+            } else if (image.Width <= 0 || image.Height <= 0 || image.Format > ImageFormat::BC6H || image.MipCount == 0 ||
+                       image.MipCount > Pbr::GetMipCount((uint32_t)image.Width, (uint32_t)image.Height) || pixelBytes != image.GetSize()) {
+                throw std::exception("Invalid image in model cache entry.");
+            } else {
+                image.Storage = file;
+            }
+        }
+        prepared->RecordMemory();
+        prepared->ReleaseUnreferencedSources();
+
+        for (const auto& [materialIndex, material] : prepared->Materials) {
+            for (const PreparedMaterial::Texture* texture : {&material.BaseColorTexture,
+                                                             &material.MetallicRoughnessTexture,
+                                                             &material.EmissiveTexture,
+                                                             &material.NormalTexture,
+                                                             &material.OcclusionTexture}) {
+                if (texture->Image < -1 || texture->Image >= (int32_t)prepared->Images.size() || texture->Sampler < -1 ||
+                    texture->Sampler >= (int32_t)prepared->Samplers.size()) {
+                    throw std::exception("Invalid texture in model cache entry.");
+                }
+            }
+        }
+
+        return std::make_unique<PreparedModel>(std::move(prepared));
+    }
+
+    void ModelCache::Write(const std::filesystem::path& path,
+                           uint64_t sourceHash,
+                           uint64_t optionsHash,
+                           const PreparedModel& preparedModel) const {
+        const PreparedModel::Impl& prepared = *preparedModel.m_impl;
+
+        // Write to a file of this thread, and move it in place once complete, so readers never see a partial entry.
+        std::filesystem::path temporaryPath = path;
+        temporaryPath += fmt::format(L".{}.tmp", ::GetCurrentThreadId());
+        try {
+            std::ofstream stream;
+            stream.exceptions(std::ios::failbit | std::ios::badbit);
+            stream.open(temporaryPath, std::ios::binary | std::ios::trunc);
+            CacheWriter writer(stream);
+
+            CacheHeader header{CacheMagic, CacheFormatVersion, LoaderVersion, 0, sourceHash, optionsHash, 0};
+            writer.Write(header);
+
+            const Pbr::NodeIndex_t nodeCount = prepared.Model->GetNodeCount();
+            writer.Write((uint32_t)(nodeCount - 1));
+            for (Pbr::NodeIndex_t nodeIndex = Pbr::RootNodeIndex + 1; nodeIndex < nodeCount; nodeIndex++) {
+                const Pbr::Node& node = prepared.Model->GetNode(nodeIndex);
+                XMFLOAT4X4 transform;
+                XMStoreFloat4x4(&transform, node.GetTransform());
+                writer.Write(transform);
+                writer.Write(node.ParentNodeIndex);
+                writer.WriteString(node.Name);
+                writer.WriteArray(node.GetMorphWeights());
+            }
+
+            writer.Write(prepared.BoundsMin);
+            writer.Write(prepared.BoundsMax);
+            writer.Write((uint8_t)prepared.MeshQuantization);
+            writer.WriteArray(prepared.Samplers);
+
+            writer.Write((uint32_t)prepared.Materials.size());
+            for (const auto& [materialIndex, material] : prepared.Materials) {
+                writer.Write((int32_t)materialIndex);
+                writer.WriteString(material.Name);
+                WriteTexture(writer, material.BaseColorTexture);
+                WriteTexture(writer, material.MetallicRoughnessTexture);
+                WriteTexture(writer, material.EmissiveTexture);
+                WriteTexture(writer, material.NormalTexture);
+                WriteTexture(writer, material.OcclusionTexture);
+                writer.Write(material.BaseColorFactor);
+                writer.Write(material.MetallicFactor);
+                writer.Write(material.RoughnessFactor);
+                writer.Write(material.EmissiveFactor);
+                writer.Write(material.NormalScale);
+                writer.Write(material.OcclusionStrength);
+                writer.Write(material.AlphaMode);
+                writer.Write(material.AlphaCutoff);
+                writer.Write((uint8_t)material.DoubleSided);
+            }
+
+            writer.Write((uint32_t)prepared.PrimitiveBuilders.size());
+            for (const auto& [materialIndex, primitiveBuilders] : prepared.PrimitiveBuilders) {
+                writer.Write((int32_t)materialIndex);
+                writer.Write((uint32_t)primitiveBuilders.size());
+                for (const Pbr::PrimitiveBuilder& primitiveBuilder : primitiveBuilders) {
+                    writer.WriteArray(primitiveBuilder.Vertices);
+                    writer.WriteArray(primitiveBuilder.Indices);
+                    writer.WriteArray(primitiveBuilder.Lods);
+                    writer.WriteArray(primitiveBuilder.Meshlets);
+                    writer.Write(primitiveBuilder.MorphNode);
+                    writer.Write((uint32_t)primitiveBuilder.MorphTargets.size());
+                    for (const Pbr::PrimitiveMorphTarget& target : primitiveBuilder.MorphTargets) {
+                        writer.WriteArray(target.Vertices);
+                        writer.WriteArray(target.PositionDeltas);
+                        writer.WriteArray(target.NormalDeltas);
+                        writer.WriteArray(target.TangentDeltas);
+                    }
+                }
+            }
+
+            writer.Write((uint32_t)prepared.Images.size());
+            for (const PreparedImage& image : prepared.Images) {
+                writer.Write((int32_t)image.Width);
+                writer.Write((int32_t)image.Height);
+                writer.Write(image.MipCount);
+                writer.Write(image.Format);
+                writer.Write(image.ContentHash);
+                writer.WriteArray(image.Data, image.Data != nullptr ? image.GetSize() : 0);
+            }
+
+            header.Size = writer.GetOffset();
+            stream.seekp(0);
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream.close();
+
+            std::filesystem::rename(temporaryPath, path);
+        } catch (const std::exception& ex) {
+            sample::Trace("Failed to write model cache entry: {}", ex.what());
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+
+        Trim(path);
+    }
+
+    void ModelCache::Trim(const std::filesystem::path& keptPath) const {
+        struct Entry {
+            std::filesystem::path Path;
+            std::filesystem::file_time_type WriteTime;
+            uint64_t Size;
+        };
+
+        std::vector<Entry> entries;
+        uint64_t totalSize = 0;
+        try {
+            for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(m_folder)) {
+                if (file.path().extension() == CacheExtension) {
+                    const uint64_t size = file.file_size();
+                    totalSize += size;
+                    if (file.path() != keptPath) {
+                        entries.push_back({file.path(), file.last_write_time(), size});
+                    }
+                }
+            }
+        } catch (const std::exception& ex) {
+            sample::Trace("Failed to list model cache entries: {}", ex.what());
+            return;
+        }
+        if (totalSize <= m_maxSizeBytes) {
+            return;
+        }
+
+        // Entries mapped by a load in progress cannot be deleted, and are left for a later trim.
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.WriteTime < b.WriteTime; });
+        std::error_code error;
+        for (const Entry& entry : entries) {
+            if (totalSize <= m_maxSizeBytes) {
+                break;
+            }
+            if (std::filesystem::remove(entry.Path, error)) {
+                totalSize -= entry.Size;
+            }
+        }
+    }
+} // namespace Gltf
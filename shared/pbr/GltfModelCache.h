@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// On-disk cache of prepared glTF models.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "GltfLoader.h"
+
+namespace Gltf
+{
+    // Caches prepared models in a folder, so that loading content which was loaded before skips decoding and processing it: the
+    // cached geometry, materials and RGBA images are read from a memory-mapped file and then uploaded. Entries are validated by
+    // the hash of the source content, the loader version and the processing options, and invalid entries are prepared again.
+    // Writing an entry is best effort, and does not fail the load. Once the entries in the folder add up to more than maxSizeBytes,
+    // the least recently written ones are deleted after each write. The methods can be called from any thread.
+    class ModelCache final
+    {
+    public:
+        static constexpr uint64_t DefaultMaxSizeBytes = 1024ull * 1024 * 1024;
+
+        explicit ModelCache(std::filesystem::path folder, uint64_t maxSizeBytes = DefaultMaxSizeBytes);
+
+        // Prepares glTF 2.0 GLB file content, identified by its hash.
+        std::unique_ptr<PreparedModel> PrepareGltfBinary(
+            _In_reads_bytes_(bufferBytes) const uint8_t* buffer,
+            uint32_t bufferBytes,
+            const LoadOptions& options = {});
+
+        // Prepares a glTF 2.0 GLB file, identified by the hash of its content.
+        std::unique_ptr<PreparedModel> PrepareGltfFile(const std::filesystem::path& path, const LoadOptions& options = {});
+
+        // Prepares GLB content identified by a key, such as a controller model key, which always refers to the same content.
+        // readContent is only called when the key is not cached.
+        std::unique_ptr<PreparedModel> PrepareGltfBinary(
+            std::string_view key,
+            const std::function<std::vector<uint8_t>()>& readContent,
+            const LoadOptions& options = {});
+
+    private:
+        template <typename TPrepare>
+        std::unique_ptr<PreparedModel> Prepare(uint64_t sourceHash, const LoadOptions& options, TPrepare&& prepare) const;
+
+        std::unique_ptr<PreparedModel> Read(const std::filesystem::path& path, uint64_t sourceHash, uint64_t optionsHash) const;
+        void Write(const std::filesystem::path& path, uint64_t sourceHash, uint64_t optionsHash, const PreparedModel& preparedModel) const;
+
+        // Delete the least recently written entries, other than keptPath, until the folder fits in the size bound.
+        void Trim(const std::filesystem::path& keptPath) const;
+
+        const std::filesystem::path m_folder;
+        const uint64_t m_maxSizeBytes;
+    };
+}
@@ -0,0 +1,187 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "GltfModelLoader.h"
+#include <algorithm>
+
+namespace {
+    // Loads are prepared one at a time, each using all of the worker threads.
+    constexpr size_t LoadThreadCount = 1;
+
+    size_t GetWorkerThreadCount() {
+        // Leave threads for rendering and the frame loop.
+        return std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+    }
+
+    Gltf::ModelLoadState GetLoadState(Gltf::PreparedModel::Stage stage) {
+        switch (stage) {
+        case Gltf::PreparedModel::Stage::Geometry:
+            return Gltf::ModelLoadState::Proxy;
+        case Gltf::PreparedModel::Stage::Textures:
+            return Gltf::ModelLoadState::Geometry;
+        default:
+            return Gltf::ModelLoadState::Complete;
+        }
+    }
+
+    bool IsLoadOver(Gltf::ModelLoadState state) {
+        return state == Gltf::ModelLoadState::Complete || state == Gltf::ModelLoadState::Failed ||
+               state == Gltf::ModelLoadState::Canceled;
+    }
+} // namespace
+
+namespace Gltf {
+    void ModelLoadHandle::Cancel() {
+        if (m_state != ModelLoadState::Complete && m_state != ModelLoadState::Failed) {
+            m_state = ModelLoadState::Canceled;
+            m_canceled = true;
+        }
+    }
+
+    void ModelLoadHandle::SetState(ModelLoadState state) {
+        if (m_state == state || m_state == ModelLoadState::Canceled) {
+            return;
+        }
+
+        m_state = state;
+        if (m_callback) {
+            m_callback(*this);
+        }
+    }
+
+    ModelLoader::ModelLoader(const Pbr::Resources& pbrResources, std::shared_ptr<ModelCache> cache, size_t uploadBudgetPerFrame)
+        : m_pbrResources(pbrResources)
+        , m_cache(std::move(cache))
+        , m_uploadBudgetPerFrame(uploadBudgetPerFrame)
+        , m_workerThreads(GetWorkerThreadCount())
+        , m_loadThreads(LoadThreadCount) {
+    }
+
+    ModelLoader::~ModelLoader() {
+        // Cancel the loads which are not over, so that the load threads skip those still queued instead of preparing them
+        // before they are joined.
+        for (const std::weak_ptr<ModelLoadHandle>& weakHandle : m_pendingHandles) {
+            if (const std::shared_ptr<ModelLoadHandle> handle = weakHandle.lock()) {
+                handle->Cancel();
+            }
+        }
+    }
+
+    std::shared_ptr<ModelLoadHandle> ModelLoader::LoadBinary(std::function<std::vector<uint8_t>()> readContent,
+                                                             LoadOptions options,
+                                                             ModelLoadHandle::Callback callback,
+                                                             std::string cacheKey) {
+        return Start(
+            [cache = m_cache, readContent = std::move(readContent), cacheKey = std::move(cacheKey)](const LoadOptions& options) {
+                if (cache && !cacheKey.empty()) {
+                    return cache->PrepareGltfBinary(cacheKey, readContent, options);
+                }
+
+                const std::vector<uint8_t> content = readContent();
+                return cache ? cache->PrepareGltfBinary(content.data(), (uint32_t)content.size(), options)
+                             : PrepareGltfBinary(content.data(), (uint32_t)content.size(), options);
+            },
+            std::move(options),
+            std::move(callback));
+    }
+
+    std::shared_ptr<ModelLoadHandle> ModelLoader::LoadFile(std::filesystem::path path,
+                                                           LoadOptions options,
+                                                           ModelLoadHandle::Callback callback) {
+        return Start(
+            [cache = m_cache, path = std::move(path)](const LoadOptions& options) {
+                return cache ? cache->PrepareGltfFile(path, options) : PrepareGltfFile(path, options);
+            },
+            std::move(options),
+            std::move(callback));
+    }
+
+    std::shared_ptr<ModelLoadHandle> ModelLoader::Start(PrepareFunction prepare, LoadOptions options, ModelLoadHandle::Callback callback) {
+        if (options.ThreadPool == nullptr) {
+            options.ThreadPool = &m_workerThreads;
+        }
+
+        auto handle = std::make_shared<ModelLoadHandle>();
+        handle->m_callback = std::move(callback);
+
+        // The handle's state is not touched here, since it belongs to the update thread.
+        m_loadThreads.Submit([this, handle, prepare = std::move(prepare), options = std::move(options)] {
+            if (handle->m_canceled) {
+                return;
+            }
+
+            Load load{handle};
+            try {
+                load.Prepared = prepare(options);
+            } catch (...) {
+                load.Error = std::current_exception();
+            }
+
+            std::lock_guard lock(m_preparedLoadsMutex);
+            m_preparedLoads.push_back(std::move(load));
+        });
+
+        m_pendingHandles.push_back(handle);
+        return handle;
+    }
+
+    void ModelLoader::Update() {
+        std::vector<Load> preparedLoads;
+        {
+            std::lock_guard lock(m_preparedLoadsMutex);
+            preparedLoads.swap(m_preparedLoads);
+        }
+
+        for (Load& load : preparedLoads) {
+            if (load.Error) {
+                load.Handle->m_error = load.Error;
+                load.Handle->SetState(ModelLoadState::Failed);
+            } else if (load.Handle->GetState() != ModelLoadState::Canceled) {
+                m_uploadingLoads.push_back(std::move(load));
+            }
+        }
+
+        // Loads are uploaded in order, so the first model started is the first one completed.
+        size_t remainingBudget = m_uploadBudgetPerFrame;
+        while (!m_uploadingLoads.empty()) {
+            Load& load = m_uploadingLoads.front();
+            ModelLoadHandle& handle = *load.Handle;
+            if (handle.GetState() == ModelLoadState::Canceled) {
+                m_uploadingLoads.pop_front();
+                continue;
+            }
+
+            size_t uploadedBytes = 0;
+            try {
+                uploadedBytes = load.Prepared->Upload(m_pbrResources, remainingBudget);
+            } catch (...) {
+                handle.m_error = std::current_exception();
+                handle.SetState(ModelLoadState::Failed);
+                m_uploadingLoads.pop_front();
+                continue;
+            }
+
+            handle.m_model = load.Prepared->GetModel();
+            const PreparedModel::Stage stage = load.Prepared->GetStage();
+            handle.SetState(GetLoadState(stage));
+            if (stage != PreparedModel::Stage::Complete) {
+                break; // The budget of this frame is spent.
+            }
+
+            m_uploadingLoads.pop_front();
+            if (uploadedBytes >= remainingBudget) {
+                break;
+            }
+            remainingBudget -= uploadedBytes;
+        }
+
+        m_pendingHandles.erase(std::remove_if(m_pendingHandles.begin(),
+                                              m_pendingHandles.end(),
+                                              [](const std::weak_ptr<ModelLoadHandle>& weakHandle) {
+                                                  const std::shared_ptr<ModelLoadHandle> handle = weakHandle.lock();
+                                                  return !handle || IsLoadOver(handle->GetState());
+                                              }),
+                               m_pendingHandles.end());
+    }
+} // namespace Gltf
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Service which loads glTF 2.0 content in the background, and makes the models renderable progressively.
+//
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <SampleShared/ThreadPool.h>
+#include "GltfLoader.h"
+#include "GltfModelCache.h"
+
+namespace Gltf
+{
+    // Progress of a model load. The states are reached in order, but may be skipped, and a load may fail or be canceled at any point.
+    enum class ModelLoadState
+    {
+        Preparing, // The content is read and processed on the loader's threads. There is no model yet.
+        Proxy,     // The model shows a translucent bounding box, if anything, while its geometry is uploaded.
+        Geometry,  // The model shows all of its geometry, with solid color placeholders while its textures are uploaded.
+        Complete,
+        Failed,
+        Canceled,
+    };
+
+    class ModelLoader;
+
+    // A model loaded by a ModelLoader. Handles are only updated by ModelLoader::Update, so they must be used on the same thread.
+    class ModelLoadHandle final
+    {
+    public:
+        using Callback = std::function<void(const ModelLoadHandle& handle)>;
+
+        ModelLoadState GetState() const
+        {
+            return m_state;
+        }
+
+        // The model, from the Proxy state onwards. It is filled in place as the load progresses, so it can be rendered right away.
+        const std::shared_ptr<Pbr::Model>& GetModel() const
+        {
+            return m_model;
+        }
+
+        // The exception which failed the load.
+        const std::exception_ptr& GetError() const
+        {
+            return m_error;
+        }
+
+        // Stop the load, and its callbacks. The model keeps what was uploaded so far.
+        void Cancel();
+
+    private:
+        friend class ModelLoader;
+        void SetState(ModelLoadState state);
+
+        ModelLoadState m_state{ModelLoadState::Preparing};
+        std::shared_ptr<Pbr::Model> m_model;
+        std::exception_ptr m_error;
+        Callback m_callback;
+        std::atomic<bool> m_canceled{false}; // Read by the load threads, which skip the preparation of canceled loads.
+    };
+
+    // Loads models on background threads, and creates their bgfx resources within a per-frame upload budget so that loading
+    // does not cause frame drops. The callbacks are invoked on the thread calling Update, each time a load changes state.
+    class ModelLoader final
+    {
+    public:
+        static constexpr size_t DefaultUploadBudget = 4 * 1024 * 1024;
+
+        // When a cache is given, the models are prepared through it.
+        explicit ModelLoader(const Pbr::Resources& pbrResources,
+                             std::shared_ptr<ModelCache> cache = nullptr,
+                             size_t uploadBudgetPerFrame = DefaultUploadBudget);
+        ~ModelLoader();
+
+        // Load GLB content returned by readContent, which is called on one of the loader's threads. When a cacheKey is given, it
+        // identifies the content in the cache instead of the content's hash, so cached content is not read at all.
+        std::shared_ptr<ModelLoadHandle> LoadBinary(std::function<std::vector<uint8_t>()> readContent,
+                                                    LoadOptions options = {},
+                                                    ModelLoadHandle::Callback callback = {},
+                                                    std::string cacheKey = {});
+
+        // Load a GLB file.
+        std::shared_ptr<ModelLoadHandle> LoadFile(std::filesystem::path path,
+                                                  LoadOptions options = {},
+                                                  ModelLoadHandle::Callback callback = {});
+
+        // Upload the prepared models in the order their loads were started, and invoke the callbacks of the loads which changed
+        // state. Must be called once per frame on the thread which creates bgfx resources.
+        void Update();
+
+    private:
+        using PrepareFunction = std::function<std::unique_ptr<PreparedModel>(const LoadOptions& options)>;
+
+        struct Load
+        {
+            std::shared_ptr<ModelLoadHandle> Handle;
+            std::unique_ptr<PreparedModel> Prepared;
+            std::exception_ptr Error;
+        };
+
+        std::shared_ptr<ModelLoadHandle> Start(PrepareFunction prepare, LoadOptions options, ModelLoadHandle::Callback callback);
+
+        const Pbr::Resources& m_pbrResources;
+        const std::shared_ptr<ModelCache> m_cache;
+        const size_t m_uploadBudgetPerFrame;
+
+        std::mutex m_preparedLoadsMutex;
+        std::vector<Load> m_preparedLoads; // Guarded by m_preparedLoadsMutex.
+        std::deque<Load> m_uploadingLoads;
+        std::vector<std::weak_ptr<ModelLoadHandle>> m_pendingHandles; // Loads not over yet, canceled when the loader is destroyed.
+
+        // The worker threads read primitives and decode images for the load threads, which prepare one model each at a time.
+        // The load threads are declared last so that they are joined first.
+        sample::ThreadPool m_workerThreads;
+        sample::ThreadPool m_loadThreads;
+    };
+}
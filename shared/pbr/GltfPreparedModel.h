@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Internal representation of a prepared glTF model, shared by the loader and the model cache.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "..\Gltf\GltfHelper.h"
+#include "GltfLoader.h"
+#include "PbrMaterial.h"
+
+namespace Gltf
+{
+    namespace Internal
+    {
+        // Layout of the pixels of a prepared image.
+        enum class ImageFormat : uint32_t
+        {
+            RGBA8,
+            R8, // Grey images which are only used for occlusion, which is read from the red channel.
+
+            // Block compressed images, made of 4x4 blocks of 8 (BC1, BC4) or 16 (BC2, BC3, BC5, BC6H, BC7) bytes.
+            BC1,
+            BC3,
+            BC4, // Compressed from R8.
+            BC7,
+            BC2, // Only read from MSFT_texture_dds images, as are BC5 and BC6H.
+            BC5,
+            BC6H,
+        };
+
+        // Pixels of a decoded image, owned by Pixels or by Storage, or else by the caller of the load, such as the glTF model given
+        // to FromGltfObject. Images with mips hold all of their levels one after another, from the largest.
+        struct PreparedImage
+        {
+            std::vector<uint8_t> Pixels;
+            const uint8_t* Data{nullptr};
+            std::shared_ptr<const void> Storage; // Owner of Data when it is read in place, such as a mapped file, which bgfx then reads.
+            int Width{0};
+            int Height{0};
+            uint32_t MipCount{1};
+            ImageFormat Format{ImageFormat::RGBA8};
+            uint64_t ContentHash{0}; // Hash of the layout and pixels, which identifies the texture in the texture cache.
+
+            size_t GetLevelSize(uint32_t level) const
+            {
+                const size_t width = std::max(1, Width >> level);
+                const size_t height = std::max(1, Height >> level);
+                const size_t blockCount = ((width + 3) / 4) * ((height + 3) / 4);
+                switch (Format)
+                {
+                case ImageFormat::R8:
+                    return width * height;
+                case ImageFormat::BC1:
+                case ImageFormat::BC4:
+                    return blockCount * 8;
+                case ImageFormat::BC2:
+                case ImageFormat::BC3:
+                case ImageFormat::BC5:
+                case ImageFormat::BC6H:
+                case ImageFormat::BC7:
+                    return blockCount * 16;
+                default:
+                    return width * height * 4;
+                }
+            }
+
+            size_t GetSize() const
+            {
+                size_t size = 0;
+                for (uint32_t level = 0; level < MipCount; level++)
+                {
+                    size += GetLevelSize(level);
+                }
+                return size;
+            }
+        };
+
+        // Filtering and wrapping modes of a glTF sampler.
+        struct PreparedSampler
+        {
+            int MinFilter;
+            int MagFilter;
+            int WrapS;
+            int WrapT;
+        };
+
+        // A metallic-roughness material read from glTF. Unlike GltfHelper::Material, its textures refer to the images and samplers
+        // of the prepared model by index, so that it does not depend on the glTF model.
+        struct PreparedMaterial
+        {
+            struct Texture
+            {
+                int32_t Image{-1};
+                int32_t Sampler{-1};
+            };
+
+            std::string Name;
+
+            Texture BaseColorTexture;
+            Texture MetallicRoughnessTexture;
+            Texture EmissiveTexture;
+            Texture NormalTexture;
+            Texture OcclusionTexture;
+
+            DirectX::XMFLOAT4 BaseColorFactor;
+            float MetallicFactor;
+            float RoughnessFactor;
+            DirectX::XMFLOAT3 EmissiveFactor;
+
+            float NormalScale;
+            float OcclusionStrength;
+
+            GltfHelper::AlphaMode AlphaMode;
+            float AlphaCutoff;
+            bool DoubleSided;
+        };
+
+        // CPU memory of the arrays of a primitive builder.
+        inline size_t GetMemoryBytes(const Pbr::PrimitiveBuilder& primitiveBuilder)
+        {
+            size_t bytes = primitiveBuilder.Vertices.size() * sizeof(Pbr::Vertex) + primitiveBuilder.Indices.size() * sizeof(uint32_t) +
+                           primitiveBuilder.Lods.size() * sizeof(Pbr::PrimitiveLod) +
+                           primitiveBuilder.Meshlets.size() * sizeof(Pbr::PrimitiveMeshlet);
+            for (const Pbr::PrimitiveMorphTarget& target : primitiveBuilder.MorphTargets)
+            {
+                const size_t deltaCount = target.PositionDeltas.size() + target.NormalDeltas.size() + target.TangentDeltas.size();
+                bytes += target.Vertices.size() * sizeof(uint32_t) + deltaCount * sizeof(DirectX::XMFLOAT3);
+            }
+            return bytes;
+        }
+
+        // Quantized models are given compact vertex buffers, whose precision about matches theirs, unless the options opt out.
+        inline Pbr::VertexFormat SelectVertexFormat(const LoadOptions& options, bool meshQuantization)
+        {
+            return meshQuantization && options.CompactQuantizedModels ? Pbr::VertexFormat::Compact : options.VertexFormat;
+        }
+
+        // A texture of a material which is created after the geometry, replacing the solid color placeholder the material starts with.
+        struct TextureBinding
+        {
+            std::shared_ptr<Pbr::Material> Material;
+            Pbr::ShaderSlots::PSMaterial Slot;
+            int32_t Image;
+            bool SRGB;
+            shared_bgfx_handle<bgfx::UniformHandle> Sampler;
+        };
+    }
+
+    struct PreparedModel::Impl
+    {
+        // Results of the CPU stage. They do not refer to the glTF model, so that they can also be read from a model cache.
+        std::shared_ptr<Pbr::Model> Model;
+        Pbr::VertexFormat VertexFormat{Pbr::VertexFormat::Full};
+        bool MeshQuantization{false}; // Whether the model uses KHR_mesh_quantization, which decides the vertex format.
+        std::map<int, Internal::PreparedMaterial> Materials;
+        std::vector<std::pair<int, std::vector<Pbr::PrimitiveBuilder>>> PrimitiveBuilders; // Grouped by material, in material order.
+        std::vector<Internal::PreparedSampler> Samplers;
+        std::vector<Internal::PreparedImage> Images;
+        std::map<const void*, size_t> SourceSizes; // Sizes of the storage the images read in place, while an image still does.
+        std::shared_ptr<Gltf::TextureCache> TextureCache;
+        DirectX::XMFLOAT3 BoundsMin{};
+        DirectX::XMFLOAT3 BoundsMax{};
+
+        // Progress of the GPU stage.
+        PreparedModel::Stage CurrentStage{PreparedModel::Stage::Geometry};
+        bool MaterialsCreated{false};
+        std::map<int, std::shared_ptr<Pbr::Material>> MaterialMap;
+        size_t NextMaterialGroup{0};
+        size_t NextPrimitiveBuilder{0};
+        std::vector<Pbr::Primitive> Primitives; // Created, but only added to the model once all of them are.
+        std::vector<Internal::TextureBinding> TextureBindings;
+        size_t NextTextureBinding{0};
+        std::map<std::tuple<int32_t, bool>, shared_bgfx_handle<bgfx::TextureHandle>> Textures;
+        std::vector<uint32_t> ImageBindingCounts; // Texture bindings left per image, after the last of which the image is released.
+        LoadMemoryReport Memory{};
+
+        // Create the materials with solid color placeholders for their textures, and record which textures replace them.
+        void CreateMaterials(const Pbr::Resources& pbrResources);
+
+        // Create a translucent box over the bounds of the primitives, shown until they are all created.
+        void CreateProxy(const Pbr::Resources& pbrResources);
+
+        // Raise the high-water mark to the memory held now, after Memory is updated.
+        void RecordMemory();
+
+        // Release the pixels of an image, and the storage it read them from if no other image does.
+        void ReleaseImage(int32_t image);
+
+        // Stop counting the storage which no image reads from anymore, which is then released unless bgfx still reads it.
+        void ReleaseUnreferencedSources();
+    };
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "GltfTextureCache.h"
+
+namespace {
+    constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+    uint64_t RotateLeft(uint64_t value, uint32_t bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    template <typename T>
+    T Read(const uint8_t* bytes) {
+        T value;
+        memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    uint64_t Round(uint64_t accumulator, uint64_t input) {
+        return RotateLeft(accumulator + input * Prime2, 31) * Prime1;
+    }
+
+    uint64_t MergeRound(uint64_t hash, uint64_t accumulator) {
+        return (hash ^ Round(0, accumulator)) * Prime1 + Prime4;
+    }
+} // namespace
+
+namespace Gltf {
+    const std::shared_ptr<TextureCache>& TextureCache::GetShared() {
+        static const std::shared_ptr<TextureCache> sharedCache = std::make_shared<TextureCache>();
+        return sharedCache;
+    }
+
+    uint64_t TextureCache::HashContent(_In_reads_bytes_(size) const void* data, size_t size, uint64_t seed) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        const uint8_t* const end = bytes + size;
+
+        // Four independent lanes of 8 bytes each, which the CPU processes in parallel.
+        uint64_t hash;
+        if (size >= 32) {
+            uint64_t lanes[4] = {seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1};
+            for (; bytes + 32 <= end; bytes += 32) {
+                for (uint32_t lane = 0; lane < 4; lane++) {
+                    lanes[lane] = Round(lanes[lane], Read<uint64_t>(bytes + lane * 8));
+                }
+            }
+            hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+            for (const uint64_t lane : lanes) {
+                hash = MergeRound(hash, lane);
+            }
+        } else {
+            hash = seed + Prime5;
+        }
+        hash += size;
+
+        for (; bytes + 8 <= end; bytes += 8) {
+            hash = RotateLeft(hash ^ Round(0, Read<uint64_t>(bytes)), 27) * Prime1 + Prime4;
+        }
+        if (bytes + 4 <= end) {
+            hash = RotateLeft(hash ^ (Read<uint32_t>(bytes) * Prime1), 23) * Prime2 + Prime3;
+            bytes += 4;
+        }
+        for (; bytes < end; bytes++) {
+            hash = RotateLeft(hash ^ (*bytes * Prime5), 11) * Prime1;
+        }
+
+        // Finalize so that every input bit affects every output bit.
+        hash = (hash ^ (hash >> 33)) * Prime2;
+        hash = (hash ^ (hash >> 29)) * Prime3;
+        return hash ^ (hash >> 32);
+    }
+
+    shared_bgfx_handle<bgfx::TextureHandle> TextureCache::Find(uint64_t contentHash, bool sRGB, size_t size) {
+        std::lock_guard lock(m_mutex);
+        shared_bgfx_handle<bgfx::TextureHandle> texture;
+        if (const auto it = m_textures.find({contentHash, sRGB}); it != m_textures.end()) {
+            texture = it->second.lock();
+        }
+        if (texture) {
+            m_statistics.Hits++;
+            m_statistics.BytesSaved += size;
+        }
+        return texture;
+    }
+
+    shared_bgfx_handle<bgfx::TextureHandle> TextureCache::Insert(uint64_t contentHash,
+                                                                 bool sRGB,
+                                                                 shared_bgfx_handle<bgfx::TextureHandle> texture) {
+        std::lock_guard lock(m_mutex);
+        m_statistics.Misses++;
+        WeakTexture& cachedTexture = m_textures[{contentHash, sRGB}];
+        if (shared_bgfx_handle<bgfx::TextureHandle> otherTexture = cachedTexture.lock()) {
+            return otherTexture;
+        }
+
+        cachedTexture = texture;
+        RemoveReleasedTextures();
+        return texture;
+    }
+
+    TextureCacheStatistics TextureCache::GetStatistics() const {
+        std::lock_guard lock(m_mutex);
+        TextureCacheStatistics statistics = m_statistics;
+        statistics.TextureCount = m_textures.size();
+        return statistics;
+    }
+
+    void TextureCache::RemoveReleasedTextures() {
+        if (m_textures.size() < m_removalThreshold) {
+            return;
+        }
+
+        for (auto it = m_textures.begin(); it != m_textures.end();) {
+            it = it->second.expired() ? m_textures.erase(it) : std::next(it);
+        }
+        m_removalThreshold = std::max<size_t>(64, m_textures.size() * 2);
+    }
+} // namespace Gltf
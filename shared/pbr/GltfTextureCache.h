@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Process-wide cache of the textures of glTF models, shared by content.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "PbrCommon.h"
+
+namespace Gltf
+{
+    struct TextureCacheStatistics
+    {
+        uint64_t Hits;
+        uint64_t Misses;     // Textures which were created and inserted after Find missed.
+        uint64_t BytesSaved; // Texture data which was not uploaded again, thanks to the hits.
+        size_t TextureCount; // Cached textures, including those released but not yet removed.
+    };
+
+    // Shares textures between models whose images have the same content, such as controller models, reloaded models and models
+    // using the same texture atlas. Textures are identified by a hash of their prepared content and color space, and are only
+    // referenced weakly, so they are destroyed once no model uses them. The methods can be called from any thread.
+    class TextureCache final
+    {
+    public:
+        // The cache used by default by all loads of the process.
+        static const std::shared_ptr<TextureCache>& GetShared();
+
+        // 64-bit hash of content, based on xxHash64. It tells content apart, but is not meant to resist collision attacks.
+        static uint64_t HashContent(_In_reads_bytes_(size) const void* data, size_t size, uint64_t seed = 0);
+
+        // Return the live texture with the given content hash, or null. size is the texture's data, counted as saved on a hit.
+        shared_bgfx_handle<bgfx::TextureHandle> Find(uint64_t contentHash, bool sRGB, size_t size);
+
+        // Cache a texture created after Find missed, and return it. If another thread cached a texture with the same content in
+        // the meantime, that one is returned instead, and the given one is released when the caller lets go of it.
+        shared_bgfx_handle<bgfx::TextureHandle> Insert(uint64_t contentHash, bool sRGB, shared_bgfx_handle<bgfx::TextureHandle> texture);
+
+        TextureCacheStatistics GetStatistics() const;
+
+    private:
+        using WeakTexture = wil::weak_any<shared_bgfx_handle<bgfx::TextureHandle>>;
+
+        struct Key
+        {
+            uint64_t ContentHash;
+            bool SRGB;
+
+            bool operator==(const Key& other) const
+            {
+                return ContentHash == other.ContentHash && SRGB == other.SRGB;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                return (size_t)(key.ContentHash ^ (key.SRGB ? 1 : 0));
+            }
+        };
+
+        // Remove the entries of released textures once the map has doubled since the last time, which keeps it bounded by twice
+        // the number of live textures at a constant amortized cost.
+        void RemoveReleasedTextures();
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<Key, WeakTexture, KeyHash> m_textures; // Guarded by m_mutex.
+        size_t m_removalThreshold{64};                            // Guarded by m_mutex.
+        TextureCacheStatistics m_statistics{};                    // Guarded by m_mutex.
+    };
+}
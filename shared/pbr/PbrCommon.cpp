@@ -71,6 +71,43 @@ namespace Pbr {
         return *this;
     }
     bgfx::VertexLayout Vertex::ms_layout;
+    bgfx::VertexLayout CompactVertex::ms_layout;
+
+    DirectX::XMMATRIX EncodeCompactVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& compactVertices) {
+        XMVECTOR minPosition = g_XMFltMax;
+        XMVECTOR maxPosition = XMVectorNegate(g_XMFltMax);
+        for (const Vertex& vertex : vertices) {
+            const XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.Position));
+            minPosition = XMVectorMin(minPosition, position);
+            maxPosition = XMVectorMax(maxPosition, position);
+        }
+
+        // Use a cube rather than the box so the decoding transform has a uniform scale, which keeps the normals valid.
+        const XMVECTOR center = vertices.empty() ? XMVectorZero() : XMVectorScale(XMVectorAdd(minPosition, maxPosition), 0.5f);
+        const XMVECTOR halfExtents = vertices.empty() ? XMVectorZero() : XMVectorScale(XMVectorSubtract(maxPosition, minPosition), 0.5f);
+        float scale = std::max(XMVectorGetX(halfExtents), std::max(XMVectorGetY(halfExtents), XMVectorGetZ(halfExtents)));
+        if (scale <= 0) {
+            scale = 1;
+        }
+
+        const XMVECTOR inverseScale = XMVectorReplicate(1.0f / scale);
+        compactVertices.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vertex& vertex = vertices[i];
+            CompactVertex& compactVertex = compactVertices[i];
+
+            const XMVECTOR position = XMVectorMultiply(
+                XMVectorSubtract(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.Position)), center), inverseScale);
+            PackedVector::XMStoreShortN4(&compactVertex.Position, XMVectorSetW(position, 1.0f));
+            PackedVector::XMStoreShortN4(&compactVertex.Normal, XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(vertex.Normal)));
+            PackedVector::XMStoreShortN4(&compactVertex.Tangent, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(vertex.Tangent)));
+            PackedVector::XMStoreUByteN4(&compactVertex.Color0, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(vertex.Color0)));
+            PackedVector::XMStoreHalf2(&compactVertex.TexCoord0, XMLoadFloat2(reinterpret_cast<const XMFLOAT2*>(vertex.TexCoord0)));
+        }
+
+        return XMMatrixMultiply(XMMatrixScaling(scale, scale, scale), XMMatrixTranslationFromVector(center));
+    }
+
     // Based on code from DirectXTK
     PrimitiveBuilder&
     PrimitiveBuilder::AddSphere(float diameter, uint32_t tessellation, Pbr::NodeIndex_t transformIndex, RGBAColor vertexColor) {
@@ -328,15 +365,29 @@ namespace Pbr {
         }
 
         bgfx::TextureHandle
-        CreateTexture(_In_reads_bytes_(size) const uint8_t* rgba, uint32_t size, int width, int height, bgfx::TextureFormat::Enum format) {
-            
+        CreateTexture(_In_reads_bytes_(size) const uint8_t* rgba,
+                      uint32_t size,
+                      int width,
+                      int height,
+                      bgfx::TextureFormat::Enum format,
+                      bool hasMips,
+                      std::shared_ptr<const void> storage) {
+            const bgfx::Memory* memory = storage == nullptr
+                                             ? bgfx::copy(rgba, size)
+                                             : bgfx::makeRef(
+                                                   rgba,
+                                                   size,
+                                                   [](void* /* data */, void* userData) {
+                                                       delete static_cast<std::shared_ptr<const void>*>(userData);
+                                                   },
+                                                   new std::shared_ptr<const void>(std::move(storage)));
             return bgfx::createTexture2D(width,
                                          height,
-                                         false /*_hasMips*/,
+                                         hasMips,
                                          1 /*_numLayers*/,
                                          format /*TextureFormat::Enum_format*/,
                                          /*uint64_t _flags = */ BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
-                                         bgfx::copy(rgba, size));
+                                         memory);
         }
 
         // from what I can tell this is handled internally in bgfx, but I could be wrong
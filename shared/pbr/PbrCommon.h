@@ -8,12 +8,14 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <array>
 #include <winrt/base.h>
 #include <d3d11.h>
 #include <d3d11_2.h>
 #include <DirectXMath.h>
 #include <DirectXColors.h>
+#include <DirectXPackedVector.h>
 //#include <SampleShared/BgfxUtility.h>
 #include <SampleShared/bgfx_utils.h>
 
@@ -67,12 +69,98 @@ namespace Pbr {
 
         static bgfx::VertexLayout ms_layout;
     };
-    
+
+    // Formats a primitive's vertex buffer can be stored in.
+    enum class VertexFormat : uint32_t {
+        Full,    // Pbr::Vertex
+        Compact, // Pbr::CompactVertex
+    };
+
+    // Quantized vertex structure, decoded by the input assembler so it can be used with the same PBR shaders.
+    // Positions are relative to the bounding cube of the primitive (see EncodeCompactVertices), normals and tangents
+    // are snorm16, color is unorm8 and texture coordinates are half floats.
+    struct CompactVertex {
+        DirectX::PackedVector::XMSHORTN4 Position;
+        DirectX::PackedVector::XMSHORTN4 Normal;
+        DirectX::PackedVector::XMSHORTN4 Tangent;
+        DirectX::PackedVector::XMUBYTEN4 Color0;
+        DirectX::PackedVector::XMHALF2 TexCoord0;
+        static void init() {
+            ms_layout.begin()
+                .add(bgfx::Attrib::Position, 4, bgfx::AttribType::Int16, true /* normalized */)
+                .add(bgfx::Attrib::Normal, 4, bgfx::AttribType::Int16, true /* normalized */)
+                .add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Int16, true /* normalized */)
+                .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true /* normalized */)
+                .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Half)
+                .end();
+        }
+
+        static bgfx::VertexLayout ms_layout;
+    };
+    static_assert(sizeof(CompactVertex) == 32, "Compact vertices are expected to be tightly packed");
+
+    // Quantize vertices into the compact format. Positions are stored relative to the bounding cube of the vertices,
+    // and the returned transform maps the decoded positions back into model space.
+    DirectX::XMMATRIX EncodeCompactVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& compactVertices);
+
+    // A range of a primitive's index buffer holding one level of detail. Level 0 is the full resolution mesh.
+    struct PrimitiveLod {
+        uint32_t StartIndex;
+        uint32_t IndexCount;
+
+        // Upper bound of the geometric deviation from the full resolution mesh, in model space units.
+        float Error;
+
+        uint32_t TriangleCount() const {
+            return IndexCount / 3;
+        }
+    };
+
+    // A cluster of triangles of the full resolution level, stored as a range of a primitive's index buffer, with the
+    // model space bounds used to cull it on the CPU.
+    struct PrimitiveMeshlet {
+        uint32_t StartIndex;
+        uint32_t IndexCount;
+
+        // Bounding sphere of the cluster.
+        DirectX::XMFLOAT3 Center;
+        float Radius;
+
+        // Cone containing the front facing directions of the cluster's triangles. ConeCutoff is the cosine of half the cone
+        // angle; the cluster is back facing from any position where the apex is seen at an angle within the cone.
+        DirectX::XMFLOAT3 ConeApex;
+        DirectX::XMFLOAT3 ConeAxis;
+        float ConeCutoff;
+    };
+
+    // A morph target of a primitive, holding the displacements of only the vertices it moves. Vertices is sorted, and each of
+    // the delta arrays is either empty or holds a delta per entry of Vertices.
+    struct PrimitiveMorphTarget {
+        std::vector<uint32_t> Vertices;
+        std::vector<DirectX::XMFLOAT3> PositionDeltas;
+        std::vector<DirectX::XMFLOAT3> NormalDeltas;
+        std::vector<DirectX::XMFLOAT3> TangentDeltas;
+    };
+
+    // Primitives with at most this many vertices are given 16-bit index buffers.
+    constexpr size_t MaxIndex16VertexCount = 65536;
 
     struct PrimitiveBuilder {
         std::vector<Pbr::Vertex> Vertices;
         std::vector<uint32_t> Indices;
 
+        // Optional levels of detail, ordered from finest to coarsest, stored as ranges of Indices.
+        // When empty, all of Indices is a single level.
+        std::vector<Pbr::PrimitiveLod> Lods;
+
+        // Optional clusters covering the full resolution level, which is ordered so that each meshlet is a contiguous range.
+        std::vector<Pbr::PrimitiveMeshlet> Meshlets;
+
+        // Optional morph targets, which are blended into the vertices with the morph weights of MorphNode as the primitive is
+        // rendered. The vertices they move are referenced by index, so the vertices must not be reordered once they are set.
+        std::vector<Pbr::PrimitiveMorphTarget> MorphTargets;
+        Pbr::NodeIndex_t MorphNode{Pbr::RootNodeIndex};
+
         PrimitiveBuilder& AddAxis(float axisLength = 1.0f,
                                   float axisThickness = 0.1f,
                                   Pbr::NodeIndex_t transformIndex = Pbr::RootNodeIndex);
@@ -102,12 +190,16 @@ namespace Pbr {
         bgfx::TextureHandle LoadTextureImage(_In_reads_bytes_(fileSize) const uint8_t* fileData,
                                                                   uint32_t fileSize);
         bgfx::TextureHandle CreateFlatCubeTexture(RGBAColor color, bgfx::TextureFormat::Enum format = bgfx::TextureFormat::RGBA8);
+        // Create a 2D texture, whose data holds the full mip chain when hasMips is set. The data is copied, unless storage owns it,
+        // in which case bgfx reads it in place and keeps storage alive until it has.
         bgfx::TextureHandle
         CreateTexture(_In_reads_bytes_(size) const uint8_t* rgba,
                                                                uint32_t size,
                                                                int width,
                                                                int height,
-                                                               bgfx::TextureFormat::Enum format);
+                                                               bgfx::TextureFormat::Enum format,
+                                                               bool hasMips = false,
+                                                               std::shared_ptr<const void> storage = nullptr);
 
         bgfx::UniformHandle CreateSampler(const char* _uniqueName);
     } // namespace Texture
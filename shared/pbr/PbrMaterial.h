@@ -57,6 +57,9 @@ namespace Pbr {
                         _In_opt_ shared_bgfx_handle<bgfx::UniformHandle> sampler = shared_bgfx_handle<bgfx::UniformHandle>());
 
         void SetDoubleSided(bool doubleSided);
+        bool IsDoubleSided() const {
+            return m_doubleSided;
+        }
         void SetWireframe(bool wireframeMode);
         void SetAlphaBlended(bool alphaBlended);
 
@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "PbrMeshOptimizer.h"
+
+#include <SampleShared/meshoptimizer/src/meshoptimizer.h>
+
+namespace {
+    // A simplified level must drop at least this fraction of the previous level's triangles to be worth keeping.
+    constexpr float MinLodReduction = 0.15f;
+
+    // Vertex cache model used to report efficiency: a 16 entry FIFO, which is typical of current GPUs.
+    constexpr unsigned int AnalyzedCacheSize = 16;
+
+    Pbr::VertexCacheStatistics AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t indexCount, size_t vertexCount) {
+        const meshopt_VertexCacheStatistics statistics = meshopt_analyzeVertexCache(
+            indices.data(), indexCount, vertexCount, AnalyzedCacheSize, 0 /* warp_size */, 0 /* primgroup_size */);
+        return {statistics.acmr, statistics.atvr};
+    }
+
+    // The meshoptimizer simplifier measures error relative to the largest extent of the mesh bounding box.
+    float ComputeMaxExtent(const std::vector<Pbr::Vertex>& vertices) {
+        DirectX::XMVECTOR minPosition = DirectX::g_XMFltMax;
+        DirectX::XMVECTOR maxPosition = DirectX::XMVectorNegate(DirectX::g_XMFltMax);
+        for (const Pbr::Vertex& vertex : vertices) {
+            const DirectX::XMVECTOR position = DirectX::XMLoadFloat3(reinterpret_cast<const DirectX::XMFLOAT3*>(vertex.Position));
+            minPosition = DirectX::XMVectorMin(minPosition, position);
+            maxPosition = DirectX::XMVectorMax(maxPosition, position);
+        }
+
+        DirectX::XMFLOAT3 extent;
+        DirectX::XMStoreFloat3(&extent, DirectX::XMVectorSubtract(maxPosition, minPosition));
+        return std::max(extent.x, std::max(extent.y, extent.z));
+    }
+
+    // Swap the second and third corners of each triangle, which converts between the glTF and PBR winding orders.
+    void ReverseWinding(uint32_t* indices, size_t indexCount) {
+        for (size_t triangle = 0; triangle + 3 <= indexCount; triangle += 3) {
+            std::swap(indices[triangle + 1], indices[triangle + 2]);
+        }
+    }
+} // namespace
+
+namespace Pbr {
+    std::vector<PrimitiveBuilder> SplitForIndex16(PrimitiveBuilder&& primitiveBuilder) {
+        assert(primitiveBuilder.Lods.empty() && primitiveBuilder.Meshlets.empty());
+        std::vector<PrimitiveBuilder> parts;
+        if (primitiveBuilder.Vertices.size() <= MaxIndex16VertexCount) {
+            parts.push_back(std::move(primitiveBuilder));
+            return parts;
+        }
+
+        // Each source vertex records the last part it was copied into and its index within that part.
+        constexpr uint32_t NoPart = ~0u;
+        std::vector<uint32_t> vertexPart(primitiveBuilder.Vertices.size(), NoPart);
+        std::vector<uint32_t> vertexIndex(primitiveBuilder.Vertices.size());
+
+        const std::vector<uint32_t>& indices = primitiveBuilder.Indices;
+        for (size_t triangle = 0; triangle + 3 <= indices.size(); triangle += 3) {
+            const uint32_t currentPart = (uint32_t)parts.size() - 1;
+            size_t newVertexCount = 0;
+            for (size_t corner = 0; corner < 3; corner++) {
+                if (vertexPart[indices[triangle + corner]] != currentPart) {
+                    newVertexCount++;
+                }
+            }
+
+            if (parts.empty() || parts.back().Vertices.size() + newVertexCount > MaxIndex16VertexCount) {
+                parts.emplace_back();
+            }
+
+            const uint32_t part = (uint32_t)parts.size() - 1;
+            PrimitiveBuilder& target = parts.back();
+            for (size_t corner = 0; corner < 3; corner++) {
+                const uint32_t index = indices[triangle + corner];
+                if (vertexPart[index] != part) {
+                    vertexPart[index] = part;
+                    vertexIndex[index] = (uint32_t)target.Vertices.size();
+                    target.Vertices.push_back(primitiveBuilder.Vertices[index]);
+                }
+                target.Indices.push_back(vertexIndex[index]);
+            }
+        }
+
+        return parts;
+    }
+
+    std::optional<MeshOptimizationReport> OptimizeMesh(PrimitiveBuilder& primitiveBuilder, const MeshOptimizationOptions& options) {
+        const size_t indexCount = primitiveBuilder.Lods.empty() ? primitiveBuilder.Indices.size() : primitiveBuilder.Lods[0].IndexCount;
+        const size_t vertexCount = primitiveBuilder.Vertices.size();
+        if (vertexCount == 0 || indexCount / 3 < options.MinTriangleCount) {
+            return {};
+        }
+
+        MeshOptimizationReport report;
+        report.Before = AnalyzeVertexCache(primitiveBuilder.Indices, indexCount, vertexCount);
+
+        uint32_t* const indices = primitiveBuilder.Indices.data();
+        meshopt_optimizeVertexCache(indices, indices, indexCount, vertexCount);
+
+        // The PBR index buffers use the reverse of the glTF winding order, while meshoptimizer sorts clusters for overdraw assuming
+        // counter-clockwise front faces. Restore the glTF winding around the overdraw pass.
+        ReverseWinding(indices, indexCount);
+        meshopt_optimizeOverdraw(indices,
+                                 indices,
+                                 indexCount,
+                                 primitiveBuilder.Vertices[0].Position,
+                                 vertexCount,
+                                 sizeof(Pbr::Vertex),
+                                 options.OverdrawThreshold);
+        ReverseWinding(indices, indexCount);
+
+        // Order the vertices by first use. The remap covers all index ranges so that any levels of detail stay valid.
+        std::vector<uint32_t> remap(vertexCount);
+        const size_t usedVertexCount =
+            meshopt_optimizeVertexFetchRemap(remap.data(), indices, primitiveBuilder.Indices.size(), vertexCount);
+        meshopt_remapIndexBuffer(indices, indices, primitiveBuilder.Indices.size(), remap.data());
+        Pbr::Vertex* const vertices = primitiveBuilder.Vertices.data();
+        meshopt_remapVertexBuffer(vertices, vertices, vertexCount, sizeof(Pbr::Vertex), remap.data());
+        primitiveBuilder.Vertices.resize(usedVertexCount);
+
+        report.After = AnalyzeVertexCache(primitiveBuilder.Indices, indexCount, usedVertexCount);
+        return report;
+    }
+
+    void GenerateLods(PrimitiveBuilder& primitiveBuilder, const LodGenerationOptions& options) {
+        const size_t baseIndexCount = primitiveBuilder.Lods.empty() ? primitiveBuilder.Indices.size() : primitiveBuilder.Lods[0].IndexCount;
+        primitiveBuilder.Indices.resize(baseIndexCount);
+        primitiveBuilder.Lods.clear();
+        primitiveBuilder.Lods.push_back({0, (uint32_t)baseIndexCount, 0.0f});
+
+        if (primitiveBuilder.Vertices.empty() || baseIndexCount / 3 < options.MinTriangleCount || options.LevelCount == 0) {
+            return;
+        }
+
+        const float maxExtent = ComputeMaxExtent(primitiveBuilder.Vertices);
+        std::vector<uint32_t> lodIndices(baseIndexCount);
+        size_t previousIndexCount = baseIndexCount;
+
+        for (uint32_t level = 1; level <= options.LevelCount; level++) {
+            const size_t targetIndexCount = (size_t)((float)previousIndexCount * options.ReductionPerLevel) / 3 * 3;
+            if (targetIndexCount < 3) {
+                break;
+            }
+
+            // Each level is simplified from the full resolution indices so that error does not accumulate across levels.
+            const float targetError = options.MaxError * (float)level / (float)options.LevelCount;
+            const size_t indexCount = meshopt_simplify(lodIndices.data(),
+                                                       primitiveBuilder.Indices.data(),
+                                                       baseIndexCount,
+                                                       primitiveBuilder.Vertices[0].Position,
+                                                       primitiveBuilder.Vertices.size(),
+                                                       sizeof(Pbr::Vertex),
+                                                       targetIndexCount,
+                                                       targetError);
+
+            // Stop once the simplifier cannot make meaningful progress within the error budget.
+            if (indexCount == 0 || (float)indexCount > (float)previousIndexCount * (1.0f - MinLodReduction)) {
+                break;
+            }
+
+            // This version of meshoptimizer does not report the error it reached, so the target error is recorded as an upper bound.
+            primitiveBuilder.Lods.push_back({(uint32_t)primitiveBuilder.Indices.size(), (uint32_t)indexCount, targetError * maxExtent});
+            primitiveBuilder.Indices.insert(primitiveBuilder.Indices.end(), lodIndices.begin(), lodIndices.begin() + indexCount);
+            previousIndexCount = indexCount;
+        }
+    }
+
+    void BuildMeshlets(PrimitiveBuilder& primitiveBuilder, const MeshletOptions& options) {
+        const size_t indexCount = primitiveBuilder.Lods.empty() ? primitiveBuilder.Indices.size() : primitiveBuilder.Lods[0].IndexCount;
+        primitiveBuilder.Meshlets.clear();
+        if (primitiveBuilder.Vertices.empty() || indexCount / 3 < options.MinTriangleCount) {
+            return;
+        }
+
+        constexpr size_t MeshletVertexLimit = sizeof(meshopt_Meshlet::vertices) / sizeof(meshopt_Meshlet::vertices[0]);
+        constexpr size_t MeshletTriangleLimit = sizeof(meshopt_Meshlet::indices) / sizeof(meshopt_Meshlet::indices[0]);
+        const size_t maxVertices = std::min<size_t>(options.MaxVertices, MeshletVertexLimit);
+        const size_t maxTriangles = std::min<size_t>(options.MaxTriangles, MeshletTriangleLimit);
+        std::vector<meshopt_Meshlet> meshlets(meshopt_buildMeshletsBound(indexCount, maxVertices, maxTriangles));
+        meshlets.resize(meshopt_buildMeshlets(meshlets.data(),
+                                              primitiveBuilder.Indices.data(),
+                                              indexCount,
+                                              primitiveBuilder.Vertices.size(),
+                                              maxVertices,
+                                              maxTriangles));
+
+        // Rewrite the full resolution level in meshlet order so each meshlet can be drawn or copied as one range.
+        std::vector<uint32_t> meshletIndices;
+        meshletIndices.reserve(indexCount);
+        primitiveBuilder.Meshlets.reserve(meshlets.size());
+        for (meshopt_Meshlet& meshlet : meshlets) {
+            PrimitiveMeshlet& primitiveMeshlet = primitiveBuilder.Meshlets.emplace_back();
+            primitiveMeshlet.StartIndex = (uint32_t)meshletIndices.size();
+            primitiveMeshlet.IndexCount = meshlet.triangle_count * 3u;
+
+            for (uint32_t triangle = 0; triangle < meshlet.triangle_count; triangle++) {
+                for (const uint8_t localIndex : meshlet.indices[triangle]) {
+                    meshletIndices.push_back(meshlet.vertices[localIndex]);
+                }
+
+                // The PBR index buffers use the reverse of the glTF winding order, while meshoptimizer computes the normal cone
+                // from counter-clockwise front faces. Restore the glTF winding before computing the bounds.
+                std::swap(meshlet.indices[triangle][1], meshlet.indices[triangle][2]);
+            }
+
+            const meshopt_Bounds bounds = meshopt_computeMeshletBounds(
+                &meshlet, primitiveBuilder.Vertices[0].Position, primitiveBuilder.Vertices.size(), sizeof(Pbr::Vertex));
+            primitiveMeshlet.Center = {bounds.center[0], bounds.center[1], bounds.center[2]};
+            primitiveMeshlet.Radius = bounds.radius;
+            primitiveMeshlet.ConeApex = {bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]};
+            primitiveMeshlet.ConeAxis = {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]};
+            primitiveMeshlet.ConeCutoff = bounds.cone_cutoff;
+        }
+
+        assert(meshletIndices.size() == indexCount);
+        std::copy(meshletIndices.begin(), meshletIndices.end(), primitiveBuilder.Indices.begin());
+    }
+} // namespace Pbr
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Load-time mesh processing of primitive builders using the meshoptimizer library.
+//
+
+#pragma once
+
+#include <optional>
+#include "PbrCommon.h"
+
+namespace Pbr {
+    // Options for reordering primitives for the GPU vertex cache, overdraw and vertex fetch.
+    struct MeshOptimizationOptions {
+        // Primitives with fewer triangles than this are left in file order.
+        uint32_t MinTriangleCount = 1024;
+
+        // How much the overdraw optimization may degrade the vertex cache efficiency (ACMR), as a ratio.
+        float OverdrawThreshold = 1.05f;
+    };
+
+    // Post-transform vertex cache efficiency of a primitive, as measured by meshopt_analyzeVertexCache.
+    struct VertexCacheStatistics {
+        float Acmr; // Average cache miss ratio: transformed vertices per triangle.
+        float Atvr; // Average transformed vertex ratio: transformed vertices per vertex.
+    };
+
+    struct MeshOptimizationReport {
+        VertexCacheStatistics Before;
+        VertexCacheStatistics After;
+    };
+
+    // Options for generating simplified levels of detail.
+    struct LodGenerationOptions {
+        // Number of simplified levels generated in addition to the full resolution level.
+        uint32_t LevelCount = 3;
+
+        // Fraction of the previous level's triangles targeted by each simplified level.
+        float ReductionPerLevel = 0.5f;
+
+        // Simplification error allowed for the coarsest level, relative to the primitive's extent.
+        // Finer levels are given a proportionally smaller budget.
+        float MaxError = 0.05f;
+
+        // Primitives with fewer triangles than this are left at full resolution.
+        uint32_t MinTriangleCount = 512;
+    };
+
+    // Options for splitting primitives into meshlets that can be culled individually.
+    struct MeshletOptions {
+        // Limits of each meshlet. These cannot exceed the limits of meshopt_Meshlet (64 vertices and 126 triangles).
+        uint32_t MaxVertices = 64;
+        uint32_t MaxTriangles = 124;
+
+        // Primitives with fewer triangles than this are culled as a whole.
+        uint32_t MinTriangleCount = 4096;
+    };
+
+    // Split a primitive builder into parts of at most MaxIndex16VertexCount vertices each, so that every part can use 16-bit
+    // indices. Triangles keep their order and are assigned to parts greedily. Must run before GenerateLods and BuildMeshlets.
+    std::vector<PrimitiveBuilder> SplitForIndex16(PrimitiveBuilder&& primitiveBuilder);
+
+    // Reorder the triangles of the primitive builder's full resolution level for the vertex cache and overdraw, then reorder
+    // the vertices in order of first use. Must run before GenerateLods and BuildMeshlets, which depend on the triangle order.
+    // Returns the vertex cache statistics before and after, or nothing if the primitive was too small to be optimized.
+    std::optional<MeshOptimizationReport> OptimizeMesh(PrimitiveBuilder& primitiveBuilder, const MeshOptimizationOptions& options);
+
+    // Simplify the primitive builder's mesh into a chain of levels of detail. The simplified indices are appended to
+    // Indices so that all levels share one vertex buffer and one index buffer, and each level is recorded in Lods.
+    void GenerateLods(PrimitiveBuilder& primitiveBuilder, const LodGenerationOptions& options);
+
+    // Split the full resolution level of the primitive builder into meshlets with bounding spheres and normal cones.
+    // The triangles of the full resolution level are reordered so each meshlet is a contiguous range of Indices.
+    void BuildMeshlets(PrimitiveBuilder& primitiveBuilder, const MeshletOptions& options);
+} // namespace Pbr
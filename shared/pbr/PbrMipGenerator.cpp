@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "PbrMipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <DirectXPackedVector.h>
+
+using namespace DirectX;
+
+namespace {
+    // A filter which halves an axis: the weight of each source texel, by its offset from twice the destination texel.
+    struct FilterTap {
+        int32_t Offset;
+        float Weight;
+    };
+    using FilterTaps = std::vector<FilterTap>;
+
+    // Zeroth order modified Bessel function of the first kind, which shapes the Kaiser window.
+    float BesselI0(float x) {
+        float sum = 1;
+        float term = 1;
+        for (uint32_t k = 1; k < 16; k++) {
+            const float factor = x / (2.0f * k);
+            term *= factor * factor;
+            sum += term;
+        }
+        return sum;
+    }
+
+    FilterTaps MakeKaiserTaps() {
+        constexpr float Alpha = 4.0f;
+        constexpr float Radius = 3.0f; // In source texels.
+
+        FilterTaps taps;
+        float totalWeight = 0;
+        for (int32_t offset = -2; offset <= 3; offset++) {
+            // The destination texel's center lies between the source texels at offsets 0 and 1.
+            const float distance = offset - 0.5f;
+            const float x = XM_PI * distance / 2; // The sinc is scaled to the destination texels.
+            const float sinc = std::sin(x) / x;
+            const float t = distance / Radius;
+            const float window = BesselI0(Alpha * std::sqrt(1 - t * t)) / BesselI0(Alpha);
+            taps.push_back({offset, sinc * window});
+            totalWeight += sinc * window;
+        }
+        for (FilterTap& tap : taps) {
+            tap.Weight /= totalWeight;
+        }
+        return taps;
+    }
+
+    const FilterTaps& GetFilterTaps(Pbr::MipFilter filter) {
+        static const FilterTaps boxTaps = {{0, 0.5f}, {1, 0.5f}};
+        static const FilterTaps kaiserTaps = MakeKaiserTaps();
+        return filter == Pbr::MipFilter::Kaiser ? kaiserTaps : boxTaps;
+    }
+
+    // Used for an axis which is a single texel, and so is not halved.
+    const FilterTaps IdentityTaps = {{0, 1.0f}};
+
+    // Linear values of the 8-bit sRGB encoded values, since decoding each texel would dominate the filtering.
+    const std::array<float, 256>& GetSRGBToLinearTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values;
+            for (uint32_t i = 0; i < values.size(); i++) {
+                values[i] = XMVectorGetX(XMColorSRGBToRGB(XMVectorReplicate(i / 255.0f)));
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    void LoadRow(const uint8_t* texels, uint32_t width, uint32_t channelCount, Pbr::TextureContent content, float* row) {
+        if (channelCount != 4) {
+            for (uint32_t i = 0; i < width * channelCount; i++) {
+                row[i] = texels[i] / 255.0f;
+            }
+        } else if (content == Pbr::TextureContent::SRGB) {
+            const std::array<float, 256>& srgbToLinear = GetSRGBToLinearTable();
+            for (uint32_t x = 0; x < width; x++) {
+                const uint8_t* texel = texels + x * 4;
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x * 4),
+                              XMVectorSet(srgbToLinear[texel[0]], srgbToLinear[texel[1]], srgbToLinear[texel[2]], texel[3] / 255.0f));
+            }
+        } else {
+            for (uint32_t x = 0; x < width; x++) {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x * 4),
+                              PackedVector::XMLoadUByteN4(reinterpret_cast<const PackedVector::XMUBYTEN4*>(texels + x * 4)));
+            }
+        }
+    }
+
+    void StoreRow(const float* row, uint32_t width, uint32_t channelCount, Pbr::TextureContent content, uint8_t* texels) {
+        if (channelCount != 4) {
+            for (uint32_t i = 0; i < width * channelCount; i++) {
+                texels[i] = (uint8_t)std::lround(std::clamp(row[i], 0.0f, 1.0f) * 255);
+            }
+            return;
+        }
+
+        const XMVECTOR maxValue = XMVectorReplicate(255.0f);
+        for (uint32_t x = 0; x < width; x++) {
+            XMVECTOR texel = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x * 4));
+            if (content == Pbr::TextureContent::SRGB) {
+                texel = XMColorRGBToSRGB(texel);
+            } else if (content == Pbr::TextureContent::Normal) {
+                // Averaging shortens the normals, which would darken the lighting of minified surfaces.
+                const XMVECTOR normal = XMVectorMultiplyAdd(texel, g_XMTwo, g_XMNegativeOne);
+                const XMVECTOR renormalized =
+                    XMVectorGetX(XMVector3LengthSq(normal)) > 1e-8f ? XMVector3Normalize(normal) : g_XMIdentityR2;
+                texel = XMVectorSelect(texel, XMVectorMultiplyAdd(renormalized, g_XMOneHalf, g_XMOneHalf), g_XMSelect1110);
+            }
+            texel = XMVectorRound(XMVectorMultiply(XMVectorSaturate(texel), maxValue));
+            PackedVector::XMStoreUByte4(reinterpret_cast<PackedVector::XMUBYTE4*>(texels + x * 4), texel);
+        }
+    }
+
+    // Converts the rows of a level to floats as they are read, keeping the most recent ones since each is read for several
+    // destination rows.
+    class RowCache {
+    public:
+        RowCache(const uint8_t* texels, uint32_t width, uint32_t channelCount, Pbr::TextureContent content)
+            : m_texels(texels)
+            , m_width(width)
+            , m_channelCount(channelCount)
+            , m_content(content) {
+            for (Row& row : m_rows) {
+                row.Texels.resize((size_t)width * channelCount);
+            }
+        }
+
+        const float* GetRow(uint32_t y) {
+            Row& row = m_rows[y % m_rows.size()];
+            if (row.Y != y) {
+                LoadRow(m_texels + (size_t)y * m_width * m_channelCount, m_width, m_channelCount, m_content, row.Texels.data());
+                row.Y = y;
+            }
+            return row.Texels.data();
+        }
+
+    private:
+        struct Row {
+            uint32_t Y{UINT32_MAX};
+            std::vector<float> Texels;
+        };
+
+        const uint8_t* const m_texels;
+        const uint32_t m_width;
+        const uint32_t m_channelCount;
+        const Pbr::TextureContent m_content;
+        std::array<Row, 8> m_rows; // Enough for the 6 rows read for each destination row by the Kaiser filter.
+    };
+
+    // Filter a level into the next one, first along the columns of each destination row and then along the row.
+    void Downsample(const uint8_t* source,
+                    uint32_t sourceWidth,
+                    uint32_t sourceHeight,
+                    uint32_t channelCount,
+                    Pbr::TextureContent content,
+                    const FilterTaps& taps,
+                    uint8_t* destination) {
+        const uint32_t width = std::max(1u, sourceWidth / 2);
+        const uint32_t height = std::max(1u, sourceHeight / 2);
+        const FilterTaps& horizontalTaps = sourceWidth > 1 ? taps : IdentityTaps;
+        const FilterTaps& verticalTaps = sourceHeight > 1 ? taps : IdentityTaps;
+
+        RowCache sourceRows(source, sourceWidth, channelCount, content);
+        const size_t sourceRowFloats = (size_t)sourceWidth * channelCount;
+        std::vector<float> filteredColumns(sourceRowFloats);
+        std::vector<float> destinationRow((size_t)width * channelCount);
+        for (uint32_t y = 0; y < height; y++) {
+            std::fill(filteredColumns.begin(), filteredColumns.end(), 0.0f);
+            for (const FilterTap& tap : verticalTaps) {
+                const uint32_t sourceY = (uint32_t)std::clamp((int32_t)(y * 2) + tap.Offset, 0, (int32_t)sourceHeight - 1);
+                const float* sourceRow = sourceRows.GetRow(sourceY);
+                const XMVECTOR weight = XMVectorReplicate(tap.Weight);
+                size_t i = 0;
+                for (; i + 4 <= sourceRowFloats; i += 4) {
+                    XMFLOAT4* filtered = reinterpret_cast<XMFLOAT4*>(filteredColumns.data() + i);
+                    XMStoreFloat4(filtered,
+                                  XMVectorMultiplyAdd(
+                                      XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(sourceRow + i)), weight, XMLoadFloat4(filtered)));
+                }
+                for (; i < sourceRowFloats; i++) {
+                    filteredColumns[i] += sourceRow[i] * tap.Weight;
+                }
+            }
+
+            for (uint32_t x = 0; x < width; x++) {
+                if (channelCount == 4) {
+                    XMVECTOR sum = XMVectorZero();
+                    for (const FilterTap& tap : horizontalTaps) {
+                        const int32_t sourceX = std::clamp((int32_t)(x * 2) + tap.Offset, 0, (int32_t)sourceWidth - 1);
+                        sum = XMVectorMultiplyAdd(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(filteredColumns.data() + sourceX * 4)),
+                                                  XMVectorReplicate(tap.Weight),
+                                                  sum);
+                    }
+                    XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(destinationRow.data() + x * 4), sum);
+                } else {
+                    for (uint32_t channel = 0; channel < channelCount; channel++) {
+                        float sum = 0;
+                        for (const FilterTap& tap : horizontalTaps) {
+                            const int32_t sourceX = std::clamp((int32_t)(x * 2) + tap.Offset, 0, (int32_t)sourceWidth - 1);
+                            sum += filteredColumns[sourceX * channelCount + channel] * tap.Weight;
+                        }
+                        destinationRow[x * channelCount + channel] = sum;
+                    }
+                }
+            }
+
+            StoreRow(destinationRow.data(), width, channelCount, content, destination + (size_t)y * width * channelCount);
+        }
+    }
+} // namespace
+
+namespace Pbr {
+    uint32_t GetMipCount(uint32_t width, uint32_t height) {
+        uint32_t mipCount = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+            mipCount++;
+        }
+        return mipCount;
+    }
+
+    std::vector<uint8_t> GenerateMipChain(_In_reads_bytes_(width * height * channelCount) const uint8_t* pixels,
+                                          uint32_t channelCount,
+                                          uint32_t width,
+                                          uint32_t height,
+                                          TextureContent content,
+                                          const MipGenerationOptions& options) {
+        if (channelCount != 1 && channelCount != 4) {
+            throw std::exception("Mip chains can only be generated for grey or RGBA images.");
+        }
+
+        const uint32_t mipCount = GetMipCount(width, height);
+        size_t chainSize = 0;
+        for (uint32_t level = 0; level < mipCount; level++) {
+            chainSize += (size_t)std::max(1u, width >> level) * std::max(1u, height >> level) * channelCount;
+        }
+
+        std::vector<uint8_t> chain(chainSize);
+        memcpy(chain.data(), pixels, (size_t)width * height * channelCount);
+
+        const FilterTaps& taps = GetFilterTaps(options.Filter);
+        uint8_t* source = chain.data();
+        for (uint32_t level = 1; level < mipCount; level++) {
+            const uint32_t sourceWidth = std::max(1u, width >> (level - 1));
+            const uint32_t sourceHeight = std::max(1u, height >> (level - 1));
+            uint8_t* destination = source + (size_t)sourceWidth * sourceHeight * channelCount;
+            Downsample(source, sourceWidth, sourceHeight, channelCount, content, taps, destination);
+            source = destination;
+        }
+        return chain;
+    }
+} // namespace Pbr
@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Load-time generation of texture mip chains.
+//
+
+#pragma once
+
+#include <vector>
+#include "PbrCommon.h"
+
+namespace Pbr {
+    // How the texels of a texture are averaged into its smaller mip levels.
+    enum class TextureContent : uint32_t {
+        Linear, // The channels are averaged as they are.
+        SRGB,   // The color channels are sRGB encoded, so they are averaged in linear space. Alpha is linear.
+        Normal, // Tangent space normals, which are renormalized on each level. Alpha is averaged as it is.
+    };
+
+    enum class MipFilter : uint32_t {
+        // Averages each 2x2 texels. The fastest, but blurrier and more prone to aliasing.
+        Box,
+
+        // Kaiser-windowed sinc over 6x6 texels, which keeps minified textures sharp without aliasing.
+        Kaiser,
+    };
+
+    // Options for generating the mip chains of textures.
+    struct MipGenerationOptions {
+        MipFilter Filter = MipFilter::Kaiser;
+    };
+
+    // Number of levels of a full mip chain, down to 1x1.
+    uint32_t GetMipCount(uint32_t width, uint32_t height);
+
+    // Generate the full mip chain of an image with 1 (grey) or 4 (RGBA) channels. The levels are returned one after another, from
+    // the image itself down to 1x1, each being half the size of the one before rounded down. This is the layout bgfx creates
+    // textures with mips from. Each level is filtered from the one before.
+    std::vector<uint8_t> GenerateMipChain(_In_reads_bytes_(width * height * channelCount) const uint8_t* pixels,
+                                          uint32_t channelCount,
+                                          uint32_t width,
+                                          uint32_t height,
+                                          TextureContent content,
+                                          const MipGenerationOptions& options);
+} // namespace Pbr
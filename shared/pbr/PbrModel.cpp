@@ -45,13 +45,40 @@ namespace Pbr
         //const DirectX::XMMATRIX projectionMatrix = ComposeProjectionMatrix(viewProjections[k].Fov, viewProjections[k].NearFar);
 
 
+        // Levels of detail are selected and primitives culled using the camera of the view being rendered, when one was provided.
+        const Pbr::ViewParameters* viewParameters = pbrResources.GetViewParameters(view);
+        XMMATRIX modelToView = XMMatrixIdentity();
+        std::optional<Pbr::CullingFrustum> frustum;
+        if (viewParameters != nullptr)
+        {
+            const XMMATRIX rootTransform = m_nodes.empty() ? XMMatrixIdentity() : m_nodes[RootNodeIndex].GetTransform();
+            modelToView = XMMatrixMultiply(XMMatrixMultiply(rootTransform, pbrResources.GetModelToWorld()),
+                                           XMLoadFloat4x4(&viewParameters->WorldToView));
+            frustum.emplace(modelToView, XMLoadFloat4x4(&viewParameters->Projection));
+        }
+
         for (const Pbr::Primitive& primitive : m_primitives)
         {
             if (primitive.GetMaterial()->Hidden) continue;
+            if (frustum && !frustum->Intersects(primitive.GetBoundingSphere())) continue;
+            if (primitive.HasMorphTargets())
+            {
+                // Only the vertices moved by the targets whose weights changed since the last update are written.
+                primitive.UpdateMorphTargets(m_nodes[primitive.GetMorphNode()].GetMorphWeights());
+            }
             primitive.GetMaterial()->SetWireframe(pbrResources.GetFillMode() == FillMode::Wireframe);
             UpdateTransforms(pbrResources);
-            primitive.Render(pbrResources);
+            const uint32_t lodLevel =
+                viewParameters != nullptr ? primitive.SelectLod(modelToView, *viewParameters, pbrResources.GetLodErrorThreshold()) : 0;
+            if (!primitive.Render(pbrResources, lodLevel, frustum ? &frustum.value() : nullptr))
+            {
+                // Every meshlet of the primitive was culled, drop the state set for this draw.
+                bgfx::discard();
+                continue;
+            }
             primitive.GetMaterial()->Bind(pbrResources);
+            BindPrimitiveTransform(primitive);
+            pbrResources.BindModelToWorld();
             //pbrResources.Bind();
             pbrResources.SubmitProgram(view);
         }
@@ -86,7 +113,8 @@ namespace Pbr
 
         for (const Node& node : m_nodes)
         {
-            clone->AddNode(node.GetTransform(), node.ParentNodeIndex, node.Name);
+            const NodeIndex_t nodeIndex = clone->AddNode(node.GetTransform(), node.ParentNodeIndex, node.Name);
+            clone->GetNode(nodeIndex).SetMorphWeights(node.GetMorphWeights());
         }
 
         for (const Primitive& primitive : m_primitives)
@@ -123,6 +151,22 @@ namespace Pbr
         m_primitives.push_back(std::move(primitive));
     }
 
+    void Model::BindPrimitiveTransform(const Primitive& primitive) const {
+        constexpr uint32_t instanceStride = sizeof(decltype(m_modelTransforms)::value_type);
+        if (m_modelTransforms.empty() || bgfx::getAvailInstanceDataBuffer(1, instanceStride) != 1) {
+            return;
+        }
+
+        // The node transforms are stored transposed for the shader, which applies the instance transform first. Transposing
+        // (vertexToModel * root) gives root^T * vertexToModel^T.
+        bgfx::InstanceDataBuffer instanceData;
+        bgfx::allocInstanceDataBuffer(&instanceData, 1, instanceStride);
+        const XMMATRIX rootTransform = XMLoadFloat4x4(&m_modelTransforms[RootNodeIndex]);
+        XMStoreFloat4x4(reinterpret_cast<XMFLOAT4X4*>(instanceData.data),
+                        XMMatrixMultiply(rootTransform, XMMatrixTranspose(primitive.GetVertexToModel())));
+        bgfx::setInstanceDataBuffer(&instanceData);
+    }
+
     void Model::UpdateTransforms(Pbr::Resources const& pbrResources) const {
         const uint32_t newTotalModifyCount =
             std::accumulate(m_nodes.begin(), m_nodes.end(), 0, [](uint32_t sumChangeCount, const Node& node) {
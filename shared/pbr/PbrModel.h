@@ -37,6 +37,16 @@ namespace Pbr {
             return DirectX::XMLoadFloat4x4(&m_localTransform);
         }
 
+        // Set the weights of the morph targets of the primitives this node deforms. Targets without a weight are not applied.
+        void SetMorphWeights(std::vector<float> weights) {
+            m_morphWeights = std::move(weights);
+        }
+
+        // Get the weights of the morph targets of the primitives this node deforms.
+        const std::vector<float>& GetMorphWeights() const {
+            return m_morphWeights;
+        }
+
         const std::string Name;
         const NodeIndex_t Index;
         const NodeIndex_t ParentNodeIndex;
@@ -45,6 +55,7 @@ namespace Pbr {
         friend struct Model;
         uint32_t m_modifyCount{0};
         DirectX::XMFLOAT4X4 m_localTransform;
+        std::vector<float> m_morphWeights;
     };
     struct CachedFrameBuffer {
         std::vector<unique_bgfx_handle<bgfx::FrameBufferHandle>> FrameBuffers;
@@ -103,6 +114,10 @@ namespace Pbr {
         // Updated the transforms used to render the model. This needs to be called any time a node transform is changed.
         void UpdateTransforms(Pbr::Resources const& pbrResources) const;
 
+        // Bind the transform of the next draw of a primitive, which decodes its vertex positions into model space before the root
+        // node transform is applied.
+        void BindPrimitiveTransform(const Primitive& primitive) const;
+
     private:
         // A model is made up of one or more Primitives. Each Primitive has a unique material.
         // Ideally primitives with the same material should be merged to reduce draw calls.
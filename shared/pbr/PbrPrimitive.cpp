@@ -31,7 +31,33 @@ namespace {
         return (UINT)(sizeof(decltype(Pbr::PrimitiveBuilder::Vertices)::value_type) * size);
     }
 
-    bgfx::VertexBufferHandle CreateVertexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder, bool updatableBuffers) {
+    // Gives the contents of a vector to bgfx without copying them. The vector is destroyed once bgfx no longer needs them.
+    template <typename T>
+    const bgfx::Memory* MoveToBgfxMemory(std::vector<T>&& values) {
+        auto* const ownedValues = new std::vector<T>(std::move(values));
+        return bgfx::makeRef(
+            ownedValues->data(),
+            (uint32_t)(ownedValues->size() * sizeof(T)),
+            [](void* /* data */, void* userData) { delete static_cast<std::vector<T>*>(userData); },
+            ownedValues);
+    }
+
+    // When movableVertices is given, it holds the vertices of the primitive builder, which full precision vertex buffers take over.
+    bgfx::VertexBufferHandle CreateVertexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder,
+                                                bool updatableBuffers,
+                                                Pbr::VertexFormat vertexFormat,
+                                                XMFLOAT4X4* vertexToModel,
+                                                std::vector<Pbr::Vertex>* movableVertices = nullptr) {
+        if (vertexFormat == Pbr::VertexFormat::Compact) {
+            Pbr::CompactVertex::init();
+            std::vector<Pbr::CompactVertex> compactVertices;
+            XMStoreFloat4x4(vertexToModel, Pbr::EncodeCompactVertices(primitiveBuilder.Vertices, compactVertices));
+            return bgfx::createVertexBuffer(
+                bgfx::copy(compactVertices.data(), (uint32_t)(sizeof(Pbr::CompactVertex) * compactVertices.size())),
+                Pbr::CompactVertex::ms_layout);
+        }
+
+        XMStoreFloat4x4(vertexToModel, XMMatrixIdentity());
         Pbr::Vertex::init();
         // Create Vertex Buffer BGFX
         //bgfx::VertexLayout vertexLayout;
@@ -63,14 +89,67 @@ namespace {
         size_t numVertex = primitiveBuilder.Vertices.size();
         size_t sizeOfVertex = sizeof(Pbr::Vertex);
         //we need to make sure the data stays in tact for as long bgfx needs it
+        if (movableVertices != nullptr) {
+            return bgfx::createVertexBuffer(MoveToBgfxMemory(std::move(*movableVertices)), Pbr::Vertex::ms_layout);
+        }
         const Pbr::Vertex* data = primitiveBuilder.Vertices.data();
         return bgfx::createVertexBuffer(
             bgfx::copy(data, (uint32_t)(sizeOfVertex*numVertex)), Pbr::Vertex::ms_layout);
 
     }
 
-    bgfx::IndexBufferHandle CreateIndexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder
+    // Morphed vertices are written into a dynamic vertex buffer, which starts out with the vertices no target has moved.
+    bgfx::DynamicVertexBufferHandle CreateMorphVertexBuffer(const std::vector<Pbr::Vertex>& vertices) {
+        Pbr::Vertex::init();
+        return bgfx::createDynamicVertexBuffer(bgfx::copy(vertices.data(), GetPbrVertexByteSize(vertices.size())),
+                                               Pbr::Vertex::ms_layout);
+    }
 
+    // Weight of a morph target, where targets without a weight have none.
+    float GetMorphWeight(const std::vector<float>& weights, size_t targetIndex) {
+        return targetIndex < weights.size() ? weights[targetIndex] : 0.0f;
+    }
+
+    // Adds the weighted deltas of a morph target to a field of the vertices it moves, whose first three floats are displaced.
+    // Each vertex is a single multiply-add of DirectXMath vectors.
+    template <size_t FieldSize>
+    void XM_CALLCONV AddMorphDeltas(const Pbr::PrimitiveMorphTarget& target,
+                                    const std::vector<XMFLOAT3>& deltas,
+                                    float (Pbr::Vertex::*field)[FieldSize],
+                                    FXMVECTOR weight,
+                                    std::vector<Pbr::Vertex>& vertices) {
+        static_assert(FieldSize >= 3, "Morph targets displace three components.");
+        if (deltas.empty()) {
+            return;
+        }
+
+        for (size_t i = 0; i < target.Vertices.size(); i++) {
+            XMFLOAT3* const value = reinterpret_cast<XMFLOAT3*>(vertices[target.Vertices[i]].*field);
+            XMStoreFloat3(value, XMVectorMultiplyAdd(XMLoadFloat3(&deltas[i]), weight, XMLoadFloat3(value)));
+        }
+    }
+
+    // Indices can be stored as 16-bit when every vertex of the primitive is addressable with them.
+    bool UsesIndex32(const Pbr::PrimitiveBuilder& primitiveBuilder) {
+        return primitiveBuilder.Vertices.size() > Pbr::MaxIndex16VertexCount;
+    }
+
+    const bgfx::Memory* CopyIndices(const uint32_t* indices, size_t indexCount, bool index32) {
+        if (index32) {
+            return bgfx::copy(indices, (uint32_t)(indexCount * sizeof(uint32_t)));
+        }
+
+        const bgfx::Memory* memory = bgfx::alloc((uint32_t)(indexCount * sizeof(uint16_t)));
+        uint16_t* const indices16 = reinterpret_cast<uint16_t*>(memory->data);
+        for (size_t i = 0; i < indexCount; i++) {
+            indices16[i] = (uint16_t)indices[i];
+        }
+        return memory;
+    }
+
+    // When movableIndices is given, it holds the indices of the primitive builder, which 32-bit index buffers take over.
+    bgfx::IndexBufferHandle CreateIndexBuffer(const Pbr::PrimitiveBuilder& primitiveBuilder,
+                                              std::vector<uint32_t>* movableIndices = nullptr
                                               /*,bool updatableBuffers*/) {
         // Create bgfx Index Buffer
         // Create Index Buffer
@@ -87,15 +166,70 @@ namespace {
         /* D3D11_SUBRESOURCE_DATA initData{};
          initData.pSysMem = primitiveBuilder.Indices.data();*/
 
-        return bgfx::createIndexBuffer(bgfx::copy(primitiveBuilder.Indices.data(),
-                                                     (uint32_t)(sizeof(primitiveBuilder.Indices[0]) * primitiveBuilder.Indices.size())),
-                                       BGFX_BUFFER_INDEX32);
+        const bool index32 = UsesIndex32(primitiveBuilder);
+        if (index32 && movableIndices != nullptr) {
+            return bgfx::createIndexBuffer(MoveToBgfxMemory(std::move(*movableIndices)), BGFX_BUFFER_INDEX32);
+        }
+        return bgfx::createIndexBuffer(CopyIndices(primitiveBuilder.Indices.data(), primitiveBuilder.Indices.size(), index32),
+                                       index32 ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
     }
 } // namespace
 
 namespace Pbr {
     const bgfx::RendererType::Enum type = bgfx::getRendererType();
 
+    CullingFrustum::CullingFrustum(FXMMATRIX modelToView, CXMMATRIX projection) {
+        // Extract the frustum planes from the model to projection transform, so that they are directly in model space.
+        const XMMATRIX columns = XMMatrixTranspose(XMMatrixMultiply(modelToView, projection));
+        const XMVECTOR planes[] = {
+            XMVectorAdd(columns.r[3], columns.r[0]),      // Left
+            XMVectorSubtract(columns.r[3], columns.r[0]), // Right
+            XMVectorAdd(columns.r[3], columns.r[1]),      // Bottom
+            XMVectorSubtract(columns.r[3], columns.r[1]), // Top
+            columns.r[2],                                 // Near, or far when the depth is reversed
+            XMVectorSubtract(columns.r[3], columns.r[2]), // Far, or near when the depth is reversed
+        };
+        for (size_t i = 0; i < std::size(planes); i++) {
+            // An infinite far plane has no normal. Replace it with a plane that contains everything.
+            const float normalLength = XMVectorGetX(XMVector3Length(planes[i]));
+            XMStoreFloat4(&m_planes[i], normalLength > 1e-6f ? XMVectorScale(planes[i], 1.0f / normalLength) : g_XMIdentityR3);
+        }
+
+        const XMMATRIX viewToModel = XMMatrixInverse(nullptr, modelToView);
+        XMStoreFloat3(&m_cameraPosition, viewToModel.r[3]);
+
+        // Normal cones are only preserved by transforms with a uniform scale.
+        const float scaleX = XMVectorGetX(XMVector3LengthSq(modelToView.r[0]));
+        const float scaleY = XMVectorGetX(XMVector3LengthSq(modelToView.r[1]));
+        const float scaleZ = XMVectorGetX(XMVector3LengthSq(modelToView.r[2]));
+        const float maxScale = std::max(scaleX, std::max(scaleY, scaleZ));
+        const float minScale = std::min(scaleX, std::min(scaleY, scaleZ));
+        m_uniformScale = minScale > maxScale * 0.98f;
+    }
+
+    bool XM_CALLCONV CullingFrustum::Intersects(FXMVECTOR center, float radius) const {
+        for (const XMFLOAT4& plane : m_planes) {
+            if (XMVectorGetX(XMPlaneDotCoord(XMLoadFloat4(&plane), center)) < -radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CullingFrustum::Intersects(const BoundingSphere& sphere) const {
+        return Intersects(XMLoadFloat3(&sphere.Center), sphere.Radius);
+    }
+
+    bool CullingFrustum::IsBackFacing(const PrimitiveMeshlet& meshlet) const {
+        if (!m_uniformScale) {
+            return false;
+        }
+
+        const XMVECTOR apexDirection =
+            XMVector3Normalize(XMVectorSubtract(XMLoadFloat3(&meshlet.ConeApex), XMLoadFloat3(&m_cameraPosition)));
+        return XMVectorGetX(XMVector3Dot(apexDirection, XMLoadFloat3(&meshlet.ConeAxis))) >= meshlet.ConeCutoff;
+    }
+
     Primitive::Primitive(UINT indexCount,
                          shared_bgfx_handle<bgfx::IndexBufferHandle> indexBuffer,
                          shared_bgfx_handle<bgfx::VertexBufferHandle> vertexBuffer,
@@ -103,22 +237,153 @@ namespace Pbr {
         : m_indexCount(indexCount)
         , m_indexBuffer(std::move(indexBuffer))
         , m_vertexBuffer(std::move(vertexBuffer))
-        , m_material(std::move(material)) {
+        , m_material(std::move(material))
+        , m_lods({{0, indexCount, 0.0f}})
+        , m_boundingSphere({0, 0, 0}, std::numeric_limits<float>::max()) { // Unknown bounds, never culled.
+        XMStoreFloat4x4(&m_vertexToModel, XMMatrixIdentity());
     }
 
     Primitive::Primitive(Pbr::Resources const& pbrResources,
                          const Pbr::PrimitiveBuilder& primitiveBuilder,
                          std::shared_ptr<Pbr::Material> material,
-                         bool updatableBuffers)
+                         bool updatableBuffers,
+                         VertexFormat vertexFormat)
         : Primitive((UINT)primitiveBuilder.Indices.size(),
                     shared_bgfx_handle<bgfx::IndexBufferHandle>(CreateIndexBuffer(primitiveBuilder /*, updatableBuffers*/)),
-                    shared_bgfx_handle<bgfx::VertexBufferHandle>(CreateVertexBuffer(primitiveBuilder, updatableBuffers)),
+                    shared_bgfx_handle<bgfx::VertexBufferHandle>(),
                     std::move(material)) {
-        
+        m_index32 = UsesIndex32(primitiveBuilder);
+        CreateVertexBuffers(primitiveBuilder, updatableBuffers, vertexFormat);
+        SetGeometryInfo(primitiveBuilder);
+    }
+
+    Primitive::Primitive(Pbr::Resources const& pbrResources,
+                         Pbr::PrimitiveBuilder&& primitiveBuilder,
+                         std::shared_ptr<Pbr::Material> material,
+                         bool updatableBuffers,
+                         VertexFormat vertexFormat)
+        : Primitive((UINT)primitiveBuilder.Indices.size(),
+                    shared_bgfx_handle<bgfx::IndexBufferHandle>(),
+                    shared_bgfx_handle<bgfx::VertexBufferHandle>(),
+                    std::move(material)) {
+        // The geometry info and the index width are taken from the builder before its arrays are given to bgfx, with the indices
+        // first, since their width follows the vertex count.
+        m_index32 = UsesIndex32(primitiveBuilder);
+        SetGeometryInfo(primitiveBuilder);
+        m_indexBuffer.reset(CreateIndexBuffer(primitiveBuilder, &primitiveBuilder.Indices));
+        CreateVertexBuffers(primitiveBuilder, updatableBuffers, vertexFormat, &primitiveBuilder.Vertices);
+        primitiveBuilder = {};
     }
 
     Primitive Primitive::Clone(Pbr::Resources const& pbrResources) const {
-        return Primitive(m_indexCount, m_indexBuffer, m_vertexBuffer, m_material->Clone(pbrResources));
+        Primitive clone(m_indexCount, m_indexBuffer, m_vertexBuffer, m_material->Clone(pbrResources));
+        clone.m_lods = m_lods;
+        clone.m_boundingSphere = m_boundingSphere;
+        clone.m_meshlets = m_meshlets;
+        clone.m_meshletIndices = m_meshletIndices;
+        clone.m_vertexFormat = m_vertexFormat;
+        clone.m_vertexToModel = m_vertexToModel;
+        clone.m_index32 = m_index32;
+        if (HasMorphTargets()) {
+            clone.m_morphTargets = m_morphTargets;
+            clone.m_morphBaseVertices = m_morphBaseVertices;
+            clone.m_morphNode = m_morphNode;
+            clone.m_morphVertexBuffer.reset(CreateMorphVertexBuffer(*m_morphBaseVertices));
+        }
+        return clone;
+    }
+
+    void Primitive::CreateVertexBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder,
+                                        bool updatableBuffers,
+                                        VertexFormat vertexFormat,
+                                        std::vector<Pbr::Vertex>* movableVertices) {
+        if (primitiveBuilder.MorphTargets.empty()) {
+            m_vertexFormat = vertexFormat;
+            m_vertexBuffer.reset(CreateVertexBuffer(primitiveBuilder, updatableBuffers, m_vertexFormat, &m_vertexToModel, movableVertices));
+            m_morphVertexBuffer.reset();
+            return;
+        }
+
+        // Morph targets displace the full precision vertices, which are rewritten as the weights change.
+        m_vertexFormat = VertexFormat::Full;
+        XMStoreFloat4x4(&m_vertexToModel, XMMatrixIdentity());
+        m_vertexBuffer.reset();
+        m_morphVertexBuffer.reset(CreateMorphVertexBuffer(primitiveBuilder.Vertices));
+    }
+
+    void Primitive::SetGeometryInfo(const Pbr::PrimitiveBuilder& primitiveBuilder) {
+        if (primitiveBuilder.Lods.empty()) {
+            m_lods = {{0, (uint32_t)primitiveBuilder.Indices.size(), 0.0f}};
+        } else {
+            m_lods = primitiveBuilder.Lods;
+        }
+
+        if (!primitiveBuilder.Vertices.empty()) {
+            DirectX::BoundingSphere::CreateFromPoints(m_boundingSphere,
+                                                      primitiveBuilder.Vertices.size(),
+                                                      reinterpret_cast<const XMFLOAT3*>(primitiveBuilder.Vertices[0].Position),
+                                                      sizeof(Pbr::Vertex));
+        }
+
+        if (primitiveBuilder.Meshlets.empty()) {
+            m_meshlets.reset();
+            m_meshletIndices.reset();
+        } else {
+            m_meshlets = std::make_shared<const std::vector<PrimitiveMeshlet>>(primitiveBuilder.Meshlets);
+            const auto indicesBegin = primitiveBuilder.Indices.begin();
+            m_meshletIndices = std::make_shared<const std::vector<uint32_t>>(indicesBegin, indicesBegin + m_lods[0].IndexCount);
+        }
+
+        m_morphedVertices.clear();
+        m_morphWeights.clear();
+        if (primitiveBuilder.MorphTargets.empty()) {
+            m_morphTargets.reset();
+            m_morphBaseVertices.reset();
+        } else {
+            m_morphTargets = std::make_shared<const std::vector<PrimitiveMorphTarget>>(primitiveBuilder.MorphTargets);
+            m_morphBaseVertices = std::make_shared<const std::vector<Pbr::Vertex>>(primitiveBuilder.Vertices);
+            m_morphNode = primitiveBuilder.MorphNode;
+
+            // The bounds grow to hold the vertices with every target applied at full weight, which animations rarely exceed.
+            for (const PrimitiveMorphTarget& target : primitiveBuilder.MorphTargets) {
+                float maxDeltaLengthSq = 0;
+                for (const XMFLOAT3& delta : target.PositionDeltas) {
+                    maxDeltaLengthSq = std::max(maxDeltaLengthSq, XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&delta))));
+                }
+                m_boundingSphere.Radius += std::sqrt(maxDeltaLengthSq);
+            }
+        }
+    }
+
+    const std::vector<PrimitiveMeshlet>& Primitive::GetMeshlets() const {
+        static const std::vector<PrimitiveMeshlet> noMeshlets;
+        return m_meshlets ? *m_meshlets : noMeshlets;
+    }
+
+    uint32_t XM_CALLCONV Primitive::SelectLod(FXMMATRIX modelToView, const ViewParameters& viewParameters, float errorThreshold) const {
+        if (m_lods.size() <= 1) {
+            return 0;
+        }
+
+        // The view transform is rigid, so the scale of the model to view transform is the model's scale.
+        const float maxScale = std::max(XMVectorGetX(XMVector3Length(modelToView.r[0])),
+                                        std::max(XMVectorGetX(XMVector3Length(modelToView.r[1])),
+                                                 XMVectorGetX(XMVector3Length(modelToView.r[2]))));
+        const XMVECTOR center = XMVector3Transform(XMLoadFloat3(&m_boundingSphere.Center), modelToView);
+        const float distance = XMVectorGetX(XMVector3Length(center)) - m_boundingSphere.Radius * maxScale;
+        if (distance <= 0) {
+            return 0; // The viewer is inside the bounds of the primitive.
+        }
+
+        // Number of pixels covered by one world space unit at the nearest point of the bounding sphere.
+        const float pixelsPerUnit = viewParameters.Projection._22 * viewParameters.ViewportHeight * 0.5f / distance;
+        for (uint32_t lodLevel = (uint32_t)m_lods.size() - 1; lodLevel > 0; lodLevel--) {
+            if (m_lods[lodLevel].Error * maxScale * pixelsPerUnit <= errorThreshold) {
+                return lodLevel;
+            }
+        }
+
+        return 0;
     }
 
     void Primitive::UpdateBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder) {
@@ -133,7 +398,7 @@ namespace Pbr {
                 // context->UpdateSubresource(m_vertexBuffer.get(), 0, nullptr, primitiveBuilder.Vertices.data(), requiredSize,
                 // requiredSize);
             } else {
-                m_vertexBuffer.reset(CreateVertexBuffer(primitiveBuilder, true));
+                CreateVertexBuffers(primitiveBuilder, true, m_vertexFormat);
             }
         }
 
@@ -142,7 +407,9 @@ namespace Pbr {
             /*D3D11_BUFFER_DESC idxDesc;
             m_indexBuffer->GetDesc(&idxDesc);*/
 
-            UINT requiredSize = (UINT)(primitiveBuilder.Indices.size() * sizeof(decltype(primitiveBuilder.Indices)::value_type));
+            // The index width follows the vertex count, so it may change with the update.
+            m_index32 = UsesIndex32(primitiveBuilder);
+            UINT requiredSize = (UINT)(primitiveBuilder.Indices.size() * (m_index32 ? sizeof(uint32_t) : sizeof(uint16_t)));
             if (false /*idxDesc.ByteWidth >= requiredSize*/) {
                 // context->UpdateSubresource(m_indexBuffer.get(), 0, nullptr, primitiveBuilder.Indices.data(), requiredSize, requiredSize);
             } else {
@@ -151,19 +418,123 @@ namespace Pbr {
 
             m_indexCount = (UINT)primitiveBuilder.Indices.size();
         }
+
+        SetGeometryInfo(primitiveBuilder);
     }
 
-    void Primitive::Render(const Resources& pbrResources) const {
+    void Primitive::UpdateMorphTargets(const std::vector<float>& weights) const {
+        const std::vector<PrimitiveMorphTarget>& targets = *m_morphTargets;
+        const std::vector<Pbr::Vertex>& baseVertices = *m_morphBaseVertices;
+        bool weightsChanged = false;
+        for (size_t i = 0; i < targets.size() && !weightsChanged; i++) {
+            weightsChanged = GetMorphWeight(weights, i) != GetMorphWeight(m_morphWeights, i);
+        }
+        if (!weightsChanged) {
+            return;
+        }
+
+        if (m_morphedVertices.empty()) {
+            m_morphedVertices = baseVertices;
+        }
+
+        // Range of the vertices restored or moved, which is all of the vertex buffer that needs to be written.
+        uint32_t firstVertex = std::numeric_limits<uint32_t>::max();
+        uint32_t endVertex = 0;
+        const auto addToRange = [&](const PrimitiveMorphTarget& target) {
+            firstVertex = std::min(firstVertex, target.Vertices.front());
+            endVertex = std::max(endVertex, target.Vertices.back() + 1);
+        };
+
+        // Restore the vertices moved by the previous weights, then blend in the targets with a weight.
+        for (size_t i = 0; i < targets.size(); i++) {
+            const PrimitiveMorphTarget& target = targets[i];
+            if (GetMorphWeight(m_morphWeights, i) != 0 && !target.Vertices.empty()) {
+                for (const uint32_t vertex : target.Vertices) {
+                    m_morphedVertices[vertex] = baseVertices[vertex];
+                }
+                addToRange(target);
+            }
+        }
+        for (size_t i = 0; i < targets.size(); i++) {
+            const PrimitiveMorphTarget& target = targets[i];
+            const float weight = GetMorphWeight(weights, i);
+            if (weight != 0 && !target.Vertices.empty()) {
+                const XMVECTOR weightVector = XMVectorReplicate(weight);
+                AddMorphDeltas(target, target.PositionDeltas, &Pbr::Vertex::Position, weightVector, m_morphedVertices);
+                AddMorphDeltas(target, target.NormalDeltas, &Pbr::Vertex::Normal, weightVector, m_morphedVertices);
+                AddMorphDeltas(target, target.TangentDeltas, &Pbr::Vertex::Tangent, weightVector, m_morphedVertices);
+                addToRange(target);
+            }
+        }
+        m_morphWeights.assign(weights.begin(), weights.begin() + std::min(weights.size(), targets.size()));
+
+        if (firstVertex < endVertex) {
+            bgfx::update(m_morphVertexBuffer.get(),
+                         firstVertex,
+                         bgfx::copy(&m_morphedVertices[firstVertex], GetPbrVertexByteSize(endVertex - firstVertex)));
+        }
+    }
+
+    void Primitive::SetVertexBuffer() const {
+        if (m_morphVertexBuffer.is_valid()) {
+            bgfx::setVertexBuffer(0, m_morphVertexBuffer.get());
+        } else {
+            bgfx::setVertexBuffer(0, m_vertexBuffer.get());
+        }
+    }
+
+    bool Primitive::Render(const Resources& pbrResources, uint32_t lodLevel, const CullingFrustum* frustum) const {
         // const UINT stride = sizeof(Pbr::Vertex);
         // const UINT offset = 0;
         // bgfx::VertexBufferHandle* const vertexBuffers[] = {&m_vertexBuffer.get()};
         //bgfx::setTransform(m_modelTransforms[node.Index].m);
-        bgfx::setVertexBuffer(0, m_vertexBuffer.get());
-        bgfx::setIndexBuffer(m_indexBuffer.get());
+        lodLevel = std::min(lodLevel, (uint32_t)m_lods.size() - 1);
+        if (lodLevel == 0 && frustum != nullptr && m_meshlets) {
+            const bool backFaceCulling = !m_material->IsDoubleSided();
+            m_culledIndices.clear();
+            for (const PrimitiveMeshlet& meshlet : *m_meshlets) {
+                if (!frustum->Intersects(XMLoadFloat3(&meshlet.Center), meshlet.Radius) ||
+                    (backFaceCulling && frustum->IsBackFacing(meshlet))) {
+                    continue;
+                }
+
+                const auto meshletBegin = m_meshletIndices->begin() + meshlet.StartIndex;
+                m_culledIndices.insert(m_culledIndices.end(), meshletBegin, meshletBegin + meshlet.IndexCount);
+            }
+
+            if (m_culledIndices.empty()) {
+                return false;
+            }
+
+            // Each draw gets a transient index buffer of its own, so that several draws of the primitive in a frame, in the same
+            // view or not, keep their own visible triangles. When the transient buffer space is used up, everything is drawn.
+            const uint32_t culledIndexCount = (uint32_t)m_culledIndices.size();
+            if (bgfx::getAvailTransientIndexBuffer(culledIndexCount, m_index32) == culledIndexCount) {
+                bgfx::TransientIndexBuffer culledIndexBuffer;
+                bgfx::allocTransientIndexBuffer(&culledIndexBuffer, culledIndexCount, m_index32);
+                if (m_index32) {
+                    memcpy(culledIndexBuffer.data, m_culledIndices.data(), culledIndexCount * sizeof(uint32_t));
+                } else {
+                    uint16_t* const indices16 = reinterpret_cast<uint16_t*>(culledIndexBuffer.data);
+                    for (uint32_t i = 0; i < culledIndexCount; i++) {
+                        indices16[i] = (uint16_t)m_culledIndices[i];
+                    }
+                }
+
+                SetVertexBuffer();
+                bgfx::setIndexBuffer(&culledIndexBuffer);
+                return true;
+            }
+        }
+
+        const PrimitiveLod& lod = m_lods[lodLevel];
+        SetVertexBuffer();
+        bgfx::setIndexBuffer(m_indexBuffer.get(), lod.StartIndex, lod.IndexCount);
         
         /*context->IASetVertexBuffers(0, 1, vertexBuffers, &stride, &offset);
         context->IASetIndexBuffer(m_indexBuffer.get(), DXGI_FORMAT_R32_UINT, 0);
         context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
         context->DrawIndexedInstanced(m_indexCount, 1, 0, 0, 0);*/
+        return true;
     }
 } // namespace Pbr
@@ -7,6 +7,7 @@
 #include <winrt/base.h>
 #include <d3d11.h>
 #include <d3d11_2.h>
+#include <DirectXCollision.h>
 #include "PbrMaterial.h"
 #include <bgfx/bgfx.h>
 
@@ -15,6 +16,23 @@
 #include <bx/uint32_t.h>
 
 namespace Pbr {
+    // The view frustum and camera position of a view in the space of a model, used to cull primitives and meshlets on the CPU.
+    struct CullingFrustum {
+        CullingFrustum(DirectX::FXMMATRIX modelToView, DirectX::CXMMATRIX projection);
+
+        // Test whether a model space sphere is at least partially inside the frustum.
+        bool XM_CALLCONV Intersects(DirectX::FXMVECTOR center, float radius) const;
+        bool Intersects(const DirectX::BoundingSphere& sphere) const;
+
+        // Test whether all triangles of a meshlet face away from the camera.
+        bool IsBackFacing(const PrimitiveMeshlet& meshlet) const;
+
+    private:
+        DirectX::XMFLOAT4 m_planes[6];
+        DirectX::XMFLOAT3 m_cameraPosition;
+        bool m_uniformScale;
+    };
+
     // A primitive holds a vertex buffer, index buffer, and a pointer to a PBR material.
     struct Primitive final {
         using Collection = std::vector<Primitive>;
@@ -27,7 +45,16 @@ namespace Pbr {
         Primitive(Pbr::Resources const& pbrResources,
                   const Pbr::PrimitiveBuilder& primitiveBuilder,
                   std::shared_ptr<Material> material,
-                  bool updatableBuffers = false);
+                  bool updatableBuffers = false,
+                  VertexFormat vertexFormat = VertexFormat::Full);
+
+        // Create the primitive from a builder whose vertices and indices are no longer needed. Full precision vertices and 32-bit
+        // indices are given to bgfx as they are rather than copied, and the builder is left empty.
+        Primitive(Pbr::Resources const& pbrResources,
+                  Pbr::PrimitiveBuilder&& primitiveBuilder,
+                  std::shared_ptr<Material> material,
+                  bool updatableBuffers = false,
+                  VertexFormat vertexFormat = VertexFormat::Full);
 
         void UpdateBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder);
 
@@ -38,18 +65,84 @@ namespace Pbr {
         const std::shared_ptr<Material>& GetMaterial() const {
             return m_material;
         }
-  
+
+        // Get the levels of detail of the primitive, ordered from finest to coarsest, with their error and triangle counts.
+        const std::vector<PrimitiveLod>& GetLods() const {
+            return m_lods;
+        }
+
+        // Get the model space bounding sphere of the primitive's vertices.
+        const DirectX::BoundingSphere& GetBoundingSphere() const {
+            return m_boundingSphere;
+        }
+
+        // Select the coarsest level of detail whose projected error stays within errorThreshold pixels.
+        uint32_t XM_CALLCONV SelectLod(DirectX::FXMMATRIX modelToView, const ViewParameters& viewParameters, float errorThreshold) const;
+
+        // Get the format of the vertex buffer, and the transform from its decoded positions to model space.
+        VertexFormat GetVertexFormat() const {
+            return m_vertexFormat;
+        }
+        DirectX::XMMATRIX XM_CALLCONV GetVertexToModel() const {
+            return DirectX::XMLoadFloat4x4(&m_vertexToModel);
+        }
+
+        // Get the meshlets of the full resolution level, which are empty when the primitive is culled as a whole.
+        const std::vector<PrimitiveMeshlet>& GetMeshlets() const;
+
+        // Whether the primitive has morph targets, and the node whose morph weights blend them.
+        bool HasMorphTargets() const {
+            return m_morphTargets != nullptr;
+        }
+        NodeIndex_t GetMorphNode() const {
+            return m_morphNode;
+        }
 
     protected:
         friend struct Model;
-        void Render(const Resources& pbrResources) const;
+
+        // Set the buffers of the given level of detail. When a frustum is given, the meshlets of the full resolution level are
+        // culled and the remaining triangles are drawn from a transient index buffer of this draw. Returns false if nothing is visible.
+        bool Render(const Resources& pbrResources, uint32_t lodLevel = 0, const CullingFrustum* frustum = nullptr) const;
         Primitive Clone(Pbr::Resources const& pbrResources) const;
 
+        // Blend the morph targets into the vertices with the given weights, one per target. Only the vertices moved by the targets
+        // whose weight changed since the last update are recomputed, and only their range of the vertex buffer is written.
+        void UpdateMorphTargets(const std::vector<float>& weights) const;
+
     private:
+        void CreateVertexBuffers(const Pbr::PrimitiveBuilder& primitiveBuilder,
+                                 bool updatableBuffers,
+                                 VertexFormat vertexFormat,
+                                 std::vector<Pbr::Vertex>* movableVertices = nullptr);
+        void SetGeometryInfo(const Pbr::PrimitiveBuilder& primitiveBuilder);
+        void SetVertexBuffer() const;
+
         UINT m_indexCount;
         shared_bgfx_handle<bgfx::IndexBufferHandle> m_indexBuffer;
         shared_bgfx_handle<bgfx::VertexBufferHandle> m_vertexBuffer;
         unique_bgfx_handle<bgfx::ProgramHandle> m_shaderProgram;
         std::shared_ptr<Material> m_material;
+        std::vector<PrimitiveLod> m_lods;
+        DirectX::BoundingSphere m_boundingSphere;
+        VertexFormat m_vertexFormat{VertexFormat::Full};
+        DirectX::XMFLOAT4X4 m_vertexToModel;
+        bool m_index32{true}; // Whether the index buffers hold 32-bit indices rather than 16-bit.
+
+        // Meshlets and a CPU copy of the full resolution indices they reference, shared by clones.
+        std::shared_ptr<const std::vector<PrimitiveMeshlet>> m_meshlets;
+        std::shared_ptr<const std::vector<uint32_t>> m_meshletIndices;
+
+        // Scratch list of the visible meshlet triangles, which are copied into a transient index buffer for each draw.
+        mutable std::vector<uint32_t> m_culledIndices;
+
+        // Morph targets and the vertices they displace, shared by clones. Each primitive blends them into vertices and a dynamic
+        // vertex buffer of its own, which hold the vertices morphed by the weights last applied.
+        std::shared_ptr<const std::vector<PrimitiveMorphTarget>> m_morphTargets;
+        std::shared_ptr<const std::vector<Pbr::Vertex>> m_morphBaseVertices;
+        NodeIndex_t m_morphNode{RootNodeIndex};
+        unique_bgfx_handle<bgfx::DynamicVertexBufferHandle> m_morphVertexBuffer;
+        mutable std::vector<Pbr::Vertex> m_morphedVertices;
+        mutable std::vector<float> m_morphWeights;
     };
 } // namespace Pbr
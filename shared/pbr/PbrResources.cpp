@@ -160,6 +160,8 @@ namespace Pbr {
         FillMode Fill = FillMode::Solid;
         FrontFaceWindingOrder WindingOrder = FrontFaceWindingOrder::ClockWise;
         bool ReverseZ = false;
+        std::map<bgfx::ViewId, ViewParameters> Views;
+        float LodErrorThreshold = 1.0f;
         mutable std::mutex m_cacheMutex;
     };
 
@@ -231,6 +233,14 @@ namespace Pbr {
         //bgfx::setUniform(m_impl->Resources.AllUniformHandles.ModelToWorld, &modelToWorld, 1);
         // context->UpdateSubresource(m_impl->Resources.ModelConstantBuffer.get(), 0, nullptr, &m_impl->ModelBuffer, 0, 0);
     }
+
+    DirectX::XMMATRIX XM_CALLCONV Resources::GetModelToWorld() const {
+        return DirectX::XMMatrixTranspose(XMLoadFloat4x4(&m_impl->ModelBuffer.ModelToWorld));
+    }
+
+    void Resources::BindModelToWorld() const {
+        bgfx::setUniform(m_impl->Resources.AllUniformHandles.ModelToWorld, &m_impl->ModelBuffer.ModelToWorld);
+    }
     // DirectX::XMFLOAT4X4 u_viewProjection;
     // float[4] u_eyePosition;
     // float[3][3] u_highlightPositionLightDirectionLightColor;
@@ -241,6 +251,29 @@ namespace Pbr {
         XMStoreFloat4(&m_impl->SceneUniformsInstance.u_eyePosition, DirectX::XMMatrixInverse(nullptr, view).r[3]);
     }
 
+    void XM_CALLCONV Resources::SetViewParameters(bgfx::ViewId view,
+                                                  DirectX::FXMMATRIX worldToView,
+                                                  DirectX::CXMMATRIX projection,
+                                                  float viewportHeight) {
+        ViewParameters& viewParameters = m_impl->Views[view];
+        XMStoreFloat4x4(&viewParameters.WorldToView, worldToView);
+        XMStoreFloat4x4(&viewParameters.Projection, projection);
+        viewParameters.ViewportHeight = viewportHeight;
+    }
+
+    const ViewParameters* Resources::GetViewParameters(bgfx::ViewId view) const {
+        const auto it = m_impl->Views.find(view);
+        return it != m_impl->Views.end() ? &it->second : nullptr;
+    }
+
+    void Resources::SetLodErrorThreshold(float pixels) {
+        m_impl->LodErrorThreshold = pixels;
+    }
+
+    float Resources::GetLodErrorThreshold() const {
+        return m_impl->LodErrorThreshold;
+    }
+
     void Resources::SetEnvironmentMap(_In_ unique_bgfx_handle<bgfx::TextureHandle>&& specularEnvironmentMap,
                                       _In_ unique_bgfx_handle<bgfx::TextureHandle>&& diffuseEnvironmentMap,
                                       std::map<std::string, bgfx::TextureInfo>& textureInformation) {
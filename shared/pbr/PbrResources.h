@@ -114,6 +114,13 @@ namespace Pbr {
         CounterClockWise,
     };
 
+    // Camera parameters of a bgfx view, used to select levels of detail for the primitives rendered into it.
+    struct ViewParameters {
+        DirectX::XMFLOAT4X4 WorldToView;
+        DirectX::XMFLOAT4X4 Projection;
+        float ViewportHeight; // In pixels.
+    };
+
     // Global PBR resources required for rendering a scene.
      struct Resources final {
         explicit Resources();
@@ -154,6 +161,17 @@ namespace Pbr {
         // Set the current view and projection matrices.
         void XM_CALLCONV SetViewProjection(DirectX::FXMMATRIX view, DirectX::CXMMATRIX projection);
 
+        // Set or get the camera parameters of a bgfx view. Returns nullptr if none were set for the view.
+        void XM_CALLCONV SetViewParameters(bgfx::ViewId view,
+                                           DirectX::FXMMATRIX worldToView,
+                                           DirectX::CXMMATRIX projection,
+                                           float viewportHeight);
+        const ViewParameters* GetViewParameters(bgfx::ViewId view) const;
+
+        // Set or get the largest screen-space error, in pixels, allowed when selecting a primitive's level of detail.
+        void SetLodErrorThreshold(float pixels);
+        float GetLodErrorThreshold() const;
+
         // Many 1x1 pixel colored textures are used in the PBR system. This is used to create textures backed by a cache to reduce the
         // number of textures created.
         shared_bgfx_handle<bgfx::TextureHandle> CreateSolidColorTexture(RGBAColor color) const;
@@ -163,6 +181,10 @@ namespace Pbr {
 
         // Set and update the model to world constant buffer value.
         void XM_CALLCONV SetModelToWorld(DirectX::FXMMATRIX modelToWorld) const;
+        DirectX::XMMATRIX XM_CALLCONV GetModelToWorld() const;
+
+        // Bind the model to world transform for the next draw.
+        void BindModelToWorld() const;
 
         // Set or get the shading and fill modes.
         void SetShadingMode(ShadingMode mode);
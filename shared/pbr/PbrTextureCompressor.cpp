@@ -0,0 +1,419 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+#include "pch.h"
+#include "PbrTextureCompressor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <DirectXPackedVector.h>
+
+using namespace DirectX;
+
+namespace {
+    constexpr uint32_t BlockDimension = 4;
+    constexpr uint32_t BlockPixelCount = BlockDimension * BlockDimension;
+
+    // Interpolation weights of the 4-bit indices of BC7, out of 64.
+    constexpr uint32_t BC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Least squares refinements of the BC7 endpoints in high quality mode. Each one typically gains less than the one before.
+    constexpr uint32_t BC7RefinementCount = 2;
+
+    // The pixels of a 4x4 block, with channel values in [0, 255].
+    struct ColorBlock {
+        XMVECTOR Pixels[BlockPixelCount];
+    };
+
+    // The image blocks are read from. The blocks on its right and bottom edges repeat its last pixels when its size is not a
+    // multiple of 4, which only happens for the smallest mip levels.
+    struct SourceImage {
+        const uint8_t* Pixels;
+        uint32_t ChannelCount;
+        uint32_t Width;
+        uint32_t Height;
+
+        const uint8_t* GetPixel(uint32_t blockX, uint32_t blockY, uint32_t x, uint32_t y) const {
+            const uint32_t pixelX = std::min(blockX * BlockDimension + x, Width - 1);
+            const uint32_t pixelY = std::min(blockY * BlockDimension + y, Height - 1);
+            return Pixels + ((size_t)pixelY * Width + pixelX) * ChannelCount;
+        }
+    };
+
+    ColorBlock LoadColorBlock(const SourceImage& image, uint32_t blockX, uint32_t blockY) {
+        ColorBlock block;
+        for (uint32_t y = 0; y < BlockDimension; y++) {
+            for (uint32_t x = 0; x < BlockDimension; x++) {
+                block.Pixels[y * BlockDimension + x] =
+                    PackedVector::XMLoadUByte4(reinterpret_cast<const PackedVector::XMUBYTE4*>(image.GetPixel(blockX, blockY, x, y)));
+            }
+        }
+        return block;
+    }
+
+    // Fit a line through the pixels of a block, ignoring the channels which are not set in channelMask: the line goes through
+    // their mean along the principal axis of their covariance, which is found by power iteration. The endpoints are the extreme
+    // projections of the pixels onto the line.
+    void XM_CALLCONV FitEndpoints(const ColorBlock& block, FXMVECTOR channelMask, XMVECTOR* endpoint0, XMVECTOR* endpoint1) {
+        XMVECTOR sum = XMVectorZero();
+        XMVECTOR minimum = g_XMFltMax;
+        XMVECTOR maximum = XMVectorNegate(g_XMFltMax);
+        for (const XMVECTOR pixel : block.Pixels) {
+            sum = XMVectorAdd(sum, pixel);
+            minimum = XMVectorMin(minimum, pixel);
+            maximum = XMVectorMax(maximum, pixel);
+        }
+        const XMVECTOR mean = XMVectorAndInt(XMVectorScale(sum, 1.0f / BlockPixelCount), channelMask);
+
+        XMMATRIX covariance(g_XMZero, g_XMZero, g_XMZero, g_XMZero);
+        for (const XMVECTOR pixel : block.Pixels) {
+            const XMVECTOR offset = XMVectorAndInt(XMVectorSubtract(pixel, mean), channelMask);
+            covariance.r[0] = XMVectorMultiplyAdd(offset, XMVectorSplatX(offset), covariance.r[0]);
+            covariance.r[1] = XMVectorMultiplyAdd(offset, XMVectorSplatY(offset), covariance.r[1]);
+            covariance.r[2] = XMVectorMultiplyAdd(offset, XMVectorSplatZ(offset), covariance.r[2]);
+            covariance.r[3] = XMVectorMultiplyAdd(offset, XMVectorSplatW(offset), covariance.r[3]);
+        }
+
+        // Start from the diagonal of the bounding box, which is close to the principal axis for most blocks.
+        XMVECTOR axis = XMVector4Normalize(XMVectorAndInt(XMVectorSubtract(maximum, minimum), channelMask));
+        for (uint32_t iteration = 0; iteration < 4; iteration++) {
+            const XMVECTOR next = XMVector4Transform(axis, covariance);
+            if (XMVector4Less(XMVector4LengthSq(next), XMVectorReplicate(1e-6f))) {
+                break; // The pixels do not vary along the axis, so there is nothing to refine.
+            }
+            axis = XMVector4Normalize(next);
+        }
+        if (XMVector4IsNaN(axis)) {
+            axis = XMVectorZero(); // All pixels are the same.
+        }
+
+        float minProjection = FLT_MAX;
+        float maxProjection = -FLT_MAX;
+        for (const XMVECTOR pixel : block.Pixels) {
+            const float projection = XMVectorGetX(XMVector4Dot(XMVectorSubtract(pixel, mean), axis));
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        const XMVECTOR maxValue = XMVectorReplicate(255.0f);
+        *endpoint0 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(minProjection), mean), g_XMZero, maxValue);
+        *endpoint1 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(maxProjection), mean), g_XMZero, maxValue);
+    }
+
+    uint16_t XM_CALLCONV ToRgb565(FXMVECTOR color) {
+        XMFLOAT4 quantized;
+        XMStoreFloat4(&quantized, XMVectorRound(XMVectorMultiply(color, XMVectorSet(31 / 255.0f, 63 / 255.0f, 31 / 255.0f, 0))));
+        return (uint16_t)(((uint32_t)quantized.x << 11) | ((uint32_t)quantized.y << 5) | (uint32_t)quantized.z);
+    }
+
+    XMVECTOR FromRgb565(uint16_t color) {
+        const uint32_t r = (color >> 11) & 0x1F;
+        const uint32_t g = (color >> 5) & 0x3F;
+        const uint32_t b = color & 0x1F;
+        return XMVectorSet((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)), 0);
+    }
+
+    // Encode the colors of a block as BC1 in four color mode, which is also the color part of BC3.
+    void EncodeBC1Block(const ColorBlock& block, uint8_t* destination) {
+        XMVECTOR endpoint0, endpoint1;
+        FitEndpoints(block, g_XMMask3, &endpoint0, &endpoint1);
+
+        // The first color must be the greater one to select the four color mode.
+        uint16_t color0 = ToRgb565(endpoint1);
+        uint16_t color1 = ToRgb565(endpoint0);
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        uint32_t indices = 0;
+        if (color0 != color1) {
+            const XMVECTOR palette0 = FromRgb565(color0);
+            const XMVECTOR palette1 = FromRgb565(color1);
+            const XMVECTOR palette[4] = {
+                palette0, palette1, XMVectorLerp(palette0, palette1, 1 / 3.0f), XMVectorLerp(palette0, palette1, 2 / 3.0f)};
+            for (uint32_t i = 0; i < BlockPixelCount; i++) {
+                const XMVECTOR pixel = XMVectorAndInt(block.Pixels[i], g_XMMask3);
+                uint32_t bestIndex = 0;
+                float bestError = FLT_MAX;
+                for (uint32_t index = 0; index < 4; index++) {
+                    const float error = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(pixel, palette[index])));
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = index;
+                    }
+                }
+                indices |= bestIndex << (i * 2);
+            }
+        }
+
+        memcpy(destination, &color0, sizeof(color0));
+        memcpy(destination + 2, &color1, sizeof(color1));
+        memcpy(destination + 4, &indices, sizeof(indices));
+    }
+
+    // Encode one channel of a block as BC4 in eight value mode, which is also the alpha part of BC3.
+    void EncodeBC4Block(const uint8_t (&values)[BlockPixelCount], uint8_t* destination) {
+        const auto [minimum, maximum] = std::minmax_element(std::begin(values), std::end(values));
+        destination[0] = *maximum;
+        destination[1] = *minimum;
+
+        // Index 0 is the maximum, 1 the minimum and 2 to 7 are interpolated from the maximum down.
+        uint64_t indices = 0;
+        if (*maximum > *minimum) {
+            const float scale = 7.0f / (*maximum - *minimum);
+            for (uint32_t i = 0; i < BlockPixelCount; i++) {
+                const uint32_t step = (uint32_t)std::lround((values[i] - *minimum) * scale);
+                const uint64_t index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+                indices |= index << (i * 3);
+            }
+        }
+        memcpy(destination + 2, &indices, 6);
+    }
+
+    // A BC7 endpoint with 7 bits per channel and a p-bit shared by its channels, which is their least significant bit.
+    struct BC7Endpoint {
+        uint32_t Channels[4];
+        uint32_t PBit;
+        XMVECTOR Value; // The 8-bit value of each channel.
+    };
+
+    BC7Endpoint XM_CALLCONV QuantizeBC7Endpoint(FXMVECTOR value) {
+        BC7Endpoint best{};
+        float bestError = FLT_MAX;
+        for (uint32_t pBit = 0; pBit < 2; pBit++) {
+            const XMVECTOR channels =
+                XMVectorClamp(XMVectorRound(XMVectorScale(XMVectorSubtract(value, XMVectorReplicate((float)pBit)), 0.5f)),
+                              g_XMZero,
+                              XMVectorReplicate(127.0f));
+            const XMVECTOR quantized = XMVectorAdd(XMVectorScale(channels, 2.0f), XMVectorReplicate((float)pBit));
+            const float error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(quantized, value)));
+            if (error < bestError) {
+                bestError = error;
+                XMFLOAT4 channelValues;
+                XMStoreFloat4(&channelValues, channels);
+                best = {{(uint32_t)channelValues.x, (uint32_t)channelValues.y, (uint32_t)channelValues.z, (uint32_t)channelValues.w},
+                        pBit,
+                        quantized};
+            }
+        }
+        return best;
+    }
+
+    // Assign each pixel the index of the nearest interpolated color, and return the total squared error. The index is found
+    // by projecting the pixel onto the endpoints' line, then checking its neighbors since the weights are not evenly spaced.
+    float AssignBC7Indices(const ColorBlock& block,
+                           const BC7Endpoint& endpoint0,
+                           const BC7Endpoint& endpoint1,
+                           uint8_t (&indices)[BlockPixelCount]) {
+        XMVECTOR palette[16];
+        for (uint32_t index = 0; index < 16; index++) {
+            const float weight = (float)BC7Weights4[index];
+            palette[index] = XMVectorTruncate(XMVectorScale(
+                XMVectorAdd(XMVectorAdd(XMVectorScale(endpoint0.Value, 64 - weight), XMVectorScale(endpoint1.Value, weight)),
+                            XMVectorReplicate(32.0f)),
+                1 / 64.0f));
+        }
+
+        const XMVECTOR direction = XMVectorSubtract(endpoint1.Value, endpoint0.Value);
+        const float lengthSq = XMVectorGetX(XMVector4LengthSq(direction));
+        const float scale = lengthSq > 0 ? 15 / lengthSq : 0;
+
+        float totalError = 0;
+        for (uint32_t i = 0; i < BlockPixelCount; i++) {
+            const XMVECTOR pixel = block.Pixels[i];
+            const float projection = XMVectorGetX(XMVector4Dot(XMVectorSubtract(pixel, endpoint0.Value), direction)) * scale;
+            const int32_t center = std::clamp((int32_t)std::lround(projection), 0, 15);
+
+            float bestError = FLT_MAX;
+            for (int32_t index = std::max(center - 1, 0); index <= std::min(center + 1, 15); index++) {
+                const float error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(pixel, palette[index])));
+                if (error < bestError) {
+                    bestError = error;
+                    indices[i] = (uint8_t)index;
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    // Writes the fields of a block from its least significant bit.
+    class BlockWriter {
+    public:
+        explicit BlockWriter(uint8_t* destination, size_t blockSize)
+            : m_destination(destination) {
+            memset(destination, 0, blockSize);
+        }
+
+        void Write(uint32_t value, uint32_t bitCount) {
+            for (uint32_t bit = 0; bit < bitCount; bit++, m_offset++) {
+                m_destination[m_offset / 8] |= (uint8_t)(((value >> bit) & 1) << (m_offset % 8));
+            }
+        }
+
+    private:
+        uint8_t* const m_destination;
+        uint32_t m_offset{0};
+    };
+
+    // Encode a block as BC7 mode 6: a single line through RGBA space with 4-bit indices, which suits most textures.
+    void EncodeBC7Block(const ColorBlock& block, uint32_t refinementCount, uint8_t* destination) {
+        XMVECTOR endpointValue0, endpointValue1;
+        FitEndpoints(block, XMVectorTrueInt(), &endpointValue0, &endpointValue1);
+        BC7Endpoint endpoint0 = QuantizeBC7Endpoint(endpointValue0);
+        BC7Endpoint endpoint1 = QuantizeBC7Endpoint(endpointValue1);
+        uint8_t indices[BlockPixelCount];
+        float error = AssignBC7Indices(block, endpoint0, endpoint1, indices);
+
+        // Solve for the endpoints which minimize the error of the chosen indices, and keep them if they do.
+        for (uint32_t refinement = 0; refinement < refinementCount && error > 0; refinement++) {
+            float a = 0, b = 0, c = 0;
+            XMVECTOR x0 = XMVectorZero();
+            XMVECTOR x1 = XMVectorZero();
+            for (uint32_t i = 0; i < BlockPixelCount; i++) {
+                const float weight = BC7Weights4[indices[i]] / 64.0f;
+                a += (1 - weight) * (1 - weight);
+                b += (1 - weight) * weight;
+                c += weight * weight;
+                x0 = XMVectorMultiplyAdd(block.Pixels[i], XMVectorReplicate(1 - weight), x0);
+                x1 = XMVectorMultiplyAdd(block.Pixels[i], XMVectorReplicate(weight), x1);
+            }
+
+            const float determinant = a * c - b * b;
+            if (std::abs(determinant) < 1e-6f) {
+                break; // All pixels use the same index.
+            }
+
+            const XMVECTOR maxValue = XMVectorReplicate(255.0f);
+            const BC7Endpoint refined0 = QuantizeBC7Endpoint(XMVectorClamp(
+                XMVectorScale(XMVectorSubtract(XMVectorScale(x0, c), XMVectorScale(x1, b)), 1 / determinant), g_XMZero, maxValue));
+            const BC7Endpoint refined1 = QuantizeBC7Endpoint(XMVectorClamp(
+                XMVectorScale(XMVectorSubtract(XMVectorScale(x1, a), XMVectorScale(x0, b)), 1 / determinant), g_XMZero, maxValue));
+            uint8_t refinedIndices[BlockPixelCount];
+            const float refinedError = AssignBC7Indices(block, refined0, refined1, refinedIndices);
+            if (refinedError >= error) {
+                break;
+            }
+
+            endpoint0 = refined0;
+            endpoint1 = refined1;
+            error = refinedError;
+            std::copy(std::begin(refinedIndices), std::end(refinedIndices), std::begin(indices));
+        }
+
+        // The most significant bit of the first pixel's index is implicitly zero, which swapping the endpoints ensures.
+        if (indices[0] >= 8) {
+            std::swap(endpoint0, endpoint1);
+            for (uint8_t& index : indices) {
+                index = (uint8_t)(15 - index);
+            }
+        }
+
+        BlockWriter writer(destination, 16);
+        writer.Write(1 << 6, 7); // Mode 6.
+        for (uint32_t channel = 0; channel < 4; channel++) {
+            writer.Write(endpoint0.Channels[channel], 7);
+            writer.Write(endpoint1.Channels[channel], 7);
+        }
+        writer.Write(endpoint0.PBit, 1);
+        writer.Write(endpoint1.PBit, 1);
+        writer.Write(indices[0], 3);
+        for (uint32_t i = 1; i < BlockPixelCount; i++) {
+            writer.Write(indices[i], 4);
+        }
+    }
+
+    void LoadChannelBlock(
+        const SourceImage& image, uint32_t channel, uint32_t blockX, uint32_t blockY, uint8_t (&values)[BlockPixelCount]) {
+        for (uint32_t y = 0; y < BlockDimension; y++) {
+            for (uint32_t x = 0; x < BlockDimension; x++) {
+                values[y * BlockDimension + x] = image.GetPixel(blockX, blockY, x, y)[channel];
+            }
+        }
+    }
+} // namespace
+
+namespace Pbr {
+    uint32_t GetBlockSize(bgfx::TextureFormat::Enum format) {
+        switch (format) {
+        case bgfx::TextureFormat::BC1:
+        case bgfx::TextureFormat::BC4:
+            return 8;
+        case bgfx::TextureFormat::BC3:
+        case bgfx::TextureFormat::BC7:
+            return 16;
+        default:
+            throw std::exception("Unsupported block compressed texture format.");
+        }
+    }
+
+    bgfx::TextureFormat::Enum ChooseBlockFormat(_In_reads_bytes_(pixelCount * channelCount) const uint8_t* pixels,
+                                                uint32_t channelCount,
+                                                size_t pixelCount,
+                                                bool alphaUsed,
+                                                const TextureCompressionOptions& options) {
+        if (channelCount == 1) {
+            return bgfx::TextureFormat::BC4;
+        }
+        if (options.Quality == TextureCompressionQuality::High) {
+            return bgfx::TextureFormat::BC7;
+        }
+        if (alphaUsed) {
+            for (size_t i = 0; i < pixelCount; i++) {
+                if (pixels[i * channelCount + 3] != 255) {
+                    return bgfx::TextureFormat::BC3;
+                }
+            }
+        }
+        return bgfx::TextureFormat::BC1;
+    }
+
+    void CompressBlockRows(_In_ const uint8_t* pixels,
+                           uint32_t channelCount,
+                           uint32_t width,
+                           uint32_t height,
+                           uint32_t firstBlockRow,
+                           uint32_t blockRowCount,
+                           bgfx::TextureFormat::Enum format,
+                           const TextureCompressionOptions& options,
+                           _Out_ uint8_t* blocks) {
+        if (format != bgfx::TextureFormat::BC4 && channelCount != 4) {
+            throw std::exception("Color block formats require RGBA pixels.");
+        }
+
+        const uint32_t blockSize = GetBlockSize(format);
+        const uint32_t blocksWide = (width + BlockDimension - 1) / BlockDimension;
+        const SourceImage image{pixels, channelCount, width, height};
+        const uint32_t refinementCount = options.Quality == TextureCompressionQuality::High ? BC7RefinementCount : 0;
+        uint8_t* destination = blocks + (size_t)firstBlockRow * blocksWide * blockSize;
+        for (uint32_t blockY = firstBlockRow; blockY < firstBlockRow + blockRowCount; blockY++) {
+            for (uint32_t blockX = 0; blockX < blocksWide; blockX++, destination += blockSize) {
+                switch (format) {
+                case bgfx::TextureFormat::BC1:
+                    EncodeBC1Block(LoadColorBlock(image, blockX, blockY), destination);
+                    break;
+                case bgfx::TextureFormat::BC3: {
+                    uint8_t alpha[BlockPixelCount];
+                    LoadChannelBlock(image, 3, blockX, blockY, alpha);
+                    EncodeBC4Block(alpha, destination);
+                    EncodeBC1Block(LoadColorBlock(image, blockX, blockY), destination + 8);
+                    break;
+                }
+                case bgfx::TextureFormat::BC4: {
+                    uint8_t values[BlockPixelCount];
+                    LoadChannelBlock(image, 0, blockX, blockY, values);
+                    EncodeBC4Block(values, destination);
+                    break;
+                }
+                case bgfx::TextureFormat::BC7:
+                    EncodeBC7Block(LoadColorBlock(image, blockX, blockY), refinementCount, destination);
+                    break;
+                default:
+                    break; // GetBlockSize has thrown for other formats.
+                }
+            }
+        }
+    }
+} // namespace Pbr
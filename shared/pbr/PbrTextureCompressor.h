@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) Microsoft Corporation.  All Rights Reserved
+// Licensed under the MIT License. See License.txt in the project root for license information.
+//
+// Load-time block compression of textures.
+//
+
+#pragma once
+
+#include "PbrCommon.h"
+
+namespace Pbr {
+    enum class TextureCompressionQuality : uint32_t {
+        // BC1 for color textures, or BC3 when their alpha is used and not opaque. Fast enough for content loaded at runtime.
+        Fast,
+
+        // BC7 for color textures, with the endpoints of each block refined by least squares. Requires feature level 11 hardware.
+        High,
+    };
+
+    // Options for block compressing textures. Single channel textures are always compressed to BC4.
+    struct TextureCompressionOptions {
+        TextureCompressionQuality Quality = TextureCompressionQuality::Fast;
+
+        // Images with fewer pixels than this are left uncompressed, since their blocks would save little memory.
+        uint32_t MinPixelCount = 64 * 64;
+    };
+
+    // Size in bytes of a 4x4 block of BC1, BC3, BC4 or BC7.
+    uint32_t GetBlockSize(bgfx::TextureFormat::Enum format);
+
+    // Choose the block format of an image with 1 (grey) or 4 (RGBA) channels. alphaUsed tells whether the alpha channel of an
+    // RGBA image is sampled, in which case BC1 is only used if every pixel is opaque.
+    bgfx::TextureFormat::Enum ChooseBlockFormat(_In_reads_bytes_(pixelCount * channelCount) const uint8_t* pixels,
+                                                uint32_t channelCount,
+                                                size_t pixelCount,
+                                                bool alphaUsed,
+                                                const TextureCompressionOptions& options);
+
+    // Compress blockRowCount rows of 4x4 blocks, starting at firstBlockRow, of an image with 1 or 4 channels. The blocks are written
+    // to their place in the compressed image, so that separate rows can be compressed concurrently. Blocks which extend past the
+    // image, as those of mip levels smaller than a block do, repeat its edge pixels.
+    void CompressBlockRows(_In_ const uint8_t* pixels,
+                           uint32_t channelCount,
+                           uint32_t width,
+                           uint32_t height,
+                           uint32_t firstBlockRow,
+                           uint32_t blockRowCount,
+                           bgfx::TextureFormat::Enum format,
+                           const TextureCompressionOptions& options,
+                           _Out_ uint8_t* blocks);
+} // namespace Pbr